@@ -0,0 +1,751 @@
+/*
+	Copyright (c) 2015 Christopher A. Taylor.  All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice,
+	  this list of conditions and the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice,
+	  this list of conditions and the following disclaimer in the documentation
+	  and/or other materials provided with the distribution.
+	* Neither the name of CM256 nor the names of its contributors may be
+	  used to endorse or promote products derived from this software without
+	  specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+    Portable benchmark with machine-readable output
+
+    Sweeps encode, decode, the gf256 bulk kernels and the decoder matrix
+    setup over the given parameters, and prints one record per configuration
+    as JSON or CSV for tracking regressions between releases.  Each record
+    has the median throughput, cycles per byte and p50/p99 latency of the
+    trials.
+
+    Build from the repository root:
+
+        g++ -O2 -std=c++11 -o cm256_bench benchmark/main.cpp cm256.cpp gf256.cpp -lpthread
+
+    Run with --help for the options.
+*/
+
+#include "../cm256.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#if defined(_MSC_VER)
+    #include <intrin.h> // __rdtsc
+    #define BENCH_HAS_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h> // __rdtsc
+    #define BENCH_HAS_TSC
+#endif
+
+
+//------------------------------------------------------------------------------
+// Timing
+
+typedef std::chrono::steady_clock BenchClock;
+
+// Cycle counter ticks per nanosecond, or 0 if unknown
+static double TicksPerNsec = 0.;
+
+static uint64_t ReadTicks()
+{
+#if defined(BENCH_HAS_TSC)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Measure the cycle counter against the steady clock.
+// The TSC counts reference cycles at the nominal frequency of the CPU.
+static void CalibrateTicks(double ghzOverride)
+{
+    if (ghzOverride > 0.)
+    {
+        TicksPerNsec = ghzOverride;
+        return;
+    }
+
+#if defined(BENCH_HAS_TSC)
+    const BenchClock::time_point t0 = BenchClock::now();
+    const uint64_t c0 = ReadTicks();
+    while (BenchClock::now() - t0 < std::chrono::milliseconds(100))
+    {
+    }
+    const uint64_t c1 = ReadTicks();
+    const double nsec = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(BenchClock::now() - t0).count();
+    TicksPerNsec = (double)(c1 - c0) / nsec;
+#endif
+}
+
+// Latency of each trial of one configuration, in nanoseconds
+struct BenchSamples
+{
+    double* Nsec;
+    int Count;
+
+    explicit BenchSamples(int trials)
+    {
+        Nsec = new double[trials];
+        Count = 0;
+    }
+    ~BenchSamples()
+    {
+        delete[] Nsec;
+    }
+
+    void Add(BenchClock::time_point t0, BenchClock::time_point t1)
+    {
+        Nsec[Count++] = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    }
+
+    // Returns the given percentile by nearest rank
+    double Percentile(int percent)
+    {
+        qsort(Nsec, Count, sizeof(double), CompareDoubles);
+
+        int rank = (Count * percent + 99) / 100;
+        if (rank < 1)
+        {
+            rank = 1;
+        }
+        return Nsec[rank - 1];
+    }
+
+    static int CompareDoubles(const void* a, const void* b)
+    {
+        const double x = *static_cast<const double*>(a);
+        const double y = *static_cast<const double*>(b);
+        return (x < y) ? -1 : (x > y ? 1 : 0);
+    }
+};
+
+
+//------------------------------------------------------------------------------
+// Options
+
+static const int kMaxListEntries = 32;
+
+struct BenchList
+{
+    int Values[kMaxListEntries];
+    int Count;
+};
+
+struct BenchOptions
+{
+    BenchList K, M, Bytes, Erasures, Align, Threads;
+    int Trials;
+    bool Csv;
+    bool Encode, Decode, Kernels, Ldu;
+    const char* Backend;
+    double Ghz;
+};
+
+// Parse a comma-separated list such as "10,50,200".
+// Returns false on a parse error
+static bool ParseList(const char* text, BenchList& list)
+{
+    list.Count = 0;
+    while (*text)
+    {
+        char* end = nullptr;
+        const long value = strtol(text, &end, 10);
+        if (end == text || value < 0 || list.Count >= kMaxListEntries)
+        {
+            return false;
+        }
+        list.Values[list.Count++] = (int)value;
+
+        text = end;
+        if (*text == ',')
+        {
+            ++text;
+        }
+        else if (*text != '\0')
+        {
+            return false;
+        }
+    }
+    return list.Count > 0;
+}
+
+static void SetList(BenchList& list, const int* values, int count)
+{
+    memcpy(list.Values, values, count * sizeof(int));
+    list.Count = count;
+}
+
+static void PrintUsage()
+{
+    fprintf(stderr,
+        "usage: cm256_bench [options]\n"
+        "  --suite LIST     encode,decode,kernels,ldu (default all)\n"
+        "  --k LIST         original block counts (default 10,50,200)\n"
+        "  --m LIST         recovery block counts (default 1,2,4,16)\n"
+        "  --bytes LIST     block sizes (default 1296,65536,1048576)\n"
+        "  --erasures LIST  originals lost for decode, capped at m (default m)\n"
+        "  --align LIST     byte offset of every buffer from 64-byte alignment (default 0)\n"
+        "  --threads LIST   thread counts for encode/decode (default 1)\n"
+        "  --trials N       timed runs per configuration (default 50)\n"
+        "  --backend NAME   gf256 backend to use, such as scalar or avx2 (default best)\n"
+        "  --ghz X          convert time to cycles at X GHz instead of reading the TSC\n"
+        "  --csv            print CSV instead of JSON\n");
+}
+
+static bool ParseOptions(int argc, char** argv, BenchOptions& options)
+{
+    static const int kDefaultK[] = { 10, 50, 200 };
+    static const int kDefaultM[] = { 1, 2, 4, 16 };
+    static const int kDefaultBytes[] = { 1296, 65536, 1048576 };
+    static const int kZero[] = { 0 };
+    static const int kOne[] = { 1 };
+
+    SetList(options.K, kDefaultK, 3);
+    SetList(options.M, kDefaultM, 4);
+    SetList(options.Bytes, kDefaultBytes, 3);
+    options.Erasures.Count = 0; // Same as m
+    SetList(options.Align, kZero, 1);
+    SetList(options.Threads, kOne, 1);
+    options.Trials = 50;
+    options.Csv = false;
+    options.Encode = options.Decode = options.Kernels = options.Ldu = true;
+    options.Backend = nullptr;
+    options.Ghz = 0.;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        bool ok = true;
+
+        if (0 == strcmp(arg, "--csv"))
+        {
+            options.Csv = true;
+            continue;
+        }
+        if (!value)
+        {
+            return false;
+        }
+        ++i;
+
+        if (0 == strcmp(arg, "--k"))
+            ok = ParseList(value, options.K);
+        else if (0 == strcmp(arg, "--m"))
+            ok = ParseList(value, options.M);
+        else if (0 == strcmp(arg, "--bytes"))
+            ok = ParseList(value, options.Bytes);
+        else if (0 == strcmp(arg, "--erasures"))
+            ok = ParseList(value, options.Erasures);
+        else if (0 == strcmp(arg, "--align"))
+            ok = ParseList(value, options.Align);
+        else if (0 == strcmp(arg, "--threads"))
+            ok = ParseList(value, options.Threads);
+        else if (0 == strcmp(arg, "--trials"))
+            ok = (options.Trials = atoi(value)) > 0;
+        else if (0 == strcmp(arg, "--backend"))
+            options.Backend = value;
+        else if (0 == strcmp(arg, "--ghz"))
+            ok = (options.Ghz = atof(value)) > 0.;
+        else if (0 == strcmp(arg, "--suite"))
+        {
+            options.Encode = (strstr(value, "encode") != nullptr);
+            options.Decode = (strstr(value, "decode") != nullptr);
+            options.Kernels = (strstr(value, "kernels") != nullptr);
+            options.Ldu = (strstr(value, "ldu") != nullptr);
+        }
+        else
+            ok = false;
+
+        if (!ok)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+//------------------------------------------------------------------------------
+// Reporting
+
+// One row of output
+struct BenchRecord
+{
+    const char* Suite;
+    const char* Name;
+    int K, M, Bytes, Erasures, Align, Threads;
+    double DataBytes; // Bytes of data processed per call, or 0 if throughput is meaningless
+};
+
+static bool Csv = false;
+static bool FirstRecord = true;
+
+static void BeginReport()
+{
+    if (Csv)
+    {
+        printf("suite,name,backend,k,m,bytes,erasures,align,threads,trials,mbps,cycles_per_byte,p50_usec,p99_usec\n");
+        return;
+    }
+
+    printf("{\n  \"library\": \"cm256\",\n  \"version\": %d,\n  \"backend\": \"%s\",\n",
+           CM256_VERSION, gf256_backend_name(gf256_get_backend()));
+    if (TicksPerNsec > 0.)
+    {
+        printf("  \"tsc_ghz\": %.3f,\n", TicksPerNsec);
+    }
+    else
+    {
+        printf("  \"tsc_ghz\": null,\n");
+    }
+    printf("  \"results\": [");
+}
+
+static void EndReport()
+{
+    if (!Csv)
+    {
+        printf("\n  ]\n}\n");
+    }
+}
+
+static void Report(const BenchRecord& record, BenchSamples& samples)
+{
+    const double p50 = samples.Percentile(50);
+    const double p99 = samples.Percentile(99);
+    const char* backend = gf256_backend_name(gf256_get_backend());
+
+    // Throughput from the median, which is robust against interruptions
+    const bool hasRate = record.DataBytes > 0.;
+    const double mbps = hasRate ? record.DataBytes * 1000. / p50 : 0.;
+    const bool hasCycles = hasRate && TicksPerNsec > 0.;
+    const double cpb = hasCycles ? p50 * TicksPerNsec / record.DataBytes : 0.;
+
+    if (Csv)
+    {
+        printf("%s,%s,%s,%d,%d,%d,%d,%d,%d,%d,", record.Suite, record.Name, backend,
+               record.K, record.M, record.Bytes, record.Erasures, record.Align, record.Threads, samples.Count);
+        if (hasRate)
+            printf("%.1f", mbps);
+        printf(",");
+        if (hasCycles)
+            printf("%.4f", cpb);
+        printf(",%.3f,%.3f\n", p50 / 1000., p99 / 1000.);
+    }
+    else
+    {
+        printf("%s\n    { \"suite\": \"%s\", \"name\": \"%s\", \"backend\": \"%s\", "
+               "\"k\": %d, \"m\": %d, \"bytes\": %d, \"erasures\": %d, \"align\": %d, \"threads\": %d, \"trials\": %d, ",
+               FirstRecord ? "" : ",", record.Suite, record.Name, backend,
+               record.K, record.M, record.Bytes, record.Erasures, record.Align, record.Threads, samples.Count);
+        if (hasRate)
+            printf("\"mbps\": %.1f, ", mbps);
+        else
+            printf("\"mbps\": null, ");
+        if (hasCycles)
+            printf("\"cycles_per_byte\": %.4f, ", cpb);
+        else
+            printf("\"cycles_per_byte\": null, ");
+        printf("\"p50_usec\": %.3f, \"p99_usec\": %.3f }", p50 / 1000., p99 / 1000.);
+    }
+
+    FirstRecord = false;
+    fflush(stdout);
+}
+
+
+//------------------------------------------------------------------------------
+// Buffers
+
+// Buffer whose data starts 'align' bytes past a 64-byte boundary
+struct BenchBuffer
+{
+    uint8_t* Allocated;
+    uint8_t* Data;
+
+    BenchBuffer(size_t bytes, int align)
+    {
+        Allocated = new uint8_t[bytes + 64 + align];
+        Data = Allocated + ((64 - ((uintptr_t)Allocated & 63)) & 63) + align;
+
+        for (size_t i = 0; i < bytes; ++i)
+        {
+            Data[i] = (uint8_t)(i * 131 + (i >> 11) + 1);
+        }
+    }
+    ~BenchBuffer()
+    {
+        delete[] Allocated;
+    }
+};
+
+
+//------------------------------------------------------------------------------
+// Codec Suites
+
+static int RunEncode(const cm256_encoder_params& params, cm256_block* originals, uint8_t* recovery, int threads)
+{
+    if (threads <= 1)
+    {
+        return cm256_encode(params, originals, recovery);
+    }
+
+    cm256_threading threading;
+    threading.ThreadCount = threads;
+    threading.Scheduler = nullptr;
+    threading.SchedulerContext = nullptr;
+    return cm256_encode_mt(params, originals, recovery, &threading);
+}
+
+static int RunDecode(const cm256_encoder_params& params, cm256_block* blocks, int threads)
+{
+    if (threads <= 1)
+    {
+        return cm256_decode(params, blocks);
+    }
+
+    cm256_threading threading;
+    threading.ThreadCount = threads;
+    threading.Scheduler = nullptr;
+    threading.SchedulerContext = nullptr;
+    return cm256_decode_mt(params, blocks, &threading);
+}
+
+// Time encode, and decode with 'erasures' originals replaced by recovery blocks.
+// Returns false on a codec error
+static bool BenchCodec(
+    const BenchOptions& options, const char* suite, int k, int m, int bytes,
+    int erasures, int align, int threads)
+{
+    cm256_encoder_params params;
+    params.OriginalCount = k;
+    params.RecoveryCount = m;
+    params.BlockBytes = bytes;
+
+    const bool decode = (0 == strcmp(suite, "decode") || 0 == strcmp(suite, "ldu"));
+
+    BenchBuffer originalData((size_t)k * bytes, align);
+    BenchBuffer recoveryData((size_t)m * bytes, align);
+    BenchBuffer received(decode ? (size_t)erasures * bytes : 1, align);
+
+    cm256_block blocks[256];
+    for (int i = 0; i < k; ++i)
+    {
+        blocks[i].Block = originalData.Data + (size_t)i * bytes;
+        blocks[i].Index = cm256_get_original_block_index(params, i);
+    }
+
+    if (RunEncode(params, blocks, recoveryData.Data, 1))
+    {
+        return false;
+    }
+
+    BenchSamples samples(options.Trials);
+
+    // One untimed run to warm up the caches and branch predictors
+    for (int trial = -1; trial < options.Trials; ++trial)
+    {
+        BenchClock::time_point t0, t1;
+
+        if (!decode)
+        {
+            t0 = BenchClock::now();
+            const int result = RunEncode(params, blocks, recoveryData.Data, threads);
+            t1 = BenchClock::now();
+
+            if (result)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            // Decoding overwrites the received recovery blocks, so restore them
+            for (int i = 0; i < k; ++i)
+            {
+                blocks[i].Block = originalData.Data + (size_t)i * bytes;
+                blocks[i].Index = cm256_get_original_block_index(params, i);
+            }
+            for (int i = 0; i < erasures; ++i)
+            {
+                uint8_t* block = received.Data + (size_t)i * bytes;
+                memcpy(block, recoveryData.Data + (size_t)i * bytes, bytes);
+                blocks[i].Block = block;
+                blocks[i].Index = cm256_get_recovery_block_index(params, i);
+            }
+
+            t0 = BenchClock::now();
+            const int result = RunDecode(params, blocks, threads);
+            t1 = BenchClock::now();
+
+            if (result)
+            {
+                return false;
+            }
+        }
+
+        if (trial >= 0)
+        {
+            samples.Add(t0, t1);
+        }
+    }
+
+    BenchRecord record;
+    record.Suite = suite;
+    record.Name = decode ? "cm256_decode" : "cm256_encode";
+    record.K = k;
+    record.M = m;
+    record.Bytes = bytes;
+    record.Erasures = decode ? erasures : 0;
+    record.Align = align;
+    record.Threads = threads;
+    record.DataBytes = (0 == strcmp(suite, "ldu")) ? 0. : (double)k * bytes;
+    Report(record, samples);
+    return true;
+}
+
+
+//------------------------------------------------------------------------------
+// Kernel Suite
+
+enum BenchKernel
+{
+    KernelAdd,
+    KernelAdd2,
+    KernelAddSet,
+    KernelMul,
+    KernelMulAdd,
+    KernelMulMulti,
+    KernelMulPQMulti,
+    KernelCrc32c,
+
+    KernelCount
+};
+
+static const char* const kKernelNames[KernelCount] = {
+    "gf256_add_mem", "gf256_add2_mem", "gf256_addset_mem",
+    "gf256_mul_mem", "gf256_muladd_mem",
+    "gf256_mul_multi_mem", "gf256_mul_pq_multi_mem",
+    "gf256_crc32c"
+};
+
+// Time one kernel over buffers of 'bytes', with 'count' sources for the multi-source kernels
+static void BenchKernelOp(const BenchOptions& options, int kernel, int count, int bytes, int align)
+{
+    const bool multi = (kernel == KernelMulMulti || kernel == KernelMulPQMulti);
+    if (!multi)
+    {
+        count = 1;
+    }
+
+    BenchBuffer x((size_t)count * bytes, align);
+    BenchBuffer y(bytes, align);
+    BenchBuffer z(bytes, align);
+    BenchBuffer w(bytes, align);
+
+    const void* sources[256];
+    uint8_t coefficients[256];
+    for (int i = 0; i < count; ++i)
+    {
+        sources[i] = x.Data + (size_t)i * bytes;
+        coefficients[i] = (uint8_t)(i * 37 + 2);
+    }
+
+    BenchSamples samples(options.Trials);
+    volatile uint32_t crc = 0;
+
+    for (int trial = -1; trial < options.Trials; ++trial)
+    {
+        const BenchClock::time_point t0 = BenchClock::now();
+
+        switch (kernel)
+        {
+        case KernelAdd:        gf256_add_mem(z.Data, x.Data, bytes); break;
+        case KernelAdd2:       gf256_add2_mem(z.Data, x.Data, y.Data, bytes); break;
+        case KernelAddSet:     gf256_addset_mem(z.Data, x.Data, y.Data, bytes); break;
+        case KernelMul:        gf256_mul_mem(z.Data, x.Data, 0x8e, bytes); break;
+        case KernelMulAdd:     gf256_muladd_mem(z.Data, 0x8e, x.Data, bytes); break;
+        case KernelMulMulti:   gf256_mul_multi_mem(z.Data, coefficients, sources, count, bytes); break;
+        case KernelMulPQMulti: gf256_mul_pq_multi_mem(z.Data, w.Data, coefficients, sources, count, bytes); break;
+        case KernelCrc32c:     crc = gf256_crc32c(crc, x.Data, bytes); break;
+        default: break;
+        }
+
+        const BenchClock::time_point t1 = BenchClock::now();
+        if (trial >= 0)
+        {
+            samples.Add(t0, t1);
+        }
+    }
+
+    BenchRecord record;
+    record.Suite = "kernels";
+    record.Name = kKernelNames[kernel];
+    record.K = count;
+    record.M = 0;
+    record.Bytes = bytes;
+    record.Erasures = 0;
+    record.Align = align;
+    record.Threads = 1;
+    record.DataBytes = (double)count * bytes;
+    Report(record, samples);
+}
+
+
+//------------------------------------------------------------------------------
+// Entrypoint
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    if (cm256_init())
+    {
+        fprintf(stderr, "cm256_init failed\n");
+        return 2;
+    }
+
+    if (options.Backend)
+    {
+        int chosen = -1;
+        for (int i = 0; i < GF256_BACKEND_COUNT; ++i)
+        {
+            if (0 == strcmp(options.Backend, gf256_backend_name(static_cast<gf256_backend>(i))))
+            {
+                chosen = i;
+            }
+        }
+        if (chosen < 0 || gf256_set_backend(static_cast<gf256_backend>(chosen)))
+        {
+            fprintf(stderr, "backend %s is not available\n", options.Backend);
+            return 1;
+        }
+    }
+
+    CalibrateTicks(options.Ghz);
+    Csv = options.Csv;
+    BeginReport();
+
+    bool success = true;
+
+    for (int a = 0; a < options.Align.Count; ++a)
+    {
+        const int align = options.Align.Values[a];
+
+        if (options.Kernels)
+        {
+            for (int b = 0; b < options.Bytes.Count; ++b)
+            {
+                for (int kernel = 0; kernel < KernelCount; ++kernel)
+                {
+                    const bool multi = (kernel == KernelMulMulti || kernel == KernelMulPQMulti);
+                    for (int i = 0; i < (multi ? options.K.Count : 1); ++i)
+                    {
+                        const int count = options.K.Values[i];
+                        if (count >= 1 && count <= 256)
+                        {
+                            BenchKernelOp(options, kernel, count, options.Bytes.Values[b], align);
+                        }
+                    }
+                }
+            }
+        }
+
+        for (int ki = 0; ki < options.K.Count; ++ki)
+        {
+            for (int mi = 0; mi < options.M.Count; ++mi)
+            {
+                const int k = options.K.Values[ki];
+                const int m = options.M.Values[mi];
+                if (k < 1 || m < 1 || k + m > 256)
+                {
+                    continue;
+                }
+
+                // Erasure counts for this k and m
+                BenchList erasures;
+                if (options.Erasures.Count > 0)
+                {
+                    erasures = options.Erasures;
+                }
+                else
+                {
+                    erasures.Values[0] = m;
+                    erasures.Count = 1;
+                }
+                for (int e = 0; e < erasures.Count; ++e)
+                {
+                    if (erasures.Values[e] > m) erasures.Values[e] = m;
+                    if (erasures.Values[e] > k) erasures.Values[e] = k;
+                }
+
+                // Decoding one-byte blocks times the matrix generation and LDU
+                // factorization, which is independent of the block size
+                if (options.Ldu && m > 1)
+                {
+                    for (int e = 0; e < erasures.Count; ++e)
+                    {
+                        success &= BenchCodec(options, "ldu", k, m, 1, erasures.Values[e], align, 1);
+                    }
+                }
+
+                for (int b = 0; b < options.Bytes.Count; ++b)
+                {
+                    for (int t = 0; t < options.Threads.Count; ++t)
+                    {
+                        const int bytes = options.Bytes.Values[b];
+                        const int threads = options.Threads.Values[t];
+
+                        if (options.Encode)
+                        {
+                            success &= BenchCodec(options, "encode", k, m, bytes, 0, align, threads);
+                        }
+                        if (options.Decode)
+                        {
+                            for (int e = 0; e < erasures.Count; ++e)
+                            {
+                                success &= BenchCodec(options, "decode", k, m, bytes, erasures.Values[e], align, threads);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    EndReport();
+
+    if (!success)
+    {
+        fprintf(stderr, "a codec call failed\n");
+        return 3;
+    }
+    return 0;
+}
@@ -28,6 +28,9 @@
 
 #include "cm256.h"
 
+#include <thread>
+#include <atomic>
+
 
 /*
     GF(256) Cauchy Matrix Overview
@@ -88,6 +91,151 @@ extern "C" int cm256_init_(int version)
 }
 
 
+//-----------------------------------------------------------------------------
+// Instrumentation
+
+#if defined(CM256_INSTRUMENT)
+
+#if defined(_MSC_VER)
+    #include <intrin.h> // __rdtsc
+    #define CM256_HAS_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h> // __rdtsc
+    #define CM256_HAS_TSC
+#else
+    #include <chrono>
+#endif
+
+static GF256_THREAD_LOCAL cm256_stats ThreadStats;
+
+static cm256_trace_fn TraceHook = nullptr;
+static void* TraceContext = nullptr;
+
+static uint64_t ReadCycles()
+{
+#if defined(CM256_HAS_TSC)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Times the enclosing scope as one call of a phase
+struct CM256PhaseScope
+{
+    cm256_phase Phase;
+    uint64_t Bytes;
+    uint64_t Start;
+
+    CM256PhaseScope(cm256_phase phase, uint64_t bytes)
+        : Phase(phase), Bytes(bytes), Start(ReadCycles())
+    {
+    }
+
+    ~CM256PhaseScope()
+    {
+        const uint64_t cycles = ReadCycles() - Start;
+
+        ++ThreadStats.PhaseCalls[Phase];
+        ThreadStats.PhaseCycles[Phase] += cycles;
+        ThreadStats.PhaseBytes[Phase] += Bytes;
+
+        if (TraceHook)
+        {
+            cm256_trace_event event;
+            event.Type = CM256_TRACE_PHASE;
+            event.Phase = Phase;
+            event.Cycles = cycles;
+            event.Bytes = Bytes;
+            TraceHook(TraceContext, &event);
+        }
+    }
+};
+
+static void RecordHeapMatrix(int bytes)
+{
+    ++ThreadStats.HeapMatrixFallbacks;
+
+    if (TraceHook)
+    {
+        cm256_trace_event event;
+        event.Type = CM256_TRACE_HEAP_MATRIX;
+        event.Phase = CM256_PHASE_LDU;
+        event.Cycles = 0;
+        event.Bytes = static_cast<uint64_t>(bytes);
+        TraceHook(TraceContext, &event);
+    }
+}
+
+// Add counters from a library thread to the thread that joined it
+static void MergeThreadStats(const cm256_stats& stats)
+{
+    for (int i = 0; i < CM256_PHASE_COUNT; ++i)
+    {
+        ThreadStats.PhaseCalls[i] += stats.PhaseCalls[i];
+        ThreadStats.PhaseCycles[i] += stats.PhaseCycles[i];
+        ThreadStats.PhaseBytes[i] += stats.PhaseBytes[i];
+    }
+    ThreadStats.HeapMatrixFallbacks += stats.HeapMatrixFallbacks;
+    gf256_merge_stats(&stats.Kernels);
+}
+
+// Run a task on a library thread and hand back the counters it gathered
+static void RunInstrumentedTask(cm256_task_fn task, void* taskContext, int taskIndex, cm256_stats* stats)
+{
+    task(taskContext, taskIndex);
+    cm256_get_stats(stats);
+}
+
+#define CM256_PHASE_SCOPE(phase, bytes) CM256PhaseScope phaseScope(phase, static_cast<uint64_t>(bytes))
+#define CM256_HEAP_MATRIX(bytes) RecordHeapMatrix(bytes)
+
+#else // CM256_INSTRUMENT
+
+#define CM256_PHASE_SCOPE(phase, bytes)
+#define CM256_HEAP_MATRIX(bytes)
+
+#endif // CM256_INSTRUMENT
+
+extern "C" int cm256_get_stats(cm256_stats* stats)
+{
+    if (!stats)
+    {
+        return -3;
+    }
+
+#if defined(CM256_INSTRUMENT)
+    *stats = ThreadStats;
+    return gf256_get_stats(&stats->Kernels);
+#else
+    memset(stats, 0, sizeof(cm256_stats));
+    return -1;
+#endif
+}
+
+extern "C" void cm256_reset_stats()
+{
+#if defined(CM256_INSTRUMENT)
+    memset(&ThreadStats, 0, sizeof(ThreadStats));
+#endif
+    gf256_reset_stats();
+}
+
+extern "C" int cm256_set_trace_hook(cm256_trace_fn hook, void* context)
+{
+#if defined(CM256_INSTRUMENT)
+    TraceHook = hook;
+    TraceContext = context;
+    return 0;
+#else
+    (void)hook;
+    (void)context;
+    return -1;
+#endif
+}
+
+
 /*
     Selected Cauchy Matrix Form
 
@@ -130,71 +278,143 @@ static GF256_FORCE_INLINE unsigned char GetMatrixElement(unsigned char x_i, unsi
 
 
 //-----------------------------------------------------------------------------
-// Encoding
+// Worker Threads
 
-extern "C" void cm256_encode_block(
-    cm256_encoder_params params, // Encoder parameters
-    cm256_block* originals,      // Array of pointers to original blocks
-    int recoveryBlockIndex,      // Return value from cm256_get_recovery_block_index()
-    void* recoveryBlock)         // Output recovery block
+/*
+    Multi-threaded encoding and decoding split each block into byte ranges,
+    one per worker.  Every output byte depends only on the input bytes at the
+    same offset, so the workers share the read-only matrix coefficients and
+    never write to the same cache line.
+*/
+
+// Ranges are cut on cache line boundaries, which also keeps them GF256_ALIGN_BYTES aligned
+static const int kThreadRangeAlignBytes = 64;
+
+// Smallest range worth handing to another thread
+static const int kThreadRangeMinBytes = 32 * 1024;
+
+// Returns 0 if the threading options are usable, or the error code
+static int ValidateThreading(const cm256_threading* threading)
 {
-    // If only one block of input data,
-    if (params.OriginalCount == 1)
+    if (!threading)
     {
-        // No meaningful operation here, degenerate to outputting the same data each time.
+        return -3;
+    }
+    if (threading->ThreadCount <= 0)
+    {
+        return -4;
+    }
+    return 0;
+}
+
+// Returns the number of byte ranges to split the blocks into, and the width of each
+static int GetThreadRanges(const cm256_threading* threading, int blockBytes, int* rangeBytesOut)
+{
+    int rangeCount = threading->ThreadCount;
+
+    // Do not split the blocks finer than the minimum range size
+    const int maxRanges = blockBytes / kThreadRangeMinBytes;
+    if (rangeCount > maxRanges)
+    {
+        rangeCount = maxRanges;
+    }
+    if (rangeCount <= 1)
+    {
+        *rangeBytesOut = blockBytes;
+        return 1;
+    }
+
+    // Round range widths up to the alignment so only the last range is short
+    int rangeBytes = (blockBytes + rangeCount - 1) / rangeCount;
+    rangeBytes = (rangeBytes + kThreadRangeAlignBytes - 1) & ~(kThreadRangeAlignBytes - 1);
+
+    *rangeBytesOut = rangeBytes;
+    return (blockBytes + rangeBytes - 1) / rangeBytes;
+}
+
+// Byte range of one task, clipped to the end of the block
+static void GetTaskRange(int taskIndex, int rangeBytes, int blockBytes, int* offsetOut, int* bytesOut)
+{
+    const int offset = taskIndex * rangeBytes;
+    int bytes = blockBytes - offset;
+    if (bytes > rangeBytes)
+    {
+        bytes = rangeBytes;
+    }
+
+    *offsetOut = offset;
+    *bytesOut = bytes;
+}
 
-        memcpy(recoveryBlock, originals[0].Block, params.BlockBytes);
+// Run all tasks on the caller's scheduler, or on std::threads joined before returning
+extern "C" void cm256_run_tasks(
+    const cm256_threading* threading, // Threading options, or null to use library threads
+    cm256_task_fn task,               // Function to call for each task
+    void* taskContext,                // Context to pass to the task function
+    int taskCount)                    // Number of tasks to run
+{
+    if (taskCount <= 1)
+    {
+        task(taskContext, 0);
         return;
     }
-    // else OriginalCount >= 2:
 
-    // Unroll first row of recovery matrix:
-    // The matrix we generate for the first row is all ones,
-    // so it is merely a parity of the original data.
-    if (recoveryBlockIndex == params.OriginalCount)
+    if (threading && threading->Scheduler)
     {
-        gf256_addset_mem(recoveryBlock, originals[0].Block, originals[1].Block, params.BlockBytes);
-        for (int j = 2; j < params.OriginalCount; ++j)
-        {
-            gf256_add_mem(recoveryBlock, originals[j].Block, params.BlockBytes);
-        }
+        threading->Scheduler(threading->SchedulerContext, task, taskContext, taskCount);
         return;
     }
 
-    // TBD: Faster algorithms seem to exist for computing this matrix-vector product.
+    // The calling thread runs the first task itself
+    std::thread* threads = new std::thread[taskCount - 1];
+    int started = 0;
 
-    // Start the x_0 values arbitrarily from the original count.
-    const uint8_t x_0 = static_cast<uint8_t>(params.OriginalCount);
+#if defined(CM256_INSTRUMENT)
+    cm256_stats* threadStats = new cm256_stats[taskCount - 1];
+#endif
 
-    // For other rows:
+    try
     {
-        const uint8_t x_i = static_cast<uint8_t>(recoveryBlockIndex);
-
-        // Unroll first operation for speed
+        for (; started < taskCount - 1; ++started)
         {
-            const uint8_t y_0 = 0;
-            const uint8_t matrixElement = GetMatrixElement(x_i, x_0, y_0);
-
-            gf256_mul_mem(recoveryBlock, originals[0].Block, matrixElement, params.BlockBytes);
+#if defined(CM256_INSTRUMENT)
+            threads[started] = std::thread(RunInstrumentedTask, task, taskContext, started + 1, threadStats + started);
+#else
+            threads[started] = std::thread(task, taskContext, started + 1);
+#endif
         }
-
-        // For each original data column,
-        for (int j = 1; j < params.OriginalCount; ++j)
+    }
+    catch (...)
+    {
+        // Thread creation failed: Run the remaining tasks on this thread
+        for (int i = started; i < taskCount - 1; ++i)
         {
-            const uint8_t y_j = static_cast<uint8_t>(j);
-            const uint8_t matrixElement = GetMatrixElement(x_i, x_0, y_j);
-
-            gf256_muladd_mem(recoveryBlock, matrixElement, originals[j].Block, params.BlockBytes);
+            task(taskContext, i + 1);
         }
     }
+
+    task(taskContext, 0);
+
+    for (int i = 0; i < started; ++i)
+    {
+        threads[i].join();
+#if defined(CM256_INSTRUMENT)
+        MergeThreadStats(threadStats[i]);
+#endif
+    }
+    delete[] threads;
+#if defined(CM256_INSTRUMENT)
+    delete[] threadStats;
+#endif
 }
 
-extern "C" int cm256_encode(
-    cm256_encoder_params params, // Encoder params
-    cm256_block* originals,      // Array of pointers to original blocks
-    void* recoveryBlocks)        // Output recovery blocks end-to-end
+
+//-----------------------------------------------------------------------------
+// Encoding
+
+// Returns 0 if the parameters describe a valid code, or the error code for cm256_encode()
+static int ValidateParams(const cm256_encoder_params& params)
 {
-    // Validate input:
     if (params.OriginalCount <= 0 ||
         params.RecoveryCount <= 0 ||
         params.BlockBytes <= 0)
@@ -205,365 +425,3875 @@ extern "C" int cm256_encode(
     {
         return -2;
     }
-    if (!originals || !recoveryBlocks)
+    return 0;
+}
+
+// Generate the coefficients of one recovery row of the encoding matrix
+static void GenerateMatrixRow(
+    const cm256_encoder_params& params, // Encoder parameters
+    int recoveryBlockIndex,             // Return value from cm256_get_recovery_block_index()
+    uint8_t* matrixRow)                 // Output OriginalCount coefficients
+{
+    // Start the x_0 values arbitrarily from the original count.
+    const uint8_t x_0 = static_cast<uint8_t>(params.OriginalCount);
+    const uint8_t x_i = static_cast<uint8_t>(recoveryBlockIndex);
+
+    // For each original data column,
+    for (int j = 0; j < params.OriginalCount; ++j)
     {
-        return -3;
+        const uint8_t y_j = static_cast<uint8_t>(j);
+        matrixRow[j] = GetMatrixElement(x_i, x_0, y_j);
     }
+}
+
+// Encode one recovery row over the byte range [offset, offset + bytes) of each block
+static void EncodeBlockRange(
+    const cm256_encoder_params& params, // Encoder parameters
+    const cm256_block* originals,       // Array of pointers to original blocks
+    int recoveryBlockIndex,             // Return value from cm256_get_recovery_block_index()
+    const uint8_t* matrixRow,           // Row coefficients, or null to generate them
+    uint8_t* recoveryBlock,             // Output recovery block, already offset
+    int offset,                         // Byte offset into each original block
+    int bytes)                          // Number of bytes to produce
+{
+    // If only one block of input data,
+    if (params.OriginalCount == 1)
+    {
+        // No meaningful operation here, degenerate to outputting the same data each time.
 
-    uint8_t* recoveryBlock = static_cast<uint8_t*>(recoveryBlocks);
+        memcpy(recoveryBlock, static_cast<const uint8_t*>(originals[0].Block) + offset, bytes);
+        return;
+    }
+    // else OriginalCount >= 2:
 
-    for (int block = 0; block < params.RecoveryCount; ++block, recoveryBlock += params.BlockBytes)
+    // Unroll first row of recovery matrix:
+    // The matrix we generate for the first row is all ones,
+    // so it is merely a parity of the original data.
+    if (recoveryBlockIndex == params.OriginalCount)
     {
-        cm256_encode_block(params, originals, (params.OriginalCount + block), recoveryBlock);
+        gf256_addset_mem(recoveryBlock,
+                         static_cast<const uint8_t*>(originals[0].Block) + offset,
+                         static_cast<const uint8_t*>(originals[1].Block) + offset, bytes);
+        for (int j = 2; j < params.OriginalCount; ++j)
+        {
+            gf256_add_mem(recoveryBlock, static_cast<const uint8_t*>(originals[j].Block) + offset, bytes);
+        }
+        return;
     }
 
-    return 0;
-}
+    // TBD: Faster algorithms seem to exist for computing this matrix-vector product.
 
+    // For other rows:
+    uint8_t generatedRow[256];
+    if (!matrixRow)
+    {
+        GenerateMatrixRow(params, recoveryBlockIndex, generatedRow);
+        matrixRow = generatedRow;
+    }
 
-//-----------------------------------------------------------------------------
-// Decoding
+    const void* inBlocks[256];
+    for (int j = 0; j < params.OriginalCount; ++j)
+    {
+        inBlocks[j] = static_cast<const uint8_t*>(originals[j].Block) + offset;
+    }
 
-struct CM256Decoder
-{
-    // Encode parameters
-    cm256_encoder_params Params;
+    // Sum all of the products into the recovery block in one pass
+    gf256_mul_multi_mem(recoveryBlock, matrixRow, inBlocks, params.OriginalCount, bytes);
+}
 
-    // Recovery blocks
-    cm256_block* Recovery[256];
-    int RecoveryCount;
+/*
+    Streaming Stores
 
-    // Original blocks
-    cm256_block* Original[256];
-    int OriginalCount;
+    Once the blocks are much larger than the last level cache, each recovery
+    byte written pulls its cache line in from memory, and that line is evicted
+    again before it is ever read.  Those writes also push out the original data
+    that the remaining rows still have to read.
 
-    // Row indices that were erased
-    uint8_t ErasuresIndices[256];
+    Above a size threshold each recovery row is instead produced into a small
+    stack chunk that stays in L1, and the chunk is copied out to the recovery
+    block with non-temporal stores that go straight to memory.
+*/
 
-    // Initialize the decoder
-    bool Initialize(cm256_encoder_params& params, cm256_block* blocks);
+// Size of the L1 chunk that one recovery row is produced into before streaming it out
+static const int kStreamChunkBytes = 4096;
 
-    // Decode m=1 case
-    void DecodeM1();
+// Default working set size, in bytes of original plus recovery data, above which stores stream
+static const int64_t kDefaultStreamingThreshold = (int64_t)64 * 1024 * 1024;
 
-    // Decode for m>1 case
-    void Decode();
+// Only read once per encode, so relaxed ordering is enough
+static std::atomic<int64_t> StreamingThreshold(kDefaultStreamingThreshold);
 
-    // Generate the LU decomposition of the matrix
-    void GenerateLDUDecomposition(uint8_t* matrix_L, uint8_t* diag_D, uint8_t* matrix_U);
-};
+extern "C" void cm256_set_streaming_threshold(int64_t bytes)
+{
+    StreamingThreshold.store(bytes, std::memory_order_relaxed);
+}
 
-bool CM256Decoder::Initialize(cm256_encoder_params& params, cm256_block* blocks)
+// Returns true if recovery data should be written with streaming stores
+static bool UseStreamingStores(const cm256_encoder_params& params)
 {
-    Params = params;
+    const int64_t threshold = StreamingThreshold.load(std::memory_order_relaxed);
+    if (threshold < 0)
+    {
+        return false;
+    }
 
-    cm256_block* block = blocks;
-    OriginalCount = 0;
-    RecoveryCount = 0;
+    const int64_t workingSet = (int64_t)(params.OriginalCount + params.RecoveryCount) * params.BlockBytes;
+    return workingSet >= threshold;
+}
 
-    // Initialize erasures to zeros
-    for (int ii = 0; ii < params.OriginalCount; ++ii)
+// Same as EncodeBlockRange() except that the recovery block is written with streaming stores
+static void EncodeBlockRangeStreaming(
+    const cm256_encoder_params& params, // Encoder parameters
+    const cm256_block* originals,       // Array of pointers to original blocks
+    int recoveryBlockIndex,             // Return value from cm256_get_recovery_block_index()
+    const uint8_t* matrixRow,           // Row coefficients, or null to generate them
+    uint8_t* recoveryBlock,             // Output recovery block, already offset
+    int offset,                         // Byte offset into each original block
+    int bytes)                          // Number of bytes to produce
+{
+    // A single original is copied as-is, so there is nothing to compute first
+    if (params.OriginalCount == 1)
     {
-        ErasuresIndices[ii] = 0;
+        gf256_memcpy_nt(recoveryBlock, static_cast<const uint8_t*>(originals[0].Block) + offset, bytes);
+        return;
     }
 
-    // For each input block,
-    for (int ii = 0; ii < params.OriginalCount; ++ii, ++block)
+    uint8_t generatedRow[256];
+    if (!matrixRow && recoveryBlockIndex != params.OriginalCount)
     {
-        int row = block->Index;
-
-        // If it is an original block,
-        if (row < params.OriginalCount)
-        {
-            Original[OriginalCount++] = block;
-
-            if (ErasuresIndices[row] != 0)
-            {
-                // Error out if two row indices repeat
-                return false;
-            }
-
-            ErasuresIndices[row] = 1;
-        }
-        else
-        {
-            Recovery[RecoveryCount++] = block;
-        }
+        GenerateMatrixRow(params, recoveryBlockIndex, generatedRow);
+        matrixRow = generatedRow;
     }
 
-    // Identify erasures
-    for (int ii = 0, indexCount = 0; ii < 256; ++ii)
+    GF256_ALIGNED uint8_t chunk[kStreamChunkBytes];
+    for (int done = 0; done < bytes; done += kStreamChunkBytes)
     {
-        if (!ErasuresIndices[ii])
+        int chunkBytes = bytes - done;
+        if (chunkBytes > kStreamChunkBytes)
         {
-            ErasuresIndices[indexCount] = static_cast<uint8_t>( ii );
-
-            if (++indexCount >= RecoveryCount)
-            {
-                break;
-            }
+            chunkBytes = kStreamChunkBytes;
         }
+
+        EncodeBlockRange(params, originals, recoveryBlockIndex, matrixRow, chunk, offset + done, chunkBytes);
+        gf256_memcpy_nt_unfenced(recoveryBlock + done, chunk, chunkBytes);
     }
 
-    return true;
+    // One fence orders all of the chunks of the range
+    gf256_stream_fence();
 }
 
-void CM256Decoder::DecodeM1()
+// Same as EncodeM2Range() except that both recovery blocks are written with streaming stores
+static void EncodeM2RangeStreaming(
+    const cm256_encoder_params& params, // Encoder parameters, with OriginalCount >= 2
+    const cm256_block* originals,       // Array of pointers to original blocks
+    const uint8_t* matrixRow,           // Second row coefficients, or null to generate them
+    uint8_t* recoveryData,              // Output recovery blocks end-to-end, not offset
+    int offset,                         // Byte offset into each block
+    int bytes)                          // Number of bytes to produce
 {
-    // XOR all other blocks into the recovery block
-    uint8_t* outBlock = static_cast<uint8_t*>(Recovery[0]->Block);
-    const uint8_t* inBlock = nullptr;
-
-    // For each block,
-    for (int ii = 0; ii < OriginalCount; ++ii)
+    uint8_t generatedRow[256];
+    if (!matrixRow)
     {
-        const uint8_t* inBlock2 = static_cast<const uint8_t*>(Original[ii]->Block);
+        GenerateMatrixRow(params, params.OriginalCount + 1, generatedRow);
+        matrixRow = generatedRow;
+    }
 
-        if (!inBlock)
+    const void* inBlocks[256];
+    GF256_ALIGNED uint8_t chunkP[kStreamChunkBytes];
+    GF256_ALIGNED uint8_t chunkQ[kStreamChunkBytes];
+
+    const int rangeEnd = offset + bytes;
+    for (; offset < rangeEnd; offset += kStreamChunkBytes)
+    {
+        int chunkBytes = rangeEnd - offset;
+        if (chunkBytes > kStreamChunkBytes)
         {
-            inBlock = inBlock2;
+            chunkBytes = kStreamChunkBytes;
         }
-        else
+
+        for (int j = 0; j < params.OriginalCount; ++j)
         {
-            // outBlock ^= inBlock ^ inBlock2
-            gf256_add2_mem(outBlock, inBlock, inBlock2, Params.BlockBytes);
-            inBlock = nullptr;
+            inBlocks[j] = static_cast<const uint8_t*>(originals[j].Block) + offset;
         }
-    }
 
-    // Complete XORs
-    if (inBlock)
-    {
-        gf256_add_mem(outBlock, inBlock, Params.BlockBytes);
+        gf256_mul_pq_multi_mem(chunkP, chunkQ, matrixRow, inBlocks, params.OriginalCount, chunkBytes);
+        gf256_memcpy_nt_unfenced(recoveryData + offset, chunkP, chunkBytes);
+        gf256_memcpy_nt_unfenced(recoveryData + params.BlockBytes + offset, chunkQ, chunkBytes);
     }
 
-    // Recover the index it corresponds to
-    Recovery[0]->Index = ErasuresIndices[0];
+    gf256_stream_fence();
 }
 
-// Generate the LU decomposition of the matrix
-void CM256Decoder::GenerateLDUDecomposition(uint8_t* matrix_L, uint8_t* diag_D, uint8_t* matrix_U)
-{
-    // Schur-type-direct-Cauchy algorithm 2.5 from
-    // "Pivoting and Backward Stability of Fast Algorithms for Solving Cauchy Linear Equations"
-    // T. Boros, T. Kailath, V. Olshevsky
+extern "C" void cm256_encode_block(
+    cm256_encoder_params params, // Encoder parameters
+    cm256_block* originals,      // Array of pointers to original blocks
+    int recoveryBlockIndex,      // Return value from cm256_get_recovery_block_index()
+    void* recoveryBlock)         // Output recovery block
+{
+    CM256_PHASE_SCOPE(CM256_PHASE_ENCODE, params.BlockBytes);
+
+    if (UseStreamingStores(params))
+    {
+        EncodeBlockRangeStreaming(params, originals, recoveryBlockIndex, nullptr, static_cast<uint8_t*>(recoveryBlock), 0, params.BlockBytes);
+        return;
+    }
+
+    EncodeBlockRange(params, originals, recoveryBlockIndex, nullptr, static_cast<uint8_t*>(recoveryBlock), 0, params.BlockBytes);
+}
+
+// Stack strip for cm256_update(), small enough to stay in L1 across every recovery row
+static const int kUpdateStripBytes = 4096;
+
+static int ValidateUpdate(const cm256_encoder_params& params, int originalIndex, int offset, int bytes, const void* recoveryBlocks)
+{
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+    if (originalIndex < 0 || originalIndex >= params.OriginalCount)
+    {
+        return -5;
+    }
+    if (offset < 0 || bytes < 0 || bytes > params.BlockBytes - offset)
+    {
+        return -1;
+    }
+    if (!recoveryBlocks)
+    {
+        return -3;
+    }
+    return 0;
+}
+
+// Add c_ij * delta[] into bytes [offset, offset + bytes) of every recovery block
+static void UpdateRecoveryRange(
+    const cm256_encoder_params& params, // Encoder parameters
+    int originalIndex,                  // Original block that changed
+    const uint8_t* delta,               // XOR of the previous and new contents
+    int offset,                         // First changed byte of the block
+    int bytes,                          // Number of changed bytes
+    uint8_t* recoveryData)              // Recovery blocks end-to-end
+{
+    // Start the x_0 values arbitrarily from the original count.
+    const uint8_t x_0 = static_cast<uint8_t>(params.OriginalCount);
+    const uint8_t y_j = static_cast<uint8_t>(originalIndex);
+
+    for (int i = 0; i < params.RecoveryCount; ++i)
+    {
+        const uint8_t x_i = static_cast<uint8_t>(params.OriginalCount + i);
+
+        // With one original every recovery block is a copy of it.  Otherwise the
+        // parity row element is 1, which gf256_muladd_mem() performs as plain XOR.
+        const uint8_t c_ij = (params.OriginalCount == 1) ? 1 : GetMatrixElement(x_i, x_0, y_j);
+
+        gf256_muladd_mem(recoveryData + (size_t)i * params.BlockBytes + offset, c_ij, delta, bytes);
+    }
+}
+
+extern "C" int cm256_update_delta(
+    cm256_encoder_params params, // Encoder parameters
+    int originalIndex,           // Original block that changed
+    const void* delta,           // XOR of the previous and new contents of the changed bytes
+    int offset,                  // First changed byte of the block
+    int bytes,                   // Number of changed bytes
+    void* recoveryBlocks)        // Recovery blocks end-to-end, updated in place
+{
+    const int result = ValidateUpdate(params, originalIndex, offset, bytes, recoveryBlocks);
+    if (result != 0)
+    {
+        return result;
+    }
+    if (!delta)
+    {
+        return -3;
+    }
+
+    UpdateRecoveryRange(params, originalIndex, static_cast<const uint8_t*>(delta), offset, bytes,
+                        static_cast<uint8_t*>(recoveryBlocks));
+    return 0;
+}
+
+extern "C" int cm256_update(
+    cm256_encoder_params params, // Encoder parameters
+    int originalIndex,           // Original block that changed
+    const void* oldData,         // Previous contents of the changed bytes
+    const void* newData,         // New contents of the changed bytes
+    int offset,                  // First changed byte of the block
+    int bytes,                   // Number of changed bytes
+    void* recoveryBlocks)        // Recovery blocks end-to-end, updated in place
+{
+    const int result = ValidateUpdate(params, originalIndex, offset, bytes, recoveryBlocks);
+    if (result != 0)
+    {
+        return result;
+    }
+    if (!oldData || !newData)
+    {
+        return -3;
+    }
+
+    const uint8_t* oldBytes = static_cast<const uint8_t*>(oldData);
+    const uint8_t* newBytes = static_cast<const uint8_t*>(newData);
+
+    // Form the delta one strip at a time and apply it to every row while it is in cache
+    GF256_ALIGNED uint8_t delta[kUpdateStripBytes];
+    for (int done = 0; done < bytes; done += kUpdateStripBytes)
+    {
+        int stripBytes = bytes - done;
+        if (stripBytes > kUpdateStripBytes)
+        {
+            stripBytes = kUpdateStripBytes;
+        }
+
+        gf256_addset_mem(delta, oldBytes + done, newBytes + done, stripBytes);
+        UpdateRecoveryRange(params, originalIndex, delta, offset + done, stripBytes,
+                            static_cast<uint8_t*>(recoveryBlocks));
+    }
+
+    return 0;
+}
+
+// Encode both recovery blocks of an m=2 code over the byte range [offset, offset + bytes) of each block
+static void EncodeM2Range(
+    const cm256_encoder_params& params, // Encoder parameters, with OriginalCount >= 2
+    const cm256_block* originals,       // Array of pointers to original blocks
+    const uint8_t* matrixRow,           // Second row coefficients, or null to generate them
+    uint8_t* recoveryData,              // Output recovery blocks end-to-end, not offset
+    int offset,                         // Byte offset into each block
+    int bytes)                          // Number of bytes to produce
+{
+    uint8_t generatedRow[256];
+    if (!matrixRow)
+    {
+        GenerateMatrixRow(params, params.OriginalCount + 1, generatedRow);
+        matrixRow = generatedRow;
+    }
+
+    const void* inBlocks[256];
+    for (int j = 0; j < params.OriginalCount; ++j)
+    {
+        inBlocks[j] = static_cast<const uint8_t*>(originals[j].Block) + offset;
+    }
+
+    // The first row is the parity, so both rows are summed from one read of each original
+    gf256_mul_pq_multi_mem(recoveryData + offset, recoveryData + params.BlockBytes + offset,
+                           matrixRow, inBlocks, params.OriginalCount, bytes);
+}
+
+/*
+    Tiled Encoding
+
+    Producing each recovery row in turn reads every original block once per row,
+    so for blocks larger than the cache the originals are streamed from memory
+    RecoveryCount times.  Instead the blocks are walked in byte strips, and all
+    of the recovery rows are produced for one strip before moving to the next.
+
+    The strip width is chosen so that one strip of every original plus the
+    recovery strip being written stays resident in the L2 cache.  Each original
+    byte is then read from memory about once per encode.
+*/
+
+// Cache budget for the working set of one strip
+static const int kEncodeTileCacheBytes = 256 * 1024;
+
+// Smallest strip worth the per-kernel overhead of another pass
+static const int kEncodeTileMinBytes = 1024;
+
+// Strips are cut on cache line boundaries
+static const int kEncodeTileAlignBytes = 64;
+
+// Returns the strip width for a tiled encode, or BlockBytes if tiling does not help
+static int GetEncodeTileBytes(const cm256_encoder_params& params)
+{
+    int tileBytes = kEncodeTileCacheBytes / (params.OriginalCount + 1);
+    tileBytes -= tileBytes % kEncodeTileAlignBytes;
+
+    if (tileBytes < kEncodeTileMinBytes)
+    {
+        tileBytes = kEncodeTileMinBytes;
+    }
+
+    // Only a single recovery row gains nothing from tiling
+    if (params.RecoveryCount <= 1 || tileBytes >= params.BlockBytes)
+    {
+        return params.BlockBytes;
+    }
+
+    return tileBytes;
+}
+
+// Encode the byte range [rangeOffset, rangeOffset + rangeBytes) of all recovery blocks, one strip at a time
+static void EncodeStrips(
+    const cm256_encoder_params& params, // Encoder parameters
+    const cm256_block* originals,       // Array of pointers to original blocks
+    const uint8_t* matrix,              // RecoveryCount rows of coefficients, or null to generate them
+    int tileBytes,                      // Return value from GetEncodeTileBytes()
+    uint8_t* recoveryData,              // Output recovery blocks end-to-end
+    int rangeOffset,                    // First byte of each block to encode
+    int rangeBytes)                     // Number of bytes of each block to encode
+{
+    CM256_PHASE_SCOPE(CM256_PHASE_ENCODE, static_cast<uint64_t>(params.RecoveryCount) * rangeBytes);
+
+    // Tiled strips already keep the originals in cache, so only whole-block rows stream
+    const bool streaming = (params.RecoveryCount <= 2) && UseStreamingStores(params);
+
+    // Both rows of an m=2 code come from a single pass over the originals, so there is nothing to tile
+    if (params.RecoveryCount == 2 && params.OriginalCount > 1)
+    {
+        if (streaming)
+        {
+            EncodeM2RangeStreaming(params, originals, matrix ? matrix + params.OriginalCount : nullptr,
+                                   recoveryData, rangeOffset, rangeBytes);
+        }
+        else
+        {
+            EncodeM2Range(params, originals, matrix ? matrix + params.OriginalCount : nullptr,
+                          recoveryData, rangeOffset, rangeBytes);
+        }
+        return;
+    }
+
+    const int rangeEnd = rangeOffset + rangeBytes;
+
+    // For each strip of the blocks,
+    for (int offset = rangeOffset; offset < rangeEnd; offset += tileBytes)
+    {
+        int bytes = rangeEnd - offset;
+        if (bytes > tileBytes)
+        {
+            bytes = tileBytes;
+        }
+
+        uint8_t* recoveryBlock = recoveryData + offset;
+        const uint8_t* matrixRow = matrix;
+
+        // Produce this strip of every recovery block while the originals are in cache
+        for (int block = 0; block < params.RecoveryCount; ++block, recoveryBlock += params.BlockBytes)
+        {
+            if (streaming)
+            {
+                EncodeBlockRangeStreaming(params, originals, (params.OriginalCount + block), matrixRow, recoveryBlock, offset, bytes);
+            }
+            else
+            {
+                EncodeBlockRange(params, originals, (params.OriginalCount + block), matrixRow, recoveryBlock, offset, bytes);
+            }
+
+            if (matrixRow)
+            {
+                matrixRow += params.OriginalCount;
+            }
+        }
+    }
+}
+
+extern "C" int cm256_encode(
+    cm256_encoder_params params, // Encoder params
+    cm256_block* originals,      // Array of pointers to original blocks
+    void* recoveryBlocks)        // Output recovery blocks end-to-end
+{
+    // Validate input:
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+    if (!originals || !recoveryBlocks)
+    {
+        return -3;
+    }
+
+    EncodeStrips(params, originals, nullptr, GetEncodeTileBytes(params), static_cast<uint8_t*>(recoveryBlocks), 0, params.BlockBytes);
+
+    return 0;
+}
+
+
+struct CM256EncodeTasks
+{
+    cm256_encoder_params Params;
+    const cm256_block* Originals;
+    uint8_t* RecoveryData;
+    int TileBytes;
+    int RangeBytes;
+};
+
+static void EncodeTask(void* context, int taskIndex)
+{
+    const CM256EncodeTasks* tasks = static_cast<const CM256EncodeTasks*>(context);
+
+    int offset, bytes;
+    GetTaskRange(taskIndex, tasks->RangeBytes, tasks->Params.BlockBytes, &offset, &bytes);
+
+    EncodeStrips(tasks->Params, tasks->Originals, nullptr, tasks->TileBytes, tasks->RecoveryData, offset, bytes);
+}
+
+extern "C" int cm256_encode_mt(
+    cm256_encoder_params params,       // Encoder parameters
+    cm256_block* originals,            // Array of pointers to original blocks
+    void* recoveryBlocks,              // Output recovery blocks end-to-end
+    const cm256_threading* threading)  // Threading options
+{
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+    if (!originals || !recoveryBlocks)
+    {
+        return -3;
+    }
+    const int threadingResult = ValidateThreading(threading);
+    if (threadingResult != 0)
+    {
+        return threadingResult;
+    }
+
+    CM256EncodeTasks tasks;
+    tasks.Params = params;
+    tasks.Originals = originals;
+    tasks.RecoveryData = static_cast<uint8_t*>(recoveryBlocks);
+    tasks.TileBytes = GetEncodeTileBytes(params);
+
+    const int taskCount = GetThreadRanges(threading, params.BlockBytes, &tasks.RangeBytes);
+    cm256_run_tasks(threading, EncodeTask, &tasks, taskCount);
+    return 0;
+}
+
+
+/*
+    Batch Encoding
+
+    For small blocks the per-call cost of validating parameters and generating
+    the matrix coefficients is similar to the cost of the data math itself.
+    Batches generate the coefficients once and then encode each stripe in turn,
+    so the originals of one stripe stay in L1 cache while all of its recovery
+    blocks are produced.
+*/
+
+// Encode 'stripeCount' stripes with the same parameters and coefficients
+static void EncodeBatch(
+    const cm256_encoder_params& params, // Encoder parameters
+    const cm256_block* originals,       // stripeCount * OriginalCount original blocks
+    const uint8_t* matrix,              // RecoveryCount rows of coefficients
+    uint8_t* recoveryData,              // Output stripeCount * RecoveryCount recovery blocks end-to-end
+    int stripeCount)                    // Number of stripes
+{
+    const int tileBytes = GetEncodeTileBytes(params);
+    const size_t stripeRecoveryBytes = (size_t)params.RecoveryCount * params.BlockBytes;
+
+    for (int stripe = 0; stripe < stripeCount; ++stripe)
+    {
+        EncodeStrips(params, originals, matrix, tileBytes, recoveryData, 0, params.BlockBytes);
+
+        originals += params.OriginalCount;
+        recoveryData += stripeRecoveryBytes;
+    }
+}
+
+extern "C" int cm256_encode_batch(
+    cm256_encoder_params params, // Encoder parameters
+    cm256_block* originals,      // Array of stripeCount * originalCount original blocks
+    void* recoveryBlocks,        // Output stripeCount * recoveryCount recovery blocks end-to-end
+    int stripeCount)             // Number of stripes
+{
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+    if (!originals || !recoveryBlocks)
+    {
+        return -3;
+    }
+    if (stripeCount <= 0)
+    {
+        return stripeCount == 0 ? 0 : -1;
+    }
+
+    uint8_t* matrix = new uint8_t[params.RecoveryCount * params.OriginalCount];
+
+    uint8_t* matrixRow = matrix;
+    for (int block = 0; block < params.RecoveryCount; ++block, matrixRow += params.OriginalCount)
+    {
+        GenerateMatrixRow(params, params.OriginalCount + block, matrixRow);
+    }
+
+    EncodeBatch(params, originals, matrix, static_cast<uint8_t*>(recoveryBlocks), stripeCount);
+
+    delete[] matrix;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// Encoder Context
+
+struct cm256_encoder_ctx_t
+{
+    // Encode parameters
+    cm256_encoder_params Params;
+
+    // Strip width for tiled encoding
+    int TileBytes;
+
+    // RecoveryCount rows of OriginalCount coefficients each.
+    // Rows are laid out in the order the multi-source kernel consumes them.
+    uint8_t* Matrix;
+};
+
+extern "C" int cm256_encoder_create(
+    cm256_encoder_params params, // Encoder parameters
+    cm256_encoder_ctx** ctxOut)  // Output encoder context
+{
+    if (!ctxOut)
+    {
+        return -3;
+    }
+    *ctxOut = nullptr;
+
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+
+    cm256_encoder_ctx* ctx = new cm256_encoder_ctx;
+    ctx->Params = params;
+    ctx->TileBytes = GetEncodeTileBytes(params);
+    ctx->Matrix = new uint8_t[params.RecoveryCount * params.OriginalCount];
+
+    uint8_t* matrixRow = ctx->Matrix;
+    for (int block = 0; block < params.RecoveryCount; ++block, matrixRow += params.OriginalCount)
+    {
+        GenerateMatrixRow(params, params.OriginalCount + block, matrixRow);
+    }
+
+    *ctxOut = ctx;
+    return 0;
+}
+
+extern "C" void cm256_encoder_free(cm256_encoder_ctx* ctx)
+{
+    if (ctx)
+    {
+        delete[] ctx->Matrix;
+        delete ctx;
+    }
+}
+
+extern "C" int cm256_encoder_encode(
+    cm256_encoder_ctx* ctx,  // Encoder context
+    cm256_block* originals,  // Array of pointers to original blocks
+    void* recoveryBlocks)    // Output recovery blocks end-to-end
+{
+    if (!ctx || !originals || !recoveryBlocks)
+    {
+        return -3;
+    }
+
+    EncodeStrips(ctx->Params, originals, ctx->Matrix, ctx->TileBytes, static_cast<uint8_t*>(recoveryBlocks), 0, ctx->Params.BlockBytes);
+
+    return 0;
+}
+
+extern "C" int cm256_encoder_encode_batch(
+    cm256_encoder_ctx* ctx,  // Encoder context
+    cm256_block* originals,  // Array of stripeCount * originalCount original blocks
+    void* recoveryBlocks,    // Output stripeCount * recoveryCount recovery blocks end-to-end
+    int stripeCount)         // Number of stripes
+{
+    if (!ctx || !originals || !recoveryBlocks)
+    {
+        return -3;
+    }
+    if (stripeCount < 0)
+    {
+        return -1;
+    }
+
+    EncodeBatch(ctx->Params, originals, ctx->Matrix, static_cast<uint8_t*>(recoveryBlocks), stripeCount);
+
+    return 0;
+}
+
+extern "C" void cm256_encoder_encode_block(
+    cm256_encoder_ctx* ctx,  // Encoder context
+    cm256_block* originals,  // Array of pointers to original blocks
+    int recoveryBlockIndex,  // Return value from cm256_get_recovery_block_index()
+    void* recoveryBlock)     // Output recovery block
+{
+    const cm256_encoder_params& params = ctx->Params;
+    const uint8_t* matrixRow = ctx->Matrix + (recoveryBlockIndex - params.OriginalCount) * params.OriginalCount;
+
+    if (UseStreamingStores(params))
+    {
+        EncodeBlockRangeStreaming(params, originals, recoveryBlockIndex, matrixRow, static_cast<uint8_t*>(recoveryBlock), 0, params.BlockBytes);
+        return;
+    }
+
+    EncodeBlockRange(params, originals, recoveryBlockIndex, matrixRow, static_cast<uint8_t*>(recoveryBlock), 0, params.BlockBytes);
+}
+
+
+//-----------------------------------------------------------------------------
+// Streaming Encoder
+
+/*
+    The streaming encoder folds each original block into every recovery block
+    as soon as it is added, so the encoding work is spread out over the time the
+    originals arrive.  The first original added to a stripe initializes the
+    recovery blocks and later ones accumulate into them.  The first recovery row
+    is all ones, so it remains an XOR parity.
+*/
+
+struct cm256_stream_encoder_t
+{
+    // Encode parameters
+    cm256_encoder_params Params;
+
+    // RecoveryCount rows of OriginalCount coefficients each
+    uint8_t* Matrix;
+
+    // Output recovery blocks end-to-end, or null before init
+    uint8_t* RecoveryData;
+
+    // Nonzero for each original already added to this stripe
+    uint8_t Added[256];
+    int AddedCount;
+};
+
+extern "C" int cm256_stream_encoder_create(
+    cm256_encoder_params params,        // Encoder parameters
+    cm256_stream_encoder** encoderOut)  // Output streaming encoder
+{
+    if (!encoderOut)
+    {
+        return -3;
+    }
+    *encoderOut = nullptr;
+
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+
+    cm256_stream_encoder* encoder = new cm256_stream_encoder;
+    encoder->Params = params;
+    encoder->Matrix = new uint8_t[params.RecoveryCount * params.OriginalCount];
+    encoder->RecoveryData = nullptr;
+    encoder->AddedCount = 0;
+
+    uint8_t* matrixRow = encoder->Matrix;
+    for (int block = 0; block < params.RecoveryCount; ++block, matrixRow += params.OriginalCount)
+    {
+        GenerateMatrixRow(params, params.OriginalCount + block, matrixRow);
+    }
+
+    *encoderOut = encoder;
+    return 0;
+}
+
+extern "C" void cm256_stream_encoder_free(cm256_stream_encoder* encoder)
+{
+    if (encoder)
+    {
+        delete[] encoder->Matrix;
+        delete encoder;
+    }
+}
+
+extern "C" int cm256_stream_encoder_init(
+    cm256_stream_encoder* encoder, // Streaming encoder
+    void* recoveryBlocks)          // Output recovery blocks end-to-end
+{
+    if (!encoder || !recoveryBlocks)
+    {
+        return -3;
+    }
+
+    encoder->RecoveryData = static_cast<uint8_t*>(recoveryBlocks);
+    encoder->AddedCount = 0;
+    memset(encoder->Added, 0, sizeof(encoder->Added));
+    return 0;
+}
+
+extern "C" int cm256_stream_encoder_add(
+    cm256_stream_encoder* encoder, // Streaming encoder
+    int originalIndex,             // Return value from cm256_get_original_block_index()
+    const void* originalBlock)     // Original block data
+{
+    if (!encoder || !encoder->RecoveryData || !originalBlock)
+    {
+        return -3;
+    }
+
+    const cm256_encoder_params& params = encoder->Params;
+    if (originalIndex < 0 || originalIndex >= params.OriginalCount || encoder->Added[originalIndex])
+    {
+        return -5;
+    }
+
+    const bool first = (encoder->AddedCount == 0);
+    encoder->Added[originalIndex] = 1;
+    ++encoder->AddedCount;
+
+    uint8_t* recoveryBlock = encoder->RecoveryData;
+
+    // If only one block of input data,
+    if (params.OriginalCount == 1)
+    {
+        // Degenerate to outputting the same data each time.
+        for (int block = 0; block < params.RecoveryCount; ++block, recoveryBlock += params.BlockBytes)
+        {
+            memcpy(recoveryBlock, originalBlock, params.BlockBytes);
+        }
+        return 0;
+    }
+
+    // First row is all ones: Parity
+    if (first)
+    {
+        memcpy(recoveryBlock, originalBlock, params.BlockBytes);
+    }
+    else
+    {
+        gf256_add_mem(recoveryBlock, originalBlock, params.BlockBytes);
+    }
+    recoveryBlock += params.BlockBytes;
+
+    // For other rows:
+    const uint8_t* coefficient = encoder->Matrix + params.OriginalCount + originalIndex;
+    for (int block = 1; block < params.RecoveryCount; ++block, recoveryBlock += params.BlockBytes)
+    {
+        if (first)
+        {
+            gf256_mul_mem(recoveryBlock, originalBlock, *coefficient, params.BlockBytes);
+        }
+        else
+        {
+            gf256_muladd_mem(recoveryBlock, *coefficient, originalBlock, params.BlockBytes);
+        }
+        coefficient += params.OriginalCount;
+    }
+
+    return 0;
+}
+
+extern "C" int cm256_stream_encoder_finalize(cm256_stream_encoder* encoder)
+{
+    if (!encoder || !encoder->RecoveryData)
+    {
+        return -3;
+    }
+
+    // All originals must be added before the recovery blocks are complete
+    if (encoder->AddedCount != encoder->Params.OriginalCount)
+    {
+        return -6;
+    }
+
+    encoder->RecoveryData = nullptr;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// Decoder Cache
+
+/*
+    Erasure-Pattern Cache
+
+    The LDU decomposition only depends on the original count, the indices of
+    the recovery rows in the order they were received, and the indices of the
+    erased original rows.  Under steady-state loss the same few patterns repeat,
+    so the decomposed matrix bytes are kept in a small LRU cache keyed on these.
+
+    The cache is a flat array searched linearly by hash, which is cheaper than
+    a node-based map for the handful of entries it is meant to hold.
+*/
+
+// Largest key: OriginalCount, N, then N recovery rows and N erased rows
+static const int kDecoderCacheKeyMaxBytes = 2 + 2 * 256;
+
+struct CM256DecoderCacheEntry
+{
+    // Hash of the key bytes, for a quick reject
+    uint32_t Hash;
+
+    // Matching key
+    uint8_t Key[kDecoderCacheKeyMaxBytes];
+    int KeyBytes;
+
+    // Cached LDU decomposition of N*N bytes
+    uint8_t* Matrix;
+    int MatrixAllocated;
+
+    // Value of the use counter when it was last hit, for LRU eviction
+    uint64_t LastUse;
+};
+
+struct cm256_decoder_cache_t
+{
+    CM256DecoderCacheEntry* Entries;
+    int EntryCount;
+    int MaxEntries;
+
+    // Incremented on each lookup
+    uint64_t UseCounter;
+
+    // Statistics
+    uint64_t Hits, Misses;
+};
+
+extern "C" int cm256_decoder_cache_create(
+    int maxEntries,                  // Maximum number of erasure patterns to keep
+    cm256_decoder_cache** cacheOut)  // Output cache
+{
+    if (!cacheOut)
+    {
+        return -3;
+    }
+    *cacheOut = nullptr;
+
+    if (maxEntries <= 0)
+    {
+        return -1;
+    }
+
+    cm256_decoder_cache* cache = new cm256_decoder_cache;
+    cache->Entries = new CM256DecoderCacheEntry[maxEntries];
+    cache->EntryCount = 0;
+    cache->MaxEntries = maxEntries;
+    cache->UseCounter = 0;
+    cache->Hits = 0;
+    cache->Misses = 0;
+
+    *cacheOut = cache;
+    return 0;
+}
+
+extern "C" void cm256_decoder_cache_free(cm256_decoder_cache* cache)
+{
+    if (cache)
+    {
+        for (int i = 0; i < cache->EntryCount; ++i)
+        {
+            delete[] cache->Entries[i].Matrix;
+        }
+        delete[] cache->Entries;
+        delete cache;
+    }
+}
+
+extern "C" void cm256_decoder_cache_stats(
+    const cm256_decoder_cache* cache, // Cache to query
+    uint64_t* hits,                   // Output number of lookups that reused a matrix
+    uint64_t* misses)                 // Output number of lookups that generated a matrix
+{
+    if (hits)
+    {
+        *hits = cache ? cache->Hits : 0;
+    }
+    if (misses)
+    {
+        *misses = cache ? cache->Misses : 0;
+    }
+}
+
+// FNV-1a hash of the key bytes
+static uint32_t HashDecoderCacheKey(const uint8_t* key, int keyBytes)
+{
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < keyBytes; ++i)
+    {
+        hash = (hash ^ key[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Returns the cached matrix for the key, or null and a slot to fill in 'entryOut' on a miss
+static uint8_t* LookupDecoderCache(
+    cm256_decoder_cache* cache,
+    const uint8_t* key,
+    int keyBytes,
+    int matrixBytes,
+    CM256DecoderCacheEntry** entryOut)
+{
+    const uint32_t hash = HashDecoderCacheKey(key, keyBytes);
+    const uint64_t use = ++cache->UseCounter;
+
+    CM256DecoderCacheEntry* oldest = nullptr;
+
+    for (int i = 0; i < cache->EntryCount; ++i)
+    {
+        CM256DecoderCacheEntry* entry = cache->Entries + i;
+
+        if (entry->Hash == hash &&
+            entry->KeyBytes == keyBytes &&
+            0 == memcmp(entry->Key, key, keyBytes))
+        {
+            entry->LastUse = use;
+            ++cache->Hits;
+            *entryOut = entry;
+            return entry->Matrix;
+        }
+
+        if (!oldest || entry->LastUse < oldest->LastUse)
+        {
+            oldest = entry;
+        }
+    }
+
+    ++cache->Misses;
+
+    // Use a free slot if there is one, otherwise evict the least recently used
+    CM256DecoderCacheEntry* entry = oldest;
+    if (cache->EntryCount < cache->MaxEntries)
+    {
+        entry = cache->Entries + cache->EntryCount++;
+        entry->Matrix = nullptr;
+        entry->MatrixAllocated = 0;
+    }
+
+    if (entry->MatrixAllocated < matrixBytes)
+    {
+        delete[] entry->Matrix;
+        entry->Matrix = new uint8_t[matrixBytes];
+        entry->MatrixAllocated = matrixBytes;
+    }
+
+    entry->Hash = hash;
+    memcpy(entry->Key, key, keyBytes);
+    entry->KeyBytes = keyBytes;
+    entry->LastUse = use;
+
+    *entryOut = entry;
+    return nullptr;
+}
+
+
+//-----------------------------------------------------------------------------
+// Decoding
+
+struct CM256Decoder
+{
+    // Encode parameters
+    cm256_encoder_params Params;
+
+    // Recovery blocks
+    cm256_block* Recovery[256];
+    int RecoveryCount;
+
+    // Original blocks
+    cm256_block* Original[256];
+    int OriginalCount;
+
+    // Row indices that were erased
+    uint8_t ErasuresIndices[256];
+
+    // Decomposition G = L * D * U for the m>1 case, set by PrepareDecode()
+    static const int StackMatrixBytes = 2048;
+    uint8_t StackMatrix[StackMatrixBytes];
+    uint8_t* DynamicMatrix;
+    int DynamicMatrixBytes;
+    const uint8_t* Matrix;
+
+    // Caller-provided space used before falling back to DynamicMatrix
+    uint8_t* ScratchMatrix;
+    int ScratchMatrixBytes;
+
+    // True if Matrix is a decomposition in decoder-owned space for the rows of PatternIndices
+    bool MatrixCurrent;
+
+    // Block indices of the last Initialize() made through RepeatInitialize()
+    uint8_t PatternIndices[256];
+    bool PatternValid;
+
+    CM256Decoder() : DynamicMatrix(nullptr), DynamicMatrixBytes(0), Matrix(nullptr),
+                     ScratchMatrix(nullptr), ScratchMatrixBytes(0),
+                     MatrixCurrent(false), PatternValid(false) {}
+    ~CM256Decoder() { delete[] DynamicMatrix; }
+
+    // Initialize the decoder
+    bool Initialize(cm256_encoder_params& params, cm256_block* blocks);
+
+    // Same as Initialize(), except that blocks with the same indices in the same order as
+    // the last call only have their pointers collected, keeping the erasures and matrix
+    bool RepeatInitialize(cm256_encoder_params& params, cm256_block* blocks);
+
+    // Replace the received original row marks in ErasuresIndices with the erased row indices
+    void IdentifyErasures();
+
+    // Add the received original data into one recovery row over [offset, offset + bytes)
+    void EliminateOriginals(int recoveryIndex, int offset, int bytes);
+
+    // Decode m=1 case over the byte range [offset, offset + bytes) of each block
+    void DecodeM1Range(int offset, int bytes);
+
+    // Decode m=1 case
+    void DecodeM1();
+
+    // Decode two recovery rows including the parity row over [offset, offset + bytes)
+    void DecodeM2Range(int offset, int bytes);
+
+    // Generate the decomposition for the m>1 case, reusing decompositions from the cache if provided
+    void PrepareDecode(cm256_decoder_cache* cache);
+
+    // True if the two recovery rows include the parity row, which DecodeRange() solves without a matrix
+    bool IsParityPair() const
+    {
+        const uint8_t x_0 = static_cast<uint8_t>(Params.OriginalCount);
+        return RecoveryCount == 2 && (Recovery[0]->Index == x_0 || Recovery[1]->Index == x_0);
+    }
+
+    // Same as PrepareDecode() before DecodeRange(), skipping the decomposition for a parity pair
+    void PrepareDecodeRange(cm256_decoder_cache* cache)
+    {
+        if (!IsParityPair())
+        {
+            PrepareDecode(cache);
+        }
+    }
+
+    // Solve for the byte range [offset, offset + bytes) of each block after PrepareDecodeRange()
+    void DecodeRange(int offset, int bytes);
+
+    // Same as DecodeRange() when the original data is already eliminated
+    void SolveRange(int offset, int bytes);
+
+    // Same as DecodeRange(), walking the range in strips that stay resident in cache
+    void DecodeStrips(int offset, int bytes);
+
+    // Set the recovered block indices after all byte ranges are decoded
+    void FinishDecode();
+
+    // Decode m=1 case into a separate output, leaving the received blocks unmodified
+    void DecodeM1IntoRange(uint8_t* output, int offset, int bytes);
+
+    // Same as DecodeRange() except that erased row ErasuresIndices[i] is written to
+    // outputs[i] and the received blocks are not modified
+    void DecodeIntoRange(uint8_t* const* outputs, int offset, int bytes);
+
+    // Decode for m>1 case, reusing decompositions from the cache if provided
+    void Decode(cm256_decoder_cache* cache);
+
+    // Generate the row of the inverse matrix that recovers erased row ErasuresIndices[erasure]
+    // from the received recovery rows: one coefficient for each of Recovery[]
+    void GenerateInverseRow(int erasure, uint8_t* inverseRow);
+
+    // Generate the coefficients over the received blocks, Recovery[] then Original[], of
+    // sum(recoveryWeights[j] * rec_j) + sum(originalWeights[y] * o_y), and return their count.
+    // originalWeights is indexed by original row and may be null for all zeros.
+    int GenerateReceivedCoefficients(const uint8_t* recoveryWeights, const uint8_t* originalWeights,
+                                     uint8_t* coefficients, const void** inBlocks);
+
+    // Generate the LU decomposition of the matrix
+    void GenerateLDUDecomposition(uint8_t* matrix_L, uint8_t* diag_D, uint8_t* matrix_U);
+};
+
+bool CM256Decoder::Initialize(cm256_encoder_params& params, cm256_block* blocks)
+{
+    Params = params;
+    MatrixCurrent = false;
+    PatternValid = false;
+
+    cm256_block* block = blocks;
+    OriginalCount = 0;
+    RecoveryCount = 0;
+
+    // Initialize erasures to zeros, marking received recovery rows in the
+    // same array past the original rows
+    const int rowCount = params.OriginalCount + params.RecoveryCount;
+    for (int ii = 0; ii < rowCount; ++ii)
+    {
+        ErasuresIndices[ii] = 0;
+    }
+
+    // For each input block,
+    for (int ii = 0; ii < params.OriginalCount; ++ii, ++block)
+    {
+        int row = block->Index;
+
+        // Error out if a row index repeats or does not exist
+        if (row >= rowCount || ErasuresIndices[row] != 0)
+        {
+            return false;
+        }
+        ErasuresIndices[row] = 1;
+
+        // If it is an original block,
+        if (row < params.OriginalCount)
+        {
+            Original[OriginalCount++] = block;
+        }
+        else
+        {
+            Recovery[RecoveryCount++] = block;
+        }
+    }
+
+    IdentifyErasures();
+
+    return true;
+}
+
+bool CM256Decoder::RepeatInitialize(cm256_encoder_params& params, cm256_block* blocks)
+{
+    if (PatternValid)
+    {
+        int originalCount = 0, recoveryCount = 0;
+
+        int ii = 0;
+        for (; ii < params.OriginalCount && blocks[ii].Index == PatternIndices[ii]; ++ii)
+        {
+            if (blocks[ii].Index < params.OriginalCount)
+            {
+                Original[originalCount++] = blocks + ii;
+            }
+            else
+            {
+                Recovery[recoveryCount++] = blocks + ii;
+            }
+        }
+
+        // If the rows are unchanged, the erasures are too
+        if (ii >= params.OriginalCount)
+        {
+            return true;
+        }
+    }
+
+    if (!Initialize(params, blocks))
+    {
+        return false;
+    }
+
+    for (int ii = 0; ii < params.OriginalCount; ++ii)
+    {
+        PatternIndices[ii] = blocks[ii].Index;
+    }
+    PatternValid = true;
+
+    return true;
+}
+
+void CM256Decoder::IdentifyErasures()
+{
+    // Identify erasures
+    for (int ii = 0, indexCount = 0; ii < 256; ++ii)
+    {
+        if (!ErasuresIndices[ii])
+        {
+            ErasuresIndices[indexCount] = static_cast<uint8_t>( ii );
+
+            if (++indexCount >= RecoveryCount)
+            {
+                break;
+            }
+        }
+    }
+}
+
+void CM256Decoder::DecodeM1Range(int offset, int bytes)
+{
+    CM256_PHASE_SCOPE(CM256_PHASE_ELIMINATE, bytes);
+
+    // XOR all other blocks into the recovery block
+    uint8_t* outBlock = static_cast<uint8_t*>(Recovery[0]->Block) + offset;
+    const uint8_t* inBlock = nullptr;
+
+    // For each block,
+    for (int ii = 0; ii < OriginalCount; ++ii)
+    {
+        const uint8_t* inBlock2 = static_cast<const uint8_t*>(Original[ii]->Block) + offset;
+
+        if (!inBlock)
+        {
+            inBlock = inBlock2;
+        }
+        else
+        {
+            // outBlock ^= inBlock ^ inBlock2
+            gf256_add2_mem(outBlock, inBlock, inBlock2, bytes);
+            inBlock = nullptr;
+        }
+    }
+
+    // Complete XORs
+    if (inBlock)
+    {
+        gf256_add_mem(outBlock, inBlock, bytes);
+    }
+}
+
+void CM256Decoder::DecodeM1()
+{
+    DecodeM1Range(0, Params.BlockBytes);
+
+    // Recover the index it corresponds to
+    Recovery[0]->Index = ErasuresIndices[0];
+}
+
+// Generate the LU decomposition of the matrix
+void CM256Decoder::GenerateLDUDecomposition(uint8_t* matrix_L, uint8_t* diag_D, uint8_t* matrix_U)
+{
+    CM256_PHASE_SCOPE(CM256_PHASE_LDU, 0);
+
+    // Schur-type-direct-Cauchy algorithm 2.5 from
+    // "Pivoting and Backward Stability of Fast Algorithms for Solving Cauchy Linear Equations"
+    // T. Boros, T. Kailath, V. Olshevsky
     // Modified for practical use.  I folded the diagonal parts of U/L matrices into the
     // diagonal one to reduce the number of multiplications to perform against the input data,
     // and organized the triangle matrices in memory to allow for faster SSE3 GF multiplications.
 
-    // Matrix size NxN
-    const int N = RecoveryCount;
+    // Matrix size NxN
+    const int N = RecoveryCount;
+
+    // Generators
+    uint8_t g[256], b[256];
+    for (int i = 0; i < N; ++i)
+    {
+        g[i] = 1;
+        b[i] = 1;
+    }
+
+    // Temporary buffer for rotated row of U matrix
+    // This allows for faster GF bulk multiplication
+    uint8_t rotated_row_U[256];
+    uint8_t* last_U = matrix_U + ((N - 1) * N) / 2 - 1;
+    int firstOffset_U = 0;
+
+    // Start the x_0 values arbitrarily from the original count.
+    const uint8_t x_0 = static_cast<uint8_t>(Params.OriginalCount);
+
+    // Unrolling k = 0 just makes it slower for some reason.
+    for (int k = 0; k < N - 1; ++k)
+    {
+        const uint8_t x_k = Recovery[k]->Index;
+        const uint8_t y_k = ErasuresIndices[k];
+
+        // D_kk = (x_k + y_k)
+        // L_kk = g[k] / (x_k + y_k)
+        // U_kk = b[k] * (x_0 + y_k) / (x_k + y_k)
+        const uint8_t D_kk = gf256_add(x_k, y_k);
+        const uint8_t L_kk = gf256_div(g[k], D_kk);
+        const uint8_t U_kk = gf256_mul(gf256_div(b[k], D_kk), gf256_add(x_0, y_k));
+
+        // diag_D[k] = D_kk * L_kk * U_kk
+        diag_D[k] = gf256_mul(D_kk, gf256_mul(L_kk, U_kk));
+
+        // Computing the k-th row of L and U
+        uint8_t* row_L = matrix_L;
+        uint8_t* row_U = rotated_row_U;
+        for (int j = k + 1; j < N; ++j)
+        {
+            const uint8_t x_j = Recovery[j]->Index;
+            const uint8_t y_j = ErasuresIndices[j];
+
+            // L_jk = g[j] / (x_j + y_k)
+            // U_kj = b[j] / (x_k + y_j)
+            const uint8_t L_jk = gf256_div(g[j], gf256_add(x_j, y_k));
+            const uint8_t U_kj = gf256_div(b[j], gf256_add(x_k, y_j));
+
+            *matrix_L++ = L_jk;
+            *row_U++ = U_kj;
+
+            // g[j] = g[j] * (x_j + x_k) / (x_j + y_k)
+            // b[j] = b[j] * (y_j + y_k) / (y_j + x_k)
+            g[j] = gf256_mul(g[j], gf256_div(gf256_add(x_j, x_k), gf256_add(x_j, y_k)));
+            b[j] = gf256_mul(b[j], gf256_div(gf256_add(y_j, y_k), gf256_add(y_j, x_k)));
+        }
+
+        // Do these row/column divisions in bulk for speed.
+        // L_jk /= L_kk
+        // U_kj /= U_kk
+        const int count = N - (k + 1);
+        gf256_div_mem_inplace(row_L, L_kk, count);
+        gf256_div_mem_inplace(rotated_row_U, U_kk, count);
+
+        // Copy U matrix row into place in memory.
+        uint8_t* output_U = last_U + firstOffset_U;
+        row_U = rotated_row_U;
+        for (int j = k + 1; j < N; ++j)
+        {
+            *output_U = *row_U++;
+            output_U -= j;
+        }
+        firstOffset_U -= k + 2;
+    }
+
+    // Multiply diagonal matrix into U
+    uint8_t* row_U = matrix_U;
+    for (int j = N - 1; j > 0; --j)
+    {
+        const uint8_t y_j = ErasuresIndices[j];
+        const int count = j;
+
+        gf256_mul_mem_inplace(row_U, gf256_add(x_0, y_j), count);
+        row_U += count;
+    }
+
+    const uint8_t x_n = Recovery[N - 1]->Index;
+    const uint8_t y_n = ErasuresIndices[N - 1];
+
+    // D_nn = 1 / (x_n + y_n)
+    // L_nn = g[N-1]
+    // U_nn = b[N-1] * (x_0 + y_n)
+    const uint8_t L_nn = g[N - 1];
+    const uint8_t U_nn = gf256_mul(b[N - 1], gf256_add(x_0, y_n));
+
+    // diag_D[N-1] = L_nn * D_nn * U_nn
+    diag_D[N - 1] = gf256_div(gf256_mul(L_nn, U_nn), gf256_add(x_n, y_n));
+}
+
+void CM256Decoder::PrepareDecode(cm256_decoder_cache* cache)
+{
+    // Matrix size is NxN, where N is the number of recovery blocks used.
+    const int N = RecoveryCount;
+
+    /*
+        Compute matrix decomposition:
+
+            G = L * D * U
+
+        L is lower-triangular, diagonal is all ones.
+        D is a diagonal matrix.
+        U is upper-triangular, diagonal is all ones.
+    */
+    // The rows have not changed since the matrix was generated
+    if (MatrixCurrent)
+    {
+        return;
+    }
+
+    const int requiredSpace = N * N;
+    uint8_t* matrix = nullptr;
+    bool generate = true;
+
+    if (cache)
+    {
+        // Key the decomposition on the erasure pattern
+        uint8_t key[kDecoderCacheKeyMaxBytes];
+        key[0] = static_cast<uint8_t>(Params.OriginalCount);
+        key[1] = static_cast<uint8_t>(N);
+        for (int i = 0; i < N; ++i)
+        {
+            key[2 + i] = Recovery[i]->Index;
+            key[2 + N + i] = ErasuresIndices[i];
+        }
+
+        CM256DecoderCacheEntry* entry = nullptr;
+        matrix = LookupDecoderCache(cache, key, 2 + 2 * N, requiredSpace, &entry);
+        if (matrix)
+        {
+            generate = false;
+        }
+        else
+        {
+            matrix = entry->Matrix;
+        }
+    }
+    else if (requiredSpace > StackMatrixBytes && requiredSpace <= ScratchMatrixBytes)
+    {
+        matrix = ScratchMatrix;
+    }
+    else if (requiredSpace > StackMatrixBytes)
+    {
+        if (DynamicMatrixBytes < requiredSpace)
+        {
+            delete[] DynamicMatrix;
+            DynamicMatrix = new uint8_t[requiredSpace];
+            DynamicMatrixBytes = requiredSpace;
+        }
+        matrix = DynamicMatrix;
+        CM256_HEAP_MATRIX(requiredSpace);
+    }
+    else
+    {
+        matrix = StackMatrix;
+    }
+
+    if (generate)
+    {
+        uint8_t* matrix_U = matrix;
+        uint8_t* diag_D = matrix_U + (N - 1) * N / 2;
+        uint8_t* matrix_L = diag_D + N;
+        GenerateLDUDecomposition(matrix_L, diag_D, matrix_U);
+    }
+
+    // Only RepeatInitialize() keeps the rows between calls, and cache entries
+    // may be replaced by other decoders sharing the cache
+    Matrix = matrix;
+    MatrixCurrent = PatternValid && !cache;
+}
+
+void CM256Decoder::EliminateOriginals(int recoveryIndex, int offset, int bytes)
+{
+    CM256_PHASE_SCOPE(CM256_PHASE_ELIMINATE, bytes);
+
+    // Start the x_0 values arbitrarily from the original count.
+    const uint8_t x_0 = static_cast<uint8_t>(Params.OriginalCount);
+
+    uint8_t* outBlock = static_cast<uint8_t*>(Recovery[recoveryIndex]->Block) + offset;
+    const uint8_t x_i = Recovery[recoveryIndex]->Index;
+
+    // The first recovery row is all ones, so it is just a parity
+    if (x_i == x_0)
+    {
+        for (int originalIndex = 0; originalIndex < OriginalCount; ++originalIndex)
+        {
+            gf256_add_mem(outBlock, static_cast<const uint8_t*>(Original[originalIndex]->Block) + offset, bytes);
+        }
+        return;
+    }
+
+    uint8_t matrixElements[256];
+    const void* inBlocks[256];
+
+    for (int originalIndex = 0; originalIndex < OriginalCount; ++originalIndex)
+    {
+        const uint8_t y_j = Original[originalIndex]->Index;
+        matrixElements[originalIndex] = GetMatrixElement(x_i, x_0, y_j);
+        inBlocks[originalIndex] = static_cast<const uint8_t*>(Original[originalIndex]->Block) + offset;
+    }
+
+    // Add all of the original data into the recovery block in one pass
+    gf256_muladd_multi_mem(outBlock, matrixElements, inBlocks, OriginalCount, bytes);
+}
+
+/*
+    Double Erasure Decoding
+
+    When the parity row is one of two received recovery rows, the original
+    data is eliminated from both rows in one pass, leaving for erased rows a, b:
+
+        P = o_a + o_b
+        Q = c_a * o_a + c_b * o_b
+
+    Then o_b = (Q + c_a * P) / (c_a + c_b) and o_a = P + o_b, which replaces
+    the general solve with three bulk passes and no matrix decomposition.
+*/
+void CM256Decoder::DecodeM2Range(int offset, int bytes)
+{
+    // Start the x_0 values arbitrarily from the original count.
+    const uint8_t x_0 = static_cast<uint8_t>(Params.OriginalCount);
+
+    // Erased row ErasuresIndices[i] is written to Recovery[i] as FinishDecode() expects
+    const int p = (Recovery[0]->Index == x_0) ? 0 : 1;
+    const int q = 1 - p;
+    uint8_t* blockP = static_cast<uint8_t*>(Recovery[p]->Block) + offset;
+    uint8_t* blockQ = static_cast<uint8_t*>(Recovery[q]->Block) + offset;
+    const uint8_t x_q = Recovery[q]->Index;
+
+    if (OriginalCount > 0)
+    {
+        CM256_PHASE_SCOPE(CM256_PHASE_ELIMINATE, static_cast<uint64_t>(bytes) * 2);
+
+        uint8_t matrixElements[256];
+        const void* inBlocks[256];
+
+        for (int originalIndex = 0; originalIndex < OriginalCount; ++originalIndex)
+        {
+            const uint8_t y_j = Original[originalIndex]->Index;
+            matrixElements[originalIndex] = GetMatrixElement(x_q, x_0, y_j);
+            inBlocks[originalIndex] = static_cast<const uint8_t*>(Original[originalIndex]->Block) + offset;
+        }
+
+        gf256_muladd_pq_multi_mem(blockP, blockQ, matrixElements, inBlocks, OriginalCount, bytes);
+    }
+
+    const uint8_t c_p = GetMatrixElement(x_q, x_0, ErasuresIndices[p]);
+    const uint8_t c_q = GetMatrixElement(x_q, x_0, ErasuresIndices[q]);
+
+    // Cauchy elements of one row are distinct, so c_p + c_q is never zero
+    {
+        CM256_PHASE_SCOPE(CM256_PHASE_LOWER_SOLVE, bytes);
+        gf256_muladd_mem(blockQ, c_p, blockP, bytes);
+    }
+    {
+        CM256_PHASE_SCOPE(CM256_PHASE_DIAGONAL, bytes);
+        gf256_div_mem_inplace(blockQ, gf256_add(c_p, c_q), bytes);
+    }
+    {
+        CM256_PHASE_SCOPE(CM256_PHASE_UPPER_SOLVE, bytes);
+        gf256_add_mem(blockP, blockQ, bytes);
+    }
+}
+
+void CM256Decoder::DecodeRange(int offset, int bytes)
+{
+    if (IsParityPair())
+    {
+        DecodeM2Range(offset, bytes);
+        return;
+    }
+
+    // Eliminate original data from the the recovery rows
+    if (OriginalCount > 0)
+    {
+        for (int recoveryIndex = 0; recoveryIndex < RecoveryCount; ++recoveryIndex)
+        {
+            EliminateOriginals(recoveryIndex, offset, bytes);
+        }
+    }
+
+    SolveRange(offset, bytes);
+}
+
+/*
+    Tiled Decoding
+
+    Decoding m>1 writes each recovered block several times: once to eliminate
+    the received originals and again for each step of the solve.  For blocks
+    larger than the cache every one of those passes goes to memory, so the
+    range is walked in strips sized like the encoder strips, and every pass
+    over one strip of the recovery rows is finished while it is still in cache.
+*/
+
+void CM256Decoder::DecodeStrips(int rangeOffset, int rangeBytes)
+{
+    int tileBytes = kEncodeTileCacheBytes / Params.OriginalCount;
+    tileBytes -= tileBytes % kEncodeTileAlignBytes;
+
+    if (tileBytes < kEncodeTileMinBytes)
+    {
+        tileBytes = kEncodeTileMinBytes;
+    }
+
+    const int rangeEnd = rangeOffset + rangeBytes;
+
+    // For each strip of the blocks,
+    for (int offset = rangeOffset; offset < rangeEnd; offset += tileBytes)
+    {
+        int bytes = rangeEnd - offset;
+        if (bytes > tileBytes)
+        {
+            bytes = tileBytes;
+        }
+
+        DecodeRange(offset, bytes);
+    }
+}
+
+void CM256Decoder::SolveRange(int offset, int bytes)
+{
+    // Matrix size is NxN, where N is the number of recovery blocks used.
+    const int N = RecoveryCount;
+
+    const uint8_t* matrix_U = Matrix;
+    const uint8_t* diag_D = matrix_U + (N - 1) * N / 2;
+    const uint8_t* matrix_L = diag_D + N;
+
+    /*
+        Eliminate lower left triangle.
+    */
+    {
+        CM256_PHASE_SCOPE(CM256_PHASE_LOWER_SOLVE, static_cast<uint64_t>(N - 1) * N / 2 * bytes);
+
+        // For each column,
+        for (int j = 0; j < N - 1; ++j)
+        {
+            const uint8_t* block_j = static_cast<const uint8_t*>(Recovery[j]->Block) + offset;
+
+            // For each row,
+            for (int i = j + 1; i < N; ++i)
+            {
+                uint8_t* block_i = static_cast<uint8_t*>(Recovery[i]->Block) + offset;
+                const uint8_t c_ij = *matrix_L++; // Matrix elements are stored column-first, top-down.
+
+                gf256_muladd_mem(block_i, c_ij, block_j, bytes);
+            }
+        }
+    }
+
+    /*
+        Eliminate diagonal.
+    */
+    {
+        CM256_PHASE_SCOPE(CM256_PHASE_DIAGONAL, static_cast<uint64_t>(N) * bytes);
+
+        for (int i = 0; i < N; ++i)
+        {
+            uint8_t* block = static_cast<uint8_t*>(Recovery[i]->Block) + offset;
+
+            gf256_div_mem_inplace(block, diag_D[i], bytes);
+        }
+    }
+
+    /*
+        Eliminate upper right triangle.
+    */
+    {
+        CM256_PHASE_SCOPE(CM256_PHASE_UPPER_SOLVE, static_cast<uint64_t>(N - 1) * N / 2 * bytes);
+
+        for (int j = N - 1; j >= 1; --j)
+        {
+            const uint8_t* block_j = static_cast<const uint8_t*>(Recovery[j]->Block) + offset;
+
+            for (int i = j - 1; i >= 0; --i)
+            {
+                uint8_t* block_i = static_cast<uint8_t*>(Recovery[i]->Block) + offset;
+                const uint8_t c_ij = *matrix_U++; // Matrix elements are stored column-first, bottom-up.
+
+                gf256_muladd_mem(block_i, c_ij, block_j, bytes);
+            }
+        }
+    }
+}
+
+void CM256Decoder::FinishDecode()
+{
+    for (int i = 0; i < RecoveryCount; ++i)
+    {
+        Recovery[i]->Index = ErasuresIndices[i];
+    }
+}
+
+void CM256Decoder::DecodeM1IntoRange(uint8_t* output, int offset, int bytes)
+{
+    uint8_t* outBlock = output + offset;
+    const uint8_t* recoveryBlock = static_cast<const uint8_t*>(Recovery[0]->Block) + offset;
+
+    // If there are no originals to add, it is the recovery block itself
+    if (OriginalCount <= 0)
+    {
+        memcpy(outBlock, recoveryBlock, bytes);
+        return;
+    }
+
+    // First write: outBlock = recoveryBlock ^ original[0]
+    gf256_addset_mem(outBlock, recoveryBlock, static_cast<const uint8_t*>(Original[0]->Block) + offset, bytes);
+
+    // XOR the remaining original blocks in two at a time
+    int ii = 1;
+    for (; ii + 1 < OriginalCount; ii += 2)
+    {
+        gf256_add2_mem(outBlock,
+                       static_cast<const uint8_t*>(Original[ii]->Block) + offset,
+                       static_cast<const uint8_t*>(Original[ii + 1]->Block) + offset, bytes);
+    }
+    if (ii < OriginalCount)
+    {
+        gf256_add_mem(outBlock, static_cast<const uint8_t*>(Original[ii]->Block) + offset, bytes);
+    }
+}
+
+/*
+    Decoding into separate outputs
+
+    The received blocks cannot be used as scratch space, so rather than
+    eliminating in place the solve is reorganized by rows.  Forward
+    substitution through L and the division by D are folded into the
+    original data elimination, so each erased row is produced with one
+    first-write multi-source pass:
+
+        out_i = (rec_i + sum(c_ij * orig_j) + sum(L_ij * D_j * out_j, j < i)) / D_i
+
+    Back substitution through U then adds the later rows into each output
+    with one more multi-source pass per row:
+
+        out_i += sum(U_ij * out_j, j > i)
+*/
+void CM256Decoder::DecodeIntoRange(uint8_t* const* outputs, int offset, int bytes)
+{
+    // Matrix size is NxN, where N is the number of recovery blocks used.
+    const int N = RecoveryCount;
+
+    // Start the x_0 values arbitrarily from the original count.
+    const uint8_t x_0 = static_cast<uint8_t>(Params.OriginalCount);
+
+    const uint8_t* matrix_U = Matrix;
+    const uint8_t* diag_D = matrix_U + (N - 1) * N / 2;
+    const uint8_t* matrix_L = diag_D + N;
+
+    // Offsets of the start of each column of L and U.
+    // L columns are stored top-down starting from column 0,
+    // and U columns are stored bottom-up starting from column N-1.
+    int columnL[256], columnU[256];
+    for (int j = 0, offsetL = 0; j < N; ++j)
+    {
+        columnL[j] = offsetL;
+        offsetL += N - 1 - j;
+    }
+    for (int j = N - 1, offsetU = 0; j >= 1; --j)
+    {
+        columnU[j] = offsetU;
+        offsetU += j;
+    }
+
+    uint8_t coefficients[256];
+    const void* inBlocks[256];
+
+    // Forward: Elimination, L and D
+    for (int i = 0; i < N; ++i)
+    {
+        const uint8_t x_i = Recovery[i]->Index;
+        const uint8_t inv_D = gf256_inv(diag_D[i]);
+        int count = 0;
+
+        coefficients[count] = inv_D;
+        inBlocks[count++] = static_cast<const uint8_t*>(Recovery[i]->Block) + offset;
+
+        for (int originalIndex = 0; originalIndex < OriginalCount; ++originalIndex)
+        {
+            const uint8_t y_j = Original[originalIndex]->Index;
+            coefficients[count] = gf256_mul(GetMatrixElement(x_i, x_0, y_j), inv_D);
+            inBlocks[count++] = static_cast<const uint8_t*>(Original[originalIndex]->Block) + offset;
+        }
+
+        for (int j = 0; j < i; ++j)
+        {
+            const uint8_t L_ij = matrix_L[columnL[j] + (i - j - 1)];
+
+            coefficients[count] = gf256_mul(gf256_mul(L_ij, diag_D[j]), inv_D);
+            inBlocks[count++] = outputs[j] + offset;
+        }
+
+        gf256_mul_multi_mem(outputs[i] + offset, coefficients, inBlocks, count, bytes);
+    }
+
+    // Backward: U
+    for (int i = N - 2; i >= 0; --i)
+    {
+        int count = 0;
+
+        for (int j = i + 1; j < N; ++j)
+        {
+            coefficients[count] = matrix_U[columnU[j] + (j - 1 - i)];
+            inBlocks[count++] = outputs[j] + offset;
+        }
+
+        gf256_muladd_multi_mem(outputs[i] + offset, coefficients, inBlocks, count, bytes);
+    }
+}
+
+/*
+    Inverse rows of the Cauchy system
+
+    Every element of the encoding matrix is (y_j + x_0) / (x_i + y_j), so the
+    square system for the erased columns is a Cauchy matrix C_ij = 1 / (x_i + y_j)
+    with column j scaled by (y_j + x_0).  The parity row is x_i = x_0.
+
+    The inverse of a Cauchy matrix has a closed form, so the row for one erased
+    column y_t can be produced without factoring the whole system:
+
+        (C^-1)_tj = prod_k(x_j + y_k) * prod_k(x_k + y_t) /
+                    ((x_j + y_t) * prod_k!=j(x_j + x_k) * prod_k!=t(y_t + y_k))
+
+    and the column scale turns into a division of the row by (y_t + x_0).
+*/
+void CM256Decoder::GenerateInverseRow(int erasure, uint8_t* inverseRow)
+{
+    // Matrix size is NxN, where N is the number of recovery blocks used.
+    const int N = RecoveryCount;
+
+    // Start the x_0 values arbitrarily from the original count.
+    const uint8_t x_0 = static_cast<uint8_t>(Params.OriginalCount);
+    const uint8_t y_t = ErasuresIndices[erasure];
+
+    // Terms shared by every element of the row
+    uint8_t rowTerm = gf256_add(y_t, x_0);
+    for (int k = 0; k < N; ++k)
+    {
+        if (k != erasure)
+        {
+            rowTerm = gf256_mul(rowTerm, gf256_add(y_t, ErasuresIndices[k]));
+        }
+    }
+    uint8_t rowNumerator = 1;
+    for (int k = 0; k < N; ++k)
+    {
+        rowNumerator = gf256_mul(rowNumerator, gf256_add(Recovery[k]->Index, y_t));
+    }
+    rowNumerator = gf256_div(rowNumerator, rowTerm);
+
+    for (int j = 0; j < N; ++j)
+    {
+        const uint8_t x_j = Recovery[j]->Index;
+
+        uint8_t numerator = rowNumerator;
+        uint8_t denominator = gf256_add(x_j, y_t);
+        for (int k = 0; k < N; ++k)
+        {
+            numerator = gf256_mul(numerator, gf256_add(x_j, ErasuresIndices[k]));
+            if (k != j)
+            {
+                denominator = gf256_mul(denominator, gf256_add(x_j, Recovery[k]->Index));
+            }
+        }
+
+        inverseRow[j] = gf256_div(numerator, denominator);
+    }
+}
+
+int CM256Decoder::GenerateReceivedCoefficients(const uint8_t* recoveryWeights, const uint8_t* originalWeights,
+                                               uint8_t* coefficients, const void** inBlocks)
+{
+    // Start the x_0 values arbitrarily from the original count.
+    const uint8_t x_0 = static_cast<uint8_t>(Params.OriginalCount);
+
+    int count = 0;
+    for (int j = 0; j < RecoveryCount; ++j, ++count)
+    {
+        coefficients[count] = recoveryWeights[j];
+        inBlocks[count] = Recovery[j]->Block;
+    }
+
+    // Each recovery row also carries G_js * o_s for the received originals s
+    for (int originalIndex = 0; originalIndex < OriginalCount; ++originalIndex, ++count)
+    {
+        const uint8_t y_s = Original[originalIndex]->Index;
+        uint8_t sum = originalWeights ? originalWeights[y_s] : 0;
+        for (int j = 0; j < RecoveryCount; ++j)
+        {
+            sum = gf256_add(sum, gf256_mul(recoveryWeights[j], GetMatrixElement(Recovery[j]->Index, x_0, y_s)));
+        }
+        coefficients[count] = sum;
+        inBlocks[count] = Original[originalIndex]->Block;
+    }
+
+    return count;
+}
+
+void CM256Decoder::Decode(cm256_decoder_cache* cache)
+{
+    PrepareDecodeRange(cache);
+    DecodeStrips(0, Params.BlockBytes);
+    FinishDecode();
+}
+
+struct CM256DecodeTasks
+{
+    CM256Decoder* Decoder;
+    int RangeBytes;
+};
+
+static void DecodeTask(void* context, int taskIndex)
+{
+    const CM256DecodeTasks* tasks = static_cast<const CM256DecodeTasks*>(context);
+    CM256Decoder* decoder = tasks->Decoder;
+
+    int offset, bytes;
+    GetTaskRange(taskIndex, tasks->RangeBytes, decoder->Params.BlockBytes, &offset, &bytes);
+
+    if (decoder->Params.RecoveryCount == 1)
+    {
+        decoder->DecodeM1Range(offset, bytes);
+    }
+    else
+    {
+        decoder->DecodeStrips(offset, bytes);
+    }
+}
+
+// Decode with validated params using the given decoder state, which may be reused between calls
+static int DecodeWithState(
+    CM256Decoder& state,              // Decoder state
+    cm256_encoder_params params,      // Encoder params
+    cm256_block* blocks,              // Array of 'originalCount' blocks as described above
+    cm256_decoder_cache* cache,       // Optional erasure-pattern cache
+    const cm256_threading* threading, // Optional threading options
+    bool repeatPattern)               // Keep the erasures and matrix for repeated block indices
+{
+    // If there is only one block,
+    if (params.OriginalCount == 1)
+    {
+        // It is the same block repeated
+        blocks[0].Index = 0;
+        return 0;
+    }
+
+    const bool initialized = repeatPattern ? state.RepeatInitialize(params, blocks)
+                                           : state.Initialize(params, blocks);
+    if (!initialized)
+    {
+        return -5;
+    }
+
+    // If nothing is erased,
+    if (state.RecoveryCount <= 0)
+    {
+        return 0;
+    }
+
+    if (threading)
+    {
+        // Generate the decomposition once, then split the data math by byte range
+        if (params.RecoveryCount > 1)
+        {
+            state.PrepareDecodeRange(cache);
+        }
+
+        CM256DecodeTasks tasks;
+        tasks.Decoder = &state;
+
+        const int taskCount = GetThreadRanges(threading, params.BlockBytes, &tasks.RangeBytes);
+        cm256_run_tasks(threading, DecodeTask, &tasks, taskCount);
+
+        state.FinishDecode();
+        return 0;
+    }
+
+    // If m=1,
+    if (params.RecoveryCount == 1)
+    {
+        state.DecodeM1();
+        return 0;
+    }
+
+    // Decode for m>1
+    state.Decode(cache);
+    return 0;
+}
+
+static int DecodeWithCache(
+    cm256_encoder_params params,      // Encoder params
+    cm256_block* blocks,              // Array of 'originalCount' blocks as described above
+    cm256_decoder_cache* cache,       // Optional erasure-pattern cache
+    const cm256_threading* threading, // Optional threading options
+    uint8_t* scratchMatrix,           // Optional space for the decomposition
+    int scratchMatrixBytes)           // Bytes of scratchMatrix
+{
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+    if (!blocks)
+    {
+        return -3;
+    }
+
+    CM256Decoder state;
+    state.ScratchMatrix = scratchMatrix;
+    state.ScratchMatrixBytes = scratchMatrixBytes;
+
+    return DecodeWithState(state, params, blocks, cache, threading, false);
+}
+
+extern "C" int cm256_decode(
+    cm256_encoder_params params, // Encoder params
+    cm256_block* blocks)         // Array of 'originalCount' blocks as described above
+{
+    return DecodeWithCache(params, blocks, nullptr, nullptr, nullptr, 0);
+}
+
+extern "C" int cm256_decode_mt(
+    cm256_encoder_params params,      // Encoder params
+    cm256_block* blocks,              // Array of 'originalCount' blocks as described above
+    const cm256_threading* threading) // Threading options
+{
+    const int threadingResult = ValidateThreading(threading);
+    if (threadingResult != 0)
+    {
+        return threadingResult;
+    }
+
+    return DecodeWithCache(params, blocks, nullptr, threading, nullptr, 0);
+}
+
+extern "C" int cm256_decode_cached(
+    cm256_encoder_params params, // Encoder params
+    cm256_block* blocks,         // Array of 'originalCount' blocks as described above
+    cm256_decoder_cache* cache)  // Erasure-pattern cache
+{
+    if (!cache)
+    {
+        return -3;
+    }
+
+    return DecodeWithCache(params, blocks, cache, nullptr, nullptr, 0);
+}
+
+
+//-----------------------------------------------------------------------------
+// Decoder Context
+
+/*
+    The context keeps one CM256Decoder between calls, so its index arrays and
+    any heap matrix grown for large recovery counts are allocated once, and
+    the parameters are validated once at creation.  Stripes that lost the
+    same blocks as the one before, which is the common case when a device
+    or link fails, are detected by comparing the block indices with the last
+    call, and only re-point the decoder at the new blocks: the erasure list
+    and a decomposition in decoder-owned space are kept.
+*/
+
+struct cm256_decoder_ctx_t
+{
+    // Encode parameters
+    cm256_encoder_params Params;
+
+    // Optional erasure-pattern cache, owned by the application
+    cm256_decoder_cache* Cache;
+
+    // Reused decoder state
+    CM256Decoder Decoder;
+};
+
+extern "C" int cm256_decoder_create(
+    cm256_encoder_params params, // Encoder parameters
+    cm256_decoder_cache* cache,  // Optional erasure-pattern cache
+    cm256_decoder_ctx** ctxOut)  // Output decoder context
+{
+    if (!ctxOut)
+    {
+        return -3;
+    }
+    *ctxOut = nullptr;
+
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+
+    cm256_decoder_ctx* ctx = new cm256_decoder_ctx;
+    ctx->Params = params;
+    ctx->Cache = cache;
+
+    *ctxOut = ctx;
+    return 0;
+}
+
+extern "C" void cm256_decoder_free(cm256_decoder_ctx* ctx)
+{
+    delete ctx;
+}
+
+extern "C" int cm256_decoder_decode(
+    cm256_decoder_ctx* ctx, // Decoder context
+    cm256_block* blocks)    // Array of 'originalCount' blocks as described above
+{
+    if (!ctx || !blocks)
+    {
+        return -3;
+    }
+
+    return DecodeWithState(ctx->Decoder, ctx->Params, blocks, ctx->Cache, nullptr, true);
+}
+
+
+extern "C" int cm256_decode_batch(
+    cm256_encoder_params params, // Encoder params
+    cm256_block* blocks,         // Array of stripeCount * originalCount blocks
+    int stripeCount)             // Number of stripes
+{
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+    if (!blocks)
+    {
+        return -3;
+    }
+    if (stripeCount <= 0)
+    {
+        return stripeCount == 0 ? 0 : -1;
+    }
+
+    // Every stripe must have the same erasure pattern as the first
+    for (int stripe = 1; stripe < stripeCount; ++stripe)
+    {
+        const cm256_block* stripeBlocks = blocks + stripe * params.OriginalCount;
+
+        for (int i = 0; i < params.OriginalCount; ++i)
+        {
+            if (stripeBlocks[i].Index != blocks[i].Index)
+            {
+                return -7;
+            }
+        }
+    }
+
+    // If there is only one block,
+    if (params.OriginalCount == 1)
+    {
+        // It is the same block repeated
+        for (int stripe = 0; stripe < stripeCount; ++stripe)
+        {
+            blocks[stripe].Index = 0;
+        }
+        return 0;
+    }
+
+    // Every stripe has the same block indices, so the later stripes only
+    // repoint the decoder at their blocks
+    CM256Decoder state;
+    if (!state.RepeatInitialize(params, blocks))
+    {
+        return -5;
+    }
+
+    // If nothing is erased,
+    if (state.RecoveryCount <= 0)
+    {
+        return 0;
+    }
+
+    // Generate the decomposition once for all stripes
+    if (params.RecoveryCount > 1)
+    {
+        state.PrepareDecodeRange(nullptr);
+    }
+
+    for (int stripe = 0; stripe < stripeCount; ++stripe)
+    {
+        // Point the decoder at the blocks of this stripe
+        if (stripe > 0)
+        {
+            state.RepeatInitialize(params, blocks + stripe * params.OriginalCount);
+        }
+
+        if (params.RecoveryCount == 1)
+        {
+            state.DecodeM1Range(0, params.BlockBytes);
+        }
+        else
+        {
+            state.DecodeRange(0, params.BlockBytes);
+        }
+        state.FinishDecode();
+    }
+
+    return 0;
+}
+
+
+extern "C" int cm256_decode_into(
+    cm256_encoder_params params, // Encoder params
+    const cm256_block* blocks,   // Array of 'originalCount' blocks as described above
+    void* const* outputs)        // Array of 'originalCount' output pointers, by original block index
+{
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+    if (!blocks || !outputs)
+    {
+        return -3;
+    }
+
+    // The decoder only reads the received blocks here
+    CM256Decoder state;
+    if (!state.Initialize(params, const_cast<cm256_block*>(blocks)))
+    {
+        return -5;
+    }
+
+    // Look up the output for each erased row
+    uint8_t* erasedOutputs[256];
+    for (int i = 0; i < state.RecoveryCount; ++i)
+    {
+        erasedOutputs[i] = static_cast<uint8_t*>(outputs[state.ErasuresIndices[i]]);
+        if (!erasedOutputs[i])
+        {
+            return -3;
+        }
+    }
+
+    // If nothing is erased,
+    if (state.RecoveryCount <= 0)
+    {
+        return 0;
+    }
+
+    // If there is only one block, it is the same block repeated
+    if (params.OriginalCount == 1)
+    {
+        memcpy(erasedOutputs[0], state.Recovery[0]->Block, params.BlockBytes);
+        return 0;
+    }
+
+    // If m=1,
+    if (params.RecoveryCount == 1)
+    {
+        state.DecodeM1IntoRange(erasedOutputs[0], 0, params.BlockBytes);
+        return 0;
+    }
+
+    state.PrepareDecode(nullptr);
+    state.DecodeIntoRange(erasedOutputs, 0, params.BlockBytes);
+    return 0;
+}
+
+extern "C" int cm256_decode_range(
+    cm256_encoder_params params, // Encoder params
+    cm256_block* blocks,         // Array of 'originalCount' blocks as described above
+    int offset,                  // First byte of each block to decode
+    int bytes)                   // Number of bytes of each block to decode
+{
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+    if (offset < 0 || bytes < 0 || bytes > params.BlockBytes - offset)
+    {
+        return -1;
+    }
+    if (!blocks)
+    {
+        return -3;
+    }
+
+    // If there is only one block,
+    if (params.OriginalCount == 1)
+    {
+        // It is the same block repeated
+        blocks[0].Index = 0;
+        return 0;
+    }
+
+    CM256Decoder state;
+    if (!state.Initialize(params, blocks))
+    {
+        return -5;
+    }
+
+    // If nothing is erased, or there is nothing to decode,
+    if (state.RecoveryCount <= 0 || bytes <= 0)
+    {
+        state.FinishDecode();
+        return 0;
+    }
+
+    // Every step of the solve works on each byte column independently
+    if (params.RecoveryCount == 1)
+    {
+        state.DecodeM1Range(offset, bytes);
+    }
+    else
+    {
+        state.PrepareDecodeRange(nullptr);
+        state.DecodeRange(offset, bytes);
+    }
+
+    state.FinishDecode();
+    return 0;
+}
+
+extern "C" int cm256_decode_subset(
+    cm256_encoder_params params,  // Encoder params
+    const cm256_block* blocks,    // Array of 'originalCount' blocks as described above
+    const unsigned char* wanted,  // Original block indices to recover
+    int wantedCount,              // Number of entries in 'wanted'
+    void* const* outputs)         // Output block for each entry in 'wanted'
+{
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+    if (!blocks || wantedCount < 0 || (wantedCount > 0 && (!wanted || !outputs)))
+    {
+        return -3;
+    }
+
+    // The decoder only reads the received blocks here
+    CM256Decoder state;
+    if (!state.Initialize(params, const_cast<cm256_block*>(blocks)))
+    {
+        return -5;
+    }
+
+    // Find where each original is: received original, or erased row
+    const void* received[256];
+    int erasure[256];
+    for (int i = 0; i < params.OriginalCount; ++i)
+    {
+        received[i] = nullptr;
+        erasure[i] = -1;
+    }
+    for (int i = 0; i < state.OriginalCount; ++i)
+    {
+        received[state.Original[i]->Index] = state.Original[i]->Block;
+    }
+    for (int i = 0; i < state.RecoveryCount; ++i)
+    {
+        erasure[state.ErasuresIndices[i]] = i;
+    }
+
+    for (int w = 0; w < wantedCount; ++w)
+    {
+        const int target = wanted[w];
+        if (target >= params.OriginalCount)
+        {
+            return -5;
+        }
+        if (!outputs[w])
+        {
+            return -3;
+        }
+
+        // If it was received, or there is only one block, it is a copy
+        if (received[target] || params.OriginalCount == 1)
+        {
+            memcpy(outputs[w], received[target] ? received[target] : blocks[0].Block, params.BlockBytes);
+            continue;
+        }
+
+        uint8_t inverseRow[256];
+        state.GenerateInverseRow(erasure[target], inverseRow);
+
+        // o_t = sum(inv_tj * rec_j) + sum(inv_tj * G_js * o_s) over received originals s
+        uint8_t coefficients[256];
+        const void* inBlocks[256];
+        const int count = state.GenerateReceivedCoefficients(inverseRow, nullptr, coefficients, inBlocks);
+
+        gf256_mul_multi_mem(outputs[w], coefficients, inBlocks, count, params.BlockBytes);
+    }
+
+    return 0;
+}
+
+extern "C" int cm256_repair(
+    cm256_encoder_params params,  // Encoder params
+    const cm256_block* blocks,    // Array of 'originalCount' blocks as described above
+    const unsigned char* targets, // Recovery block indices to regenerate
+    int targetCount,              // Number of entries in 'targets'
+    void* const* outputs)         // Output block for each entry in 'targets'
+{
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+    if (!blocks || targetCount < 0 || (targetCount > 0 && (!targets || !outputs)))
+    {
+        return -3;
+    }
+
+    // The decoder only reads the received blocks here
+    CM256Decoder state;
+    if (!state.Initialize(params, const_cast<cm256_block*>(blocks)))
+    {
+        return -5;
+    }
+
+    // Start the x_0 values arbitrarily from the original count.
+    const uint8_t x_0 = static_cast<uint8_t>(params.OriginalCount);
+    const int N = state.RecoveryCount;
+
+    // Rows of the inverse of the received system, one for each erased original.
+    // These are shared by every target.
+    uint8_t* inverse = nullptr;
+    if (N > 0 && params.OriginalCount > 1)
+    {
+        inverse = new uint8_t[N * N];
+        for (int i = 0; i < N; ++i)
+        {
+            state.GenerateInverseRow(i, inverse + i * N);
+        }
+    }
+
+    int result = 0;
+    for (int t = 0; t < targetCount; ++t)
+    {
+        const int x_r = targets[t];
+        if (x_r < params.OriginalCount || x_r >= params.OriginalCount + params.RecoveryCount)
+        {
+            result = -5;
+            break;
+        }
+        if (!outputs[t])
+        {
+            result = -3;
+            break;
+        }
+
+        // If only one block of input data, every block is a copy of it
+        if (params.OriginalCount == 1)
+        {
+            memcpy(outputs[t], blocks[0].Block, params.BlockBytes);
+            continue;
+        }
+
+        // If the target was received, it is a copy
+        const void* received = nullptr;
+        for (int j = 0; j < N; ++j)
+        {
+            if (state.Recovery[j]->Index == x_r)
+            {
+                received = state.Recovery[j]->Block;
+            }
+        }
+        if (received)
+        {
+            memcpy(outputs[t], received, params.BlockBytes);
+            continue;
+        }
+
+        // Encoding row r over all of the originals
+        uint8_t row[256];
+        for (int y = 0; y < params.OriginalCount; ++y)
+        {
+            row[y] = GetMatrixElement(static_cast<uint8_t>(x_r), x_0, static_cast<uint8_t>(y));
+        }
+
+        // Substitute the erased originals: o_e = sum(inv_ej * rec_j) + ...
+        uint8_t recoveryWeights[256];
+        for (int j = 0; j < N; ++j)
+        {
+            uint8_t sum = 0;
+            for (int i = 0; i < N; ++i)
+            {
+                sum = gf256_add(sum, gf256_mul(row[state.ErasuresIndices[i]], inverse[i * N + j]));
+            }
+            recoveryWeights[j] = sum;
+        }
+
+        uint8_t coefficients[256];
+        const void* inBlocks[256];
+        const int count = state.GenerateReceivedCoefficients(recoveryWeights, row, coefficients, inBlocks);
+
+        gf256_mul_multi_mem(outputs[t], coefficients, inBlocks, count, params.BlockBytes);
+    }
+
+    delete[] inverse;
+    return result;
+}
+
+
+//-----------------------------------------------------------------------------
+// Checksums
+
+/*
+    The checksums are fused with the codec at strip granularity rather than
+    inside the SIMD kernels: the blocks are processed in strips sized so every
+    block's strip fits in cache together, and each strip is checksummed right
+    after the codec has streamed through it.  CRC32C continues across pieces,
+    so the per-block checksums accumulate strip by strip in order.
+*/
+
+// Returns the strip width that keeps one strip of 'blockCount' blocks in cache
+static int GetChecksumTileBytes(int blockBytes, int blockCount)
+{
+    int tileBytes = kEncodeTileCacheBytes / blockCount;
+    tileBytes -= tileBytes % kEncodeTileAlignBytes;
+
+    if (tileBytes < kEncodeTileMinBytes)
+    {
+        tileBytes = kEncodeTileMinBytes;
+    }
+    if (tileBytes > blockBytes)
+    {
+        tileBytes = blockBytes;
+    }
+
+    return tileBytes;
+}
+
+extern "C" int cm256_encode_crc(
+    cm256_encoder_params params, // Encoder params
+    cm256_block* originals,      // Array of pointers to original blocks
+    void* recoveryBlocks,        // Output recovery blocks end-to-end
+    uint32_t* crcs)              // Output checksum of each original and recovery block
+{
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+    if (!originals || !recoveryBlocks || !crcs)
+    {
+        return -3;
+    }
+
+    const int blockCount = params.OriginalCount + params.RecoveryCount;
+    const int tileBytes = GetChecksumTileBytes(params.BlockBytes, blockCount);
+    uint8_t* recoveryData = static_cast<uint8_t*>(recoveryBlocks);
+
+    for (int i = 0; i < blockCount; ++i)
+    {
+        crcs[i] = 0;
+    }
+
+    for (int offset = 0; offset < params.BlockBytes; offset += tileBytes)
+    {
+        int bytes = params.BlockBytes - offset;
+        if (bytes > tileBytes)
+        {
+            bytes = tileBytes;
+        }
+
+        // The strip already fits in cache, so encode it as a single tile
+        EncodeStrips(params, originals, nullptr, bytes, recoveryData, offset, bytes);
+
+        for (int i = 0; i < params.OriginalCount; ++i)
+        {
+            crcs[i] = gf256_crc32c(crcs[i], static_cast<const uint8_t*>(originals[i].Block) + offset, bytes);
+        }
+        for (int i = 0; i < params.RecoveryCount; ++i)
+        {
+            uint32_t& crc = crcs[params.OriginalCount + i];
+            crc = gf256_crc32c(crc, recoveryData + (size_t)i * params.BlockBytes + offset, bytes);
+        }
+    }
+
+    return 0;
+}
+
+extern "C" int cm256_decode_crc(
+    cm256_encoder_params params, // Encoder params
+    cm256_block* blocks,         // Array of 'originalCount' blocks as described above
+    uint32_t* receivedCrcs,      // Optional output checksum of each block as received
+    uint32_t* decodedCrcs)       // Optional output checksum of each block after decoding
+{
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+    if (!blocks)
+    {
+        return -3;
+    }
+
+    CM256Decoder state;
+    bool erasures = false;
+
+    // If there is only one block, it is the same block repeated
+    if (params.OriginalCount == 1)
+    {
+        blocks[0].Index = 0;
+    }
+    else
+    {
+        if (!state.Initialize(params, blocks))
+        {
+            return -5;
+        }
+        erasures = (state.RecoveryCount > 0);
+    }
+
+    // Note which blocks decoding will replace, before FinishDecode() relabels them
+    bool replaced[256];
+    for (int i = 0; i < params.OriginalCount; ++i)
+    {
+        replaced[i] = erasures && blocks[i].Index >= params.OriginalCount;
+        if (receivedCrcs)
+        {
+            receivedCrcs[i] = 0;
+        }
+        if (decodedCrcs)
+        {
+            decodedCrcs[i] = 0;
+        }
+    }
+
+    if (erasures && params.RecoveryCount > 1)
+    {
+        state.PrepareDecodeRange(nullptr);
+    }
+
+    const int tileBytes = GetChecksumTileBytes(params.BlockBytes, params.OriginalCount);
+
+    for (int offset = 0; offset < params.BlockBytes; offset += tileBytes)
+    {
+        int bytes = params.BlockBytes - offset;
+        if (bytes > tileBytes)
+        {
+            bytes = tileBytes;
+        }
+
+        // Checksum the strip as received, which also brings it into cache
+        for (int i = 0; i < params.OriginalCount; ++i)
+        {
+            const uint8_t* data = static_cast<const uint8_t*>(blocks[i].Block) + offset;
+            const uint32_t crc = receivedCrcs ? gf256_crc32c(receivedCrcs[i], data, bytes) : 0;
+
+            if (receivedCrcs)
+            {
+                receivedCrcs[i] = crc;
+            }
+            // Blocks that decoding leaves alone checksum the same either way
+            if (decodedCrcs && !replaced[i])
+            {
+                decodedCrcs[i] = receivedCrcs ? crc : gf256_crc32c(decodedCrcs[i], data, bytes);
+            }
+        }
+
+        if (!erasures)
+        {
+            continue;
+        }
+
+        if (params.RecoveryCount == 1)
+        {
+            state.DecodeM1Range(offset, bytes);
+        }
+        else
+        {
+            state.DecodeRange(offset, bytes);
+        }
+
+        if (decodedCrcs)
+        {
+            for (int i = 0; i < params.OriginalCount; ++i)
+            {
+                if (replaced[i])
+                {
+                    decodedCrcs[i] = gf256_crc32c(decodedCrcs[i], static_cast<const uint8_t*>(blocks[i].Block) + offset, bytes);
+                }
+            }
+        }
+    }
+
+    if (erasures)
+    {
+        state.FinishDecode();
+    }
+
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// Verification
+
+// Scratch strip for cm256_verify(), which stays in L1 cache while it is compared
+static const int kVerifyStripBytes = 2048;
+
+extern "C" int cm256_verify(
+    cm256_encoder_params params,  // Encoder params
+    const cm256_block* originals, // Array of pointers to original blocks
+    const void* recoveryBlocks,   // Stored recovery blocks end-to-end
+    int* mismatchRow,             // Optional output recovery block position that differs
+    int* mismatchOffset)          // Optional output byte offset that differs
+{
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+    if (!originals || !recoveryBlocks)
+    {
+        return -3;
+    }
+
+    const uint8_t* recoveryData = static_cast<const uint8_t*>(recoveryBlocks);
+
+    // Generate the rows once rather than once per strip
+    uint8_t* matrix = nullptr;
+    if (params.OriginalCount > 1 && params.RecoveryCount > 1)
+    {
+        matrix = new uint8_t[params.RecoveryCount * params.OriginalCount];
+        for (int i = 0; i < params.RecoveryCount; ++i)
+        {
+            GenerateMatrixRow(params, params.OriginalCount + i, matrix + i * params.OriginalCount);
+        }
+    }
+
+    GF256_ALIGNED uint8_t scratch[kVerifyStripBytes];
+    int result = 0;
+
+    for (int offset = 0; offset < params.BlockBytes && result == 0; offset += kVerifyStripBytes)
+    {
+        int bytes = params.BlockBytes - offset;
+        if (bytes > kVerifyStripBytes)
+        {
+            bytes = kVerifyStripBytes;
+        }
+
+        for (int i = 0; i < params.RecoveryCount; ++i)
+        {
+            const uint8_t* matrixRow = matrix ? matrix + i * params.OriginalCount : nullptr;
+            EncodeBlockRange(params, originals, params.OriginalCount + i, matrixRow, scratch, offset, bytes);
+
+            const uint8_t* stored = recoveryData + (size_t)i * params.BlockBytes + offset;
+            if (memcmp(scratch, stored, bytes) == 0)
+            {
+                continue;
+            }
+
+            int first = 0;
+            while (scratch[first] == stored[first])
+            {
+                ++first;
+            }
+
+            if (mismatchRow)
+            {
+                *mismatchRow = i;
+            }
+            if (mismatchOffset)
+            {
+                *mismatchOffset = offset + first;
+            }
+            result = 1;
+            break;
+        }
+    }
+
+    delete[] matrix;
+    return result;
+}
+
+
+//-----------------------------------------------------------------------------
+// Scatter-Gather Blocks
+
+/*
+    Scatter-gather blocks are processed in runs of bytes that are contiguous
+    in every block involved.  A cursor walks the segments of each block, and
+    each run is the shortest remaining piece of any current segment, so the
+    bulk kernels are called directly on the caller's segments.  When blocks
+    share segment boundaries, which is the common case, there is one run
+    per segment.
+*/
+
+// Position within the segments of one scatter-gather block
+struct CM256SegmentCursor
+{
+    const cm256_segment* Segment;
+    int SegmentsLeft;
+    int Used;
+
+    // Returns false if the segment lengths do not add up to blockBytes
+    bool Initialize(const cm256_sg_block& block, int blockBytes)
+    {
+        if (!block.Segments && block.SegmentCount > 0)
+        {
+            return false;
+        }
+
+        int total = 0;
+        for (int i = 0; i < block.SegmentCount; ++i)
+        {
+            if (block.Segments[i].Bytes < 0 || (!block.Segments[i].Data && block.Segments[i].Bytes > 0))
+            {
+                return false;
+            }
+            total += block.Segments[i].Bytes;
+        }
+
+        Segment = block.Segments;
+        SegmentsLeft = block.SegmentCount;
+        Used = 0;
+        SkipEmpty();
+        return total == blockBytes;
+    }
+
+    void SkipEmpty()
+    {
+        while (SegmentsLeft > 0 && Used >= Segment->Bytes)
+        {
+            ++Segment;
+            --SegmentsLeft;
+            Used = 0;
+        }
+    }
+
+    uint8_t* Data() const
+    {
+        return static_cast<uint8_t*>(Segment->Data) + Used;
+    }
+
+    int Remaining() const
+    {
+        return Segment->Bytes - Used;
+    }
+
+    void Advance(int bytes)
+    {
+        Used += bytes;
+        SkipEmpty();
+    }
+};
+
+// Returns the length of the next run that is contiguous in all of the cursors
+static int GetSegmentRunBytes(const CM256SegmentCursor* cursors, int count, int bytesLeft)
+{
+    int runBytes = bytesLeft;
+    for (int i = 0; i < count; ++i)
+    {
+        const int remaining = cursors[i].Remaining();
+        if (runBytes > remaining)
+        {
+            runBytes = remaining;
+        }
+    }
+    return runBytes;
+}
+
+extern "C" int cm256_encode_sg(
+    cm256_encoder_params params,       // Encoder params
+    const cm256_sg_block* originals,   // Array of 'originalCount' original blocks
+    const cm256_sg_block* recovery)    // Array of 'recoveryCount' output recovery blocks
+{
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+    if (!originals || !recovery)
+    {
+        return -3;
+    }
+
+    const int K = params.OriginalCount;
+    const int M = params.RecoveryCount;
+
+    // Cursors for the originals followed by the recovery blocks
+    CM256SegmentCursor cursors[512];
+    for (int i = 0; i < K; ++i)
+    {
+        if (!cursors[i].Initialize(originals[i], params.BlockBytes))
+        {
+            return -8;
+        }
+    }
+    for (int i = 0; i < M; ++i)
+    {
+        if (!cursors[K + i].Initialize(recovery[i], params.BlockBytes))
+        {
+            return -8;
+        }
+    }
+
+    uint8_t* matrix = new uint8_t[M * K];
+
+    uint8_t* matrixRow = matrix;
+    for (int block = 0; block < M; ++block, matrixRow += K)
+    {
+        GenerateMatrixRow(params, K + block, matrixRow);
+    }
+
+    const int tileBytes = GetEncodeTileBytes(params);
+    cm256_block runOriginals[256];
+
+    for (int bytesLeft = params.BlockBytes; bytesLeft > 0;)
+    {
+        const int runBytes = GetSegmentRunBytes(cursors, K + M, bytesLeft);
+
+        for (int i = 0; i < K; ++i)
+        {
+            runOriginals[i].Block = cursors[i].Data();
+        }
+
+        // Encode the run in strips as cm256_encode() does
+        for (int offset = 0; offset < runBytes; offset += tileBytes)
+        {
+            int bytes = runBytes - offset;
+            if (bytes > tileBytes)
+            {
+                bytes = tileBytes;
+            }
+
+            matrixRow = matrix;
+            for (int block = 0; block < M; ++block, matrixRow += K)
+            {
+                EncodeBlockRange(params, runOriginals, K + block, matrixRow, cursors[K + block].Data() + offset, offset, bytes);
+            }
+        }
+
+        for (int i = 0; i < K + M; ++i)
+        {
+            cursors[i].Advance(runBytes);
+        }
+        bytesLeft -= runBytes;
+    }
+
+    delete[] matrix;
+    return 0;
+}
+
+extern "C" int cm256_decode_sg(
+    cm256_encoder_params params, // Encoder params
+    cm256_sg_block* blocks)      // Array of 'originalCount' blocks as described above
+{
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+    if (!blocks)
+    {
+        return -3;
+    }
+
+    const int K = params.OriginalCount;
+
+    CM256SegmentCursor cursors[256];
+    cm256_block runBlocks[256];
+    for (int i = 0; i < K; ++i)
+    {
+        if (!cursors[i].Initialize(blocks[i], params.BlockBytes))
+        {
+            return -8;
+        }
+        runBlocks[i].Block = nullptr;
+        runBlocks[i].Index = blocks[i].Index;
+    }
+
+    // If there is only one block,
+    if (K == 1)
+    {
+        // It is the same block repeated
+        blocks[0].Index = 0;
+        return 0;
+    }
+
+    // The decoder refers to runBlocks, which are pointed at each run in turn
+    CM256Decoder state;
+    if (!state.Initialize(params, runBlocks))
+    {
+        return -5;
+    }
+
+    // If nothing is erased,
+    if (state.RecoveryCount <= 0)
+    {
+        return 0;
+    }
+
+    if (params.RecoveryCount > 1)
+    {
+        state.PrepareDecodeRange(nullptr);
+    }
+
+    for (int bytesLeft = params.BlockBytes; bytesLeft > 0;)
+    {
+        const int runBytes = GetSegmentRunBytes(cursors, K, bytesLeft);
+
+        for (int i = 0; i < K; ++i)
+        {
+            runBlocks[i].Block = cursors[i].Data();
+        }
+
+        if (params.RecoveryCount == 1)
+        {
+            state.DecodeM1Range(0, runBytes);
+        }
+        else
+        {
+            state.DecodeRange(0, runBytes);
+        }
+
+        for (int i = 0; i < K; ++i)
+        {
+            cursors[i].Advance(runBytes);
+        }
+        bytesLeft -= runBytes;
+    }
+
+    state.FinishDecode();
+
+    for (int i = 0; i < K; ++i)
+    {
+        blocks[i].Index = runBlocks[i].Index;
+    }
+
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// Streaming Decoder
+
+/*
+    The streaming decoder does the original data elimination while blocks are
+    still arriving.  Each original that arrives is added into the recovery rows
+    already held, and each recovery row that arrives has the originals already
+    held added into it.  When the last block arrives only the LDU solve is left.
+*/
+
+struct cm256_stream_decoder_t
+{
+    // Decoder state for the blocks received so far
+    CM256Decoder Decoder;
+
+    // Nonzero for each recovery row already received
+    uint8_t RecoveryReceived[256];
+
+    // Set once the stripe is finalized
+    bool Finalized;
+};
+
+extern "C" int cm256_stream_decoder_create(
+    cm256_encoder_params params,        // Encoder parameters
+    cm256_stream_decoder** decoderOut)  // Output streaming decoder
+{
+    if (!decoderOut)
+    {
+        return -3;
+    }
+    *decoderOut = nullptr;
+
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+
+    cm256_stream_decoder* decoder = new cm256_stream_decoder;
+    decoder->Decoder.Params = params;
+    cm256_stream_decoder_init(decoder);
+
+    *decoderOut = decoder;
+    return 0;
+}
+
+extern "C" void cm256_stream_decoder_free(cm256_stream_decoder* decoder)
+{
+    delete decoder;
+}
 
-    // Generators
-    uint8_t g[256], b[256];
-    for (int i = 0; i < N; ++i)
+extern "C" int cm256_stream_decoder_init(cm256_stream_decoder* decoder)
+{
+    if (!decoder)
     {
-        g[i] = 1;
-        b[i] = 1;
+        return -3;
     }
 
-    // Temporary buffer for rotated row of U matrix
-    // This allows for faster GF bulk multiplication
-    uint8_t rotated_row_U[256];
-    uint8_t* last_U = matrix_U + ((N - 1) * N) / 2 - 1;
-    int firstOffset_U = 0;
+    CM256Decoder& state = decoder->Decoder;
+    state.OriginalCount = 0;
+    state.RecoveryCount = 0;
+
+    // Initialize erasures to zeros
+    memset(state.ErasuresIndices, 0, sizeof(state.ErasuresIndices));
+    memset(decoder->RecoveryReceived, 0, sizeof(decoder->RecoveryReceived));
+    decoder->Finalized = false;
+    return 0;
+}
+
+extern "C" int cm256_stream_decoder_add_block(
+    cm256_stream_decoder* decoder, // Streaming decoder
+    cm256_block* block)            // Received block
+{
+    if (!decoder || !block || !block->Block)
+    {
+        return -3;
+    }
+
+    CM256Decoder& state = decoder->Decoder;
+    const cm256_encoder_params& params = state.Params;
+
+    // Enough blocks were already received to decode
+    if (decoder->Finalized || state.OriginalCount + state.RecoveryCount >= params.OriginalCount)
+    {
+        return -6;
+    }
 
     // Start the x_0 values arbitrarily from the original count.
-    const uint8_t x_0 = static_cast<uint8_t>(Params.OriginalCount);
+    const uint8_t x_0 = static_cast<uint8_t>(params.OriginalCount);
+    const int row = block->Index;
 
-    // Unrolling k = 0 just makes it slower for some reason.
-    for (int k = 0; k < N - 1; ++k)
+    // If it is an original block,
+    if (row < params.OriginalCount)
     {
-        const uint8_t x_k = Recovery[k]->Index;
-        const uint8_t y_k = ErasuresIndices[k];
+        if (state.ErasuresIndices[row] != 0)
+        {
+            // Error out if two row indices repeat
+            return -5;
+        }
+        state.ErasuresIndices[row] = 1;
 
-        // D_kk = (x_k + y_k)
-        // L_kk = g[k] / (x_k + y_k)
-        // U_kk = b[k] * (x_0 + y_k) / (x_k + y_k)
-        const uint8_t D_kk = gf256_add(x_k, y_k);
-        const uint8_t L_kk = gf256_div(g[k], D_kk);
-        const uint8_t U_kk = gf256_mul(gf256_div(b[k], D_kk), gf256_add(x_0, y_k));
+        // Add it into the recovery rows already held
+        if (params.OriginalCount > 1)
+        {
+            const uint8_t y_j = static_cast<uint8_t>(row);
 
-        // diag_D[k] = D_kk * L_kk * U_kk
-        diag_D[k] = gf256_mul(D_kk, gf256_mul(L_kk, U_kk));
+            for (int recoveryIndex = 0; recoveryIndex < state.RecoveryCount; ++recoveryIndex)
+            {
+                void* outBlock = state.Recovery[recoveryIndex]->Block;
+                const uint8_t x_i = state.Recovery[recoveryIndex]->Index;
 
-        // Computing the k-th row of L and U
-        uint8_t* row_L = matrix_L;
-        uint8_t* row_U = rotated_row_U;
-        for (int j = k + 1; j < N; ++j)
+                if (x_i == x_0)
+                {
+                    gf256_add_mem(outBlock, block->Block, params.BlockBytes);
+                }
+                else
+                {
+                    gf256_muladd_mem(outBlock, GetMatrixElement(x_i, x_0, y_j), block->Block, params.BlockBytes);
+                }
+            }
+        }
+
+        state.Original[state.OriginalCount++] = block;
+        return 0;
+    }
+
+    if (row >= params.OriginalCount + params.RecoveryCount || decoder->RecoveryReceived[row] != 0)
+    {
+        return -5;
+    }
+    decoder->RecoveryReceived[row] = 1;
+
+    const int recoveryIndex = state.RecoveryCount++;
+    state.Recovery[recoveryIndex] = block;
+
+    // Add the originals already held into it
+    if (params.OriginalCount > 1 && state.OriginalCount > 0)
+    {
+        state.EliminateOriginals(recoveryIndex, 0, params.BlockBytes);
+    }
+
+    return 0;
+}
+
+extern "C" int cm256_stream_decoder_finalize(cm256_stream_decoder* decoder)
+{
+    if (!decoder)
+    {
+        return -3;
+    }
+
+    CM256Decoder& state = decoder->Decoder;
+    const cm256_encoder_params& params = state.Params;
+
+    if (state.OriginalCount + state.RecoveryCount < params.OriginalCount)
+    {
+        return -6;
+    }
+
+    // The blocks were already decoded
+    if (decoder->Finalized)
+    {
+        return 0;
+    }
+    decoder->Finalized = true;
+
+    // If nothing is erased,
+    if (state.RecoveryCount <= 0)
+    {
+        return 0;
+    }
+
+    state.IdentifyErasures();
+
+    // If there is only one block it is the same block repeated, and a
+    // single recovery row is the parity so elimination already solved it.
+    if (params.OriginalCount > 1 && params.RecoveryCount > 1)
+    {
+        state.PrepareDecode(nullptr);
+        state.SolveRange(0, params.BlockBytes);
+    }
+
+    state.FinishDecode();
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// Bit-Matrix XOR Mode
+
+/*
+    Multiplying a byte by a GF(256) element c is a linear map over GF(2), so
+    it is an 8x8 bit matrix whose column k holds the bits of c * 2^k.  Each
+    block is split into 8 packets, packet k holding bit k of every symbol, and
+    the m x k Cauchy matrix becomes an 8m x 8k bit matrix saying which input
+    packets are XORed into each output packet.
+
+    Each output row is then computed either from scratch or from an earlier
+    output row that differs from it in fewer bits, picking the cheapest row
+    next in the style of Plank's "uber-CSHR" scheduling.  Rows of the same
+    matrix element, and the identity blocks of the parity row, share most of
+    their sums this way.
+*/
+
+// Number of packets in each block, one for each bit of a symbol
+static const int kXorPacketCount = 8;
+
+// Cache budget for one strip of every input and output packet
+static const int kXorTileCacheBytes = 256 * 1024;
+
+// Smallest strip worth the per-kernel overhead of another pass
+static const int kXorTileMinBytes = 256;
+
+static int CountBits64(uint64_t x)
+{
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return static_cast<int>((x * 0x0101010101010101ULL) >> 56);
+}
+
+// Number of set bits in (a ^ b), or in a if b is null
+static int CountRowBits(const uint64_t* a, const uint64_t* b, int words)
+{
+    int count = 0;
+    for (int w = 0; w < words; ++w)
+    {
+        count += CountBits64(b ? (a[w] ^ b[w]) : a[w]);
+    }
+    return count;
+}
+
+// Expand a matrix of GF(256) elements into its bit matrix.
+// Bit (kXorPacketCount * j + k) of row (kXorPacketCount * i + r) is bit r of elements[i][j] * 2^k.
+static void ExpandBitMatrix(
+    const uint8_t* elements, // rows x columns elements, row-first
+    int rows,                // Number of element rows
+    int columns,             // Number of element columns
+    uint64_t* bits,          // Output kXorPacketCount * rows rows of 'words' each
+    int words)               // 64-bit words per bit matrix row
+{
+    memset(bits, 0, kXorPacketCount * rows * words * sizeof(uint64_t));
+
+    for (int i = 0; i < rows; ++i)
+    {
+        for (int j = 0; j < columns; ++j)
         {
-            const uint8_t x_j = Recovery[j]->Index;
-            const uint8_t y_j = ErasuresIndices[j];
+            const uint8_t element = elements[i * columns + j];
 
-            // L_jk = g[j] / (x_j + y_k)
-            // U_kj = b[j] / (x_k + y_j)
-            const uint8_t L_jk = gf256_div(g[j], gf256_add(x_j, y_k));
-            const uint8_t U_kj = gf256_div(b[j], gf256_add(x_k, y_j));
+            for (int k = 0; k < kXorPacketCount; ++k)
+            {
+                const uint8_t product = gf256_mul(element, static_cast<uint8_t>(1 << k));
+                const int column = j * kXorPacketCount + k;
 
-            *matrix_L++ = L_jk;
-            *row_U++ = U_kj;
+                for (int r = 0; r < kXorPacketCount; ++r)
+                {
+                    if (product & (1 << r))
+                    {
+                        bits[(i * kXorPacketCount + r) * words + column / 64] |= 1ULL << (column % 64);
+                    }
+                }
+            }
+        }
+    }
+}
 
-            // g[j] = g[j] * (x_j + x_k) / (x_j + y_k)
-            // b[j] = b[j] * (y_j + y_k) / (y_j + x_k)
-            g[j] = gf256_mul(g[j], gf256_div(gf256_add(x_j, x_k), gf256_add(x_j, y_k)));
-            b[j] = gf256_mul(b[j], gf256_div(gf256_add(y_j, y_k), gf256_add(y_j, x_k)));
+struct CM256XorSchedule
+{
+    // For each output row in evaluation order:
+    // [output row, base output row or -1, input count, input rows...]
+    int* Program;
+    int RowCount;
+
+    CM256XorSchedule() : Program(nullptr), RowCount(0) {}
+    ~CM256XorSchedule() { delete[] Program; }
+
+    // Build the schedule for a bit matrix of 'rowCount' rows
+    void Build(const uint64_t* bits, int rowCount, int words);
+
+    // Run the schedule over the first 'bytes' of each packet
+    void Run(const uint8_t* const* inputs, uint8_t* const* outputs, int bytes) const;
+};
+
+void CM256XorSchedule::Build(const uint64_t* bits, int rowCount, int words)
+{
+    // cost[] is the number of inputs needed to compute each row right now,
+    // and base[] is the earlier row it should start from, or -1
+    int* cost = new int[3 * rowCount];
+    int* base = cost + rowCount;
+    int* order = base + rowCount;
+    bool* done = new bool[rowCount];
+
+    for (int i = 0; i < rowCount; ++i)
+    {
+        cost[i] = CountRowBits(bits + i * words, nullptr, words);
+        base[i] = -1;
+        done[i] = false;
+    }
+
+    int programSize = 0;
+    for (int step = 0; step < rowCount; ++step)
+    {
+        // Compute the cheapest remaining row next
+        int next = -1;
+        for (int i = 0; i < rowCount; ++i)
+        {
+            if (!done[i] && (next < 0 || cost[i] < cost[next]))
+            {
+                next = i;
+            }
         }
 
-        // Do these row/column divisions in bulk for speed.
-        // L_jk /= L_kk
-        // U_kj /= U_kk
-        const int count = N - (k + 1);
-        gf256_div_mem(row_L, row_L, L_kk, count);
-        gf256_div_mem(rotated_row_U, rotated_row_U, U_kk, count);
+        order[step] = next;
+        done[next] = true;
+        programSize += 3 + cost[next];
 
-        // Copy U matrix row into place in memory.
-        uint8_t* output_U = last_U + firstOffset_U;
-        row_U = rotated_row_U;
-        for (int j = k + 1; j < N; ++j)
+        // Starting from the new row may now be cheaper for the others.
+        // A base row counts as one input, so it must save at least two.
+        const uint64_t* nextBits = bits + next * words;
+        for (int i = 0; i < rowCount; ++i)
         {
-            *output_U = *row_U++;
-            output_U -= j;
+            if (!done[i])
+            {
+                const int diff = CountRowBits(bits + i * words, nextBits, words);
+                if (diff + 1 < cost[i])
+                {
+                    cost[i] = diff;
+                    base[i] = next;
+                }
+            }
         }
-        firstOffset_U -= k + 2;
     }
 
-    // Multiply diagonal matrix into U
-    uint8_t* row_U = matrix_U;
-    for (int j = N - 1; j > 0; --j)
+    delete[] Program;
+    Program = new int[programSize];
+    RowCount = rowCount;
+
+    int* op = Program;
+    for (int step = 0; step < rowCount; ++step)
     {
-        const uint8_t y_j = ErasuresIndices[j];
-        const int count = j;
+        const int row = order[step];
+        const uint64_t* rowBits = bits + row * words;
+        const uint64_t* baseBits = base[row] >= 0 ? bits + base[row] * words : nullptr;
 
-        gf256_mul_mem(row_U, row_U, gf256_add(x_0, y_j), count);
-        row_U += count;
+        *op++ = row;
+        *op++ = base[row];
+        *op++ = cost[row];
+
+        for (int w = 0; w < words; ++w)
+        {
+            uint64_t word = baseBits ? (rowBits[w] ^ baseBits[w]) : rowBits[w];
+            while (word)
+            {
+                int bit = 0;
+                while (!(word & (1ULL << bit)))
+                {
+                    ++bit;
+                }
+                *op++ = w * 64 + bit;
+                word &= word - 1;
+            }
+        }
+    }
+
+    delete[] cost;
+    delete[] done;
+}
+
+void CM256XorSchedule::Run(const uint8_t* const* inputs, uint8_t* const* outputs, int bytes) const
+{
+    const int* op = Program;
+
+    for (int step = 0; step < RowCount; ++step)
+    {
+        uint8_t* outBlock = outputs[op[0]];
+        const int baseRow = op[1];
+        int count = op[2];
+        const int* in = op + 3;
+        op += 3 + count;
+
+        const uint8_t* first;
+        if (baseRow >= 0)
+        {
+            first = outputs[baseRow];
+        }
+        else if (count > 0)
+        {
+            first = inputs[*in++];
+            --count;
+        }
+        else
+        {
+            memset(outBlock, 0, bytes);
+            continue;
+        }
+
+        if (count <= 0)
+        {
+            memcpy(outBlock, first, bytes);
+            continue;
+        }
+
+        // First write: outBlock = first ^ input, then XOR the rest in two at a time
+        gf256_addset_mem(outBlock, first, inputs[*in++], bytes);
+        --count;
+
+        for (; count >= 2; count -= 2, in += 2)
+        {
+            gf256_add2_mem(outBlock, inputs[in[0]], inputs[in[1]], bytes);
+        }
+        if (count > 0)
+        {
+            gf256_add_mem(outBlock, inputs[*in], bytes);
+        }
+    }
+}
+
+// Build the schedule that multiplies blocks by a matrix of GF(256) elements with XORs only
+static void BuildXorSchedule(
+    const uint8_t* elements,     // rows x columns elements, row-first
+    int rows,                    // Number of output blocks
+    int columns,                 // Number of input blocks
+    CM256XorSchedule& schedule)  // Output schedule
+{
+    const int words = (columns * kXorPacketCount + 63) / 64;
+    uint64_t* bits = new uint64_t[rows * kXorPacketCount * words];
+    ExpandBitMatrix(elements, rows, columns, bits, words);
+
+    schedule.Build(bits, rows * kXorPacketCount, words);
+    delete[] bits;
+}
+
+// Multiply the input blocks by the matrix of a schedule with XORs only.
+// The first 'aliasedCount' inputs are also the first outputs, and are decoded
+// in place: each strip of them is copied aside before the outputs overwrite it.
+static void XorMultiply(
+    const CM256XorSchedule& schedule, // Schedule from BuildXorSchedule()
+    int rows,                         // Number of output blocks
+    int columns,                      // Number of input blocks
+    const uint8_t* const* input,      // Input blocks
+    uint8_t* const* output,           // Output blocks
+    int blockBytes,                   // Bytes per block, a multiple of kXorPacketCount
+    int aliasedCount)                 // Number of leading inputs that are outputs
+{
+    const int packetBytes = blockBytes / kXorPacketCount;
+
+    // Walk the packets in strips that keep every input and output strip in cache
+    int tileBytes = kXorTileCacheBytes / ((rows + columns) * kXorPacketCount);
+    tileBytes -= tileBytes % kEncodeTileAlignBytes;
+    if (tileBytes < kXorTileMinBytes)
+    {
+        tileBytes = kXorTileMinBytes;
+    }
+    if (tileBytes > packetBytes)
+    {
+        tileBytes = packetBytes;
+    }
+
+    uint8_t* aliasedCopy = nullptr;
+    if (aliasedCount > 0)
+    {
+        aliasedCopy = new uint8_t[aliasedCount * kXorPacketCount * tileBytes];
+    }
+
+    const uint8_t* inPackets[256 * kXorPacketCount];
+    uint8_t* outPackets[256 * kXorPacketCount];
+
+    for (int offset = 0; offset < packetBytes; offset += tileBytes)
+    {
+        int bytes = packetBytes - offset;
+        if (bytes > tileBytes)
+        {
+            bytes = tileBytes;
+        }
+
+        for (int j = 0; j < columns; ++j)
+        {
+            for (int k = 0; k < kXorPacketCount; ++k)
+            {
+                const int packet = j * kXorPacketCount + k;
+                const uint8_t* strip = input[j] + k * packetBytes + offset;
+
+                if (j < aliasedCount)
+                {
+                    uint8_t* copy = aliasedCopy + packet * tileBytes;
+                    memcpy(copy, strip, bytes);
+                    strip = copy;
+                }
+
+                inPackets[packet] = strip;
+            }
+        }
+        for (int i = 0; i < rows; ++i)
+        {
+            for (int k = 0; k < kXorPacketCount; ++k)
+            {
+                outPackets[i * kXorPacketCount + k] = output[i] + k * packetBytes + offset;
+            }
+        }
+
+        schedule.Run(inPackets, outPackets, bytes);
+    }
+
+    delete[] aliasedCopy;
+}
+
+
+/*
+    XOR Schedule Cache
+
+    Building a schedule compares every pair of bit matrix rows, which can cost
+    more than running it over small blocks, and the decoder inverts the
+    submatrix of the loss pattern before that.  The encoder schedule only
+    depends on the original and recovery counts, and a decoder schedule on the
+    original count, the recovery rows in the order they were received, and the
+    erased originals, so both are kept in a small LRU cache like the
+    erasure-pattern cache above.
+*/
+
+// Largest key: mode, OriginalCount, N, then N recovery rows and N erased rows
+static const int kXorCacheKeyMaxBytes = 3 + 2 * 256;
+
+// First key byte
+static const uint8_t kXorCacheKeyEncode = 0;
+static const uint8_t kXorCacheKeyDecode = 1;
+
+struct CM256XorCacheEntry
+{
+    // Hash of the key bytes, for a quick reject
+    uint32_t Hash;
+
+    // Matching key
+    uint8_t Key[kXorCacheKeyMaxBytes];
+    int KeyBytes;
+
+    // Schedule built for the key
+    CM256XorSchedule Schedule;
+
+    // Value of the use counter when it was last hit, for LRU eviction
+    uint64_t LastUse;
+};
+
+struct cm256_xor_cache_t
+{
+    CM256XorCacheEntry* Entries;
+    int EntryCount;
+    int MaxEntries;
+
+    // Incremented on each lookup
+    uint64_t UseCounter;
+
+    // Statistics
+    uint64_t Hits, Misses;
+};
+
+extern "C" int cm256_xor_cache_create(
+    int maxEntries,              // Maximum number of schedules to keep
+    cm256_xor_cache** cacheOut)  // Output cache
+{
+    if (!cacheOut)
+    {
+        return -3;
+    }
+    *cacheOut = nullptr;
+
+    if (maxEntries <= 0)
+    {
+        return -1;
     }
 
-    const uint8_t x_n = Recovery[N - 1]->Index;
-    const uint8_t y_n = ErasuresIndices[N - 1];
+    cm256_xor_cache* cache = new cm256_xor_cache;
+    cache->Entries = new CM256XorCacheEntry[maxEntries];
+    cache->EntryCount = 0;
+    cache->MaxEntries = maxEntries;
+    cache->UseCounter = 0;
+    cache->Hits = 0;
+    cache->Misses = 0;
 
-    // D_nn = 1 / (x_n + y_n)
-    // L_nn = g[N-1]
-    // U_nn = b[N-1] * (x_0 + y_n)
-    const uint8_t L_nn = g[N - 1];
-    const uint8_t U_nn = gf256_mul(b[N - 1], gf256_add(x_0, y_n));
+    *cacheOut = cache;
+    return 0;
+}
 
-    // diag_D[N-1] = L_nn * D_nn * U_nn
-    diag_D[N - 1] = gf256_div(gf256_mul(L_nn, U_nn), gf256_add(x_n, y_n));
+extern "C" void cm256_xor_cache_free(cm256_xor_cache* cache)
+{
+    if (cache)
+    {
+        delete[] cache->Entries;
+        delete cache;
+    }
 }
 
-void CM256Decoder::Decode()
+extern "C" void cm256_xor_cache_stats(
+    const cm256_xor_cache* cache, // Cache to query
+    uint64_t* hits,               // Output number of calls that reused a schedule
+    uint64_t* misses)             // Output number of calls that built a schedule
 {
-    // Matrix size is NxN, where N is the number of recovery blocks used.
-    const int N = RecoveryCount;
+    if (hits)
+    {
+        *hits = cache ? cache->Hits : 0;
+    }
+    if (misses)
+    {
+        *misses = cache ? cache->Misses : 0;
+    }
+}
 
-    // Start the x_0 values arbitrarily from the original count.
-    const uint8_t x_0 = static_cast<uint8_t>(Params.OriginalCount);
+// Returns the schedule for the key, which must be built first when 'hit' is false
+static CM256XorSchedule* LookupXorCache(
+    cm256_xor_cache* cache,
+    const uint8_t* key,
+    int keyBytes,
+    bool& hit)
+{
+    const uint32_t hash = HashDecoderCacheKey(key, keyBytes);
+    const uint64_t use = ++cache->UseCounter;
 
-    // Eliminate original data from the the recovery rows
-    for (int originalIndex = 0; originalIndex < OriginalCount; ++originalIndex)
+    CM256XorCacheEntry* oldest = nullptr;
+
+    for (int i = 0; i < cache->EntryCount; ++i)
     {
-        const uint8_t* inBlock = static_cast<const uint8_t*>(Original[originalIndex]->Block);
-        const uint8_t inRow = Original[originalIndex]->Index;
+        CM256XorCacheEntry* entry = cache->Entries + i;
 
-        for (int recoveryIndex = 0; recoveryIndex < N; ++recoveryIndex)
+        if (entry->Hash == hash &&
+            entry->KeyBytes == keyBytes &&
+            0 == memcmp(entry->Key, key, keyBytes))
         {
-            uint8_t* outBlock = static_cast<uint8_t*>(Recovery[recoveryIndex]->Block);
-            const uint8_t x_i = Recovery[recoveryIndex]->Index;
-            const uint8_t y_j = inRow;
-            const uint8_t matrixElement = GetMatrixElement(x_i, x_0, y_j);
+            entry->LastUse = use;
+            ++cache->Hits;
+            hit = true;
+            return &entry->Schedule;
+        }
 
-            gf256_muladd_mem(outBlock, matrixElement, inBlock, Params.BlockBytes);
+        if (!oldest || entry->LastUse < oldest->LastUse)
+        {
+            oldest = entry;
         }
     }
 
-    // Allocate matrix
-    static const int StackAllocSize = 2048;
-    uint8_t stackMatrix[StackAllocSize];
-    uint8_t* dynamicMatrix = nullptr;
-    uint8_t* matrix = stackMatrix;
-    const int requiredSpace = N * N;
-    if (requiredSpace > StackAllocSize)
+    ++cache->Misses;
+
+    // Use a free slot if there is one, otherwise evict the least recently used
+    CM256XorCacheEntry* entry = oldest;
+    if (cache->EntryCount < cache->MaxEntries)
     {
-        dynamicMatrix = new uint8_t[requiredSpace];
-        matrix = dynamicMatrix;
+        entry = cache->Entries + cache->EntryCount++;
     }
 
-    /*
-        Compute matrix decomposition:
+    entry->Hash = hash;
+    memcpy(entry->Key, key, keyBytes);
+    entry->KeyBytes = keyBytes;
+    entry->LastUse = use;
 
-            G = L * D * U
+    hit = false;
+    return &entry->Schedule;
+}
 
-        L is lower-triangular, diagonal is all ones.
-        D is a diagonal matrix.
-        U is upper-triangular, diagonal is all ones.
-    */
-    uint8_t* matrix_U = matrix;
-    uint8_t* diag_D = matrix_U + (N - 1) * N / 2;
-    uint8_t* matrix_L = diag_D + N;
-    GenerateLDUDecomposition(matrix_L, diag_D, matrix_U);
+static int ValidateXorParams(const cm256_encoder_params& params)
+{
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+    if (params.BlockBytes % kXorPacketCount != 0)
+    {
+        return -9;
+    }
+    return 0;
+}
 
-    /*
-        Eliminate lower left triangle.
-    */
-    // For each column,
-    for (int j = 0; j < N - 1; ++j)
+static int XorEncode(
+    cm256_encoder_params params, // Encoder params
+    cm256_block* originals,      // Array of pointers to original blocks
+    void* recoveryBlocks,        // Output recovery blocks end-to-end
+    cm256_xor_cache* cache)      // Optional schedule cache
+{
+    const int paramsResult = ValidateXorParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+    if (!originals || !recoveryBlocks)
     {
-        const void* block_j = Recovery[j]->Block;
+        return -3;
+    }
+
+    uint8_t* recoveryData = static_cast<uint8_t*>(recoveryBlocks);
 
-        // For each row,
-        for (int i = j + 1; i < N; ++i)
+    // If only one block of input data, all recovery blocks are copies of it
+    if (params.OriginalCount == 1)
+    {
+        for (int i = 0; i < params.RecoveryCount; ++i)
         {
-            void* block_i = Recovery[i]->Block;
-            const uint8_t c_ij = *matrix_L++; // Matrix elements are stored column-first, top-down.
+            memcpy(recoveryData + i * params.BlockBytes, originals[0].Block, params.BlockBytes);
+        }
+        return 0;
+    }
+
+    CM256XorSchedule localSchedule;
+    CM256XorSchedule* schedule = &localSchedule;
+    bool hit = false;
+    if (cache)
+    {
+        const uint8_t key[3] = {
+            kXorCacheKeyEncode,
+            static_cast<uint8_t>(params.OriginalCount),
+            static_cast<uint8_t>(params.RecoveryCount)
+        };
+        schedule = LookupXorCache(cache, key, 3, hit);
+    }
 
-            gf256_muladd_mem(block_i, c_ij, block_j, Params.BlockBytes);
+    if (!hit)
+    {
+        uint8_t* matrix = new uint8_t[params.RecoveryCount * params.OriginalCount];
+        for (int i = 0; i < params.RecoveryCount; ++i)
+        {
+            GenerateMatrixRow(params, params.OriginalCount + i, matrix + i * params.OriginalCount);
         }
+        BuildXorSchedule(matrix, params.RecoveryCount, params.OriginalCount, *schedule);
+        delete[] matrix;
     }
 
-    /*
-        Eliminate diagonal.
-    */
-    for (int i = 0; i < N; ++i)
+    const uint8_t* input[256];
+    uint8_t* output[256];
+    for (int j = 0; j < params.OriginalCount; ++j)
+    {
+        input[j] = static_cast<const uint8_t*>(originals[j].Block);
+    }
+    for (int i = 0; i < params.RecoveryCount; ++i)
     {
-        void* block = Recovery[i]->Block;
+        output[i] = recoveryData + i * params.BlockBytes;
+    }
 
-        Recovery[i]->Index = ErasuresIndices[i];
+    XorMultiply(*schedule, params.RecoveryCount, params.OriginalCount, input, output, params.BlockBytes, 0);
+    return 0;
+}
 
-        gf256_div_mem(block, block, diag_D[i], Params.BlockBytes);
+extern "C" int cm256_xor_encode(
+    cm256_encoder_params params, // Encoder params
+    cm256_block* originals,      // Array of pointers to original blocks
+    void* recoveryBlocks)        // Output recovery blocks end-to-end
+{
+    return XorEncode(params, originals, recoveryBlocks, nullptr);
+}
+
+extern "C" int cm256_xor_encode_cached(
+    cm256_encoder_params params, // Encoder params
+    cm256_block* originals,      // Array of pointers to original blocks
+    void* recoveryBlocks,        // Output recovery blocks end-to-end
+    cm256_xor_cache* cache)      // Schedule cache
+{
+    if (!cache)
+    {
+        return -3;
     }
 
-    /*
-        Eliminate upper right triangle.
-    */
-    for (int j = N - 1; j >= 1; --j)
+    return XorEncode(params, originals, recoveryBlocks, cache);
+}
+
+// Invert an NxN submatrix of the encoding matrix in place by Gauss-Jordan elimination.
+// Every square submatrix of a Cauchy matrix is invertible, so no pivoting is needed.
+static void InvertMatrix(uint8_t* matrix, int N)
+{
+    uint8_t* inverse = new uint8_t[N * N];
+    memset(inverse, 0, N * N);
+    for (int i = 0; i < N; ++i)
     {
-        const void* block_j = Recovery[j]->Block;
+        inverse[i * N + i] = 1;
+    }
 
-        for (int i = j - 1; i >= 0; --i)
-        {
-            void* block_i = Recovery[i]->Block;
-            const uint8_t c_ij = *matrix_U++; // Matrix elements are stored column-first, bottom-up.
+    for (int k = 0; k < N; ++k)
+    {
+        const uint8_t scale = gf256_inv(matrix[k * N + k]);
+        gf256_mul_mem_inplace(matrix + k * N, scale, N);
+        gf256_mul_mem_inplace(inverse + k * N, scale, N);
 
-            gf256_muladd_mem(block_i, c_ij, block_j, Params.BlockBytes);
+        for (int i = 0; i < N; ++i)
+        {
+            const uint8_t factor = matrix[i * N + k];
+            if (i != k && factor != 0)
+            {
+                gf256_muladd_mem(matrix + i * N, factor, matrix + k * N, N);
+                gf256_muladd_mem(inverse + i * N, factor, inverse + k * N, N);
+            }
         }
     }
 
-    delete[] dynamicMatrix;
+    memcpy(matrix, inverse, N * N);
+    delete[] inverse;
 }
 
-extern "C" int cm256_decode(
+static int XorDecode(
     cm256_encoder_params params, // Encoder params
-    cm256_block* blocks)         // Array of 'originalCount' blocks as described above
+    cm256_block* blocks,         // Array of 'originalCount' blocks as described above
+    cm256_xor_cache* cache)      // Optional schedule cache
 {
-    if (params.OriginalCount <= 0 ||
-        params.RecoveryCount <= 0 ||
-        params.BlockBytes <= 0)
-    {
-        return -1;
-    }
-    if (params.OriginalCount + params.RecoveryCount > 256)
+    const int paramsResult = ValidateXorParams(params);
+    if (paramsResult != 0)
     {
-        return -2;
+        return paramsResult;
     }
     if (!blocks)
     {
@@ -585,19 +4315,322 @@ extern "C" int cm256_decode(
     }
 
     // If nothing is erased,
-    if (state.RecoveryCount <= 0)
+    const int N = state.RecoveryCount;
+    if (N <= 0)
     {
         return 0;
     }
 
-    // If m=1,
-    if (params.RecoveryCount == 1)
+    // Inputs are the recovery blocks followed by the received originals in
+    // index order, so the schedule only depends on the loss pattern
+    const int columns = params.OriginalCount;
+    const uint8_t* input[256];
+    uint8_t* output[256];
+    const void* received[256] = {};
+    uint8_t originalIndices[256];
+
+    for (int i = 0; i < N; ++i)
     {
-        state.DecodeM1();
-        return 0;
+        input[i] = static_cast<const uint8_t*>(state.Recovery[i]->Block);
+        output[i] = static_cast<uint8_t*>(state.Recovery[i]->Block);
+    }
+    for (int j = 0; j < state.OriginalCount; ++j)
+    {
+        received[state.Original[j]->Index] = state.Original[j]->Block;
+    }
+    for (int y = 0, j = 0; y < columns; ++y)
+    {
+        if (received[y])
+        {
+            input[N + j] = static_cast<const uint8_t*>(received[y]);
+            originalIndices[j++] = static_cast<uint8_t>(y);
+        }
     }
 
-    // Decode for m>1
-    state.Decode();
+    CM256XorSchedule localSchedule;
+    CM256XorSchedule* schedule = &localSchedule;
+    bool hit = false;
+    if (cache)
+    {
+        uint8_t key[kXorCacheKeyMaxBytes];
+        key[0] = kXorCacheKeyDecode;
+        key[1] = static_cast<uint8_t>(params.OriginalCount);
+        key[2] = static_cast<uint8_t>(N);
+        for (int i = 0; i < N; ++i)
+        {
+            key[3 + i] = state.Recovery[i]->Index;
+            key[3 + N + i] = state.ErasuresIndices[i];
+        }
+        schedule = LookupXorCache(cache, key, 3 + 2 * N, hit);
+    }
+
+    if (!hit)
+    {
+        // Start the x_0 values arbitrarily from the original count.
+        const uint8_t x_0 = static_cast<uint8_t>(params.OriginalCount);
+
+        // The received recovery rows are G_E * o_E + G_S * o_S for erased originals E
+        // and received originals S, so o_E = G_E^-1 * rec + G_E^-1 * G_S * o_S.
+        uint8_t* inverse = new uint8_t[N * N];
+        for (int i = 0; i < N; ++i)
+        {
+            for (int k = 0; k < N; ++k)
+            {
+                inverse[i * N + k] = GetMatrixElement(state.Recovery[i]->Index, x_0, state.ErasuresIndices[k]);
+            }
+        }
+        InvertMatrix(inverse, N);
+
+        uint8_t* matrix = new uint8_t[N * columns];
+        for (int k = 0; k < N; ++k)
+        {
+            const uint8_t* inverseRow = inverse + k * N;
+            uint8_t* row = matrix + k * columns;
+
+            memcpy(row, inverseRow, N);
+
+            for (int j = 0; j < state.OriginalCount; ++j)
+            {
+                const uint8_t y_j = originalIndices[j];
+                uint8_t sum = 0;
+                for (int i = 0; i < N; ++i)
+                {
+                    sum ^= gf256_mul(inverseRow[i], GetMatrixElement(state.Recovery[i]->Index, x_0, y_j));
+                }
+                row[N + j] = sum;
+            }
+        }
+        delete[] inverse;
+
+        BuildXorSchedule(matrix, N, columns, *schedule);
+        delete[] matrix;
+    }
+
+    // Each recovered original overwrites the recovery block it came from
+    XorMultiply(*schedule, N, columns, input, output, params.BlockBytes, N);
+
+    state.FinishDecode();
+    return 0;
+}
+
+extern "C" int cm256_xor_decode(
+    cm256_encoder_params params, // Encoder params
+    cm256_block* blocks)         // Array of 'originalCount' blocks as described above
+{
+    return XorDecode(params, blocks, nullptr);
+}
+
+extern "C" int cm256_xor_decode_cached(
+    cm256_encoder_params params, // Encoder params
+    cm256_block* blocks,         // Array of 'originalCount' blocks as described above
+    cm256_xor_cache* cache)      // Schedule cache
+{
+    if (!cache)
+    {
+        return -3;
+    }
+
+    return XorDecode(params, blocks, cache);
+}
+
+
+//-----------------------------------------------------------------------------
+// Stripe Arena
+
+/*
+    All of the stripes of an arena are carved out of one allocation made up
+    front, so acquiring and releasing a stripe never touches the heap.  Each
+    original block and the recovery data start on a cache line boundary, and
+    each stripe also holds the decoder's matrix scratch when the largest
+    possible decomposition does not fit in the decoder's stack matrix.
+
+    Free stripes are kept on a lock-free stack of stripe indices.  The head
+    word holds the index of the top stripe in its low 32 bits and a count of
+    changes in its high 32 bits, so a thread that read a stale head always
+    fails its compare-exchange even if the same stripe is back on top.
+*/
+
+// Block data and matrix scratch start on cache line boundaries, which are also GF256_ALIGN_BYTES aligned
+static const int kArenaAlignBytes = 64;
+
+// Marks the end of the free list
+static const uint32_t kArenaListEnd = 0xffffffff;
+
+// Added to the head word on every change of the free list
+static const uint64_t kArenaListTag = (uint64_t)1 << 32;
+
+struct cm256_arena_t
+{
+    cm256_encoder_params Params;
+    int StripeCount;
+    int MatrixBytes;
+
+    // Allocation holding the data of every stripe
+    uint8_t* Allocation;
+    size_t StripeBytes;
+    size_t MatrixOffset;
+
+    cm256_stripe* Stripes;
+    std::atomic<uint32_t>* NextFree;
+    std::atomic<uint64_t> FreeHead;
+};
+
+static size_t RoundUpToArenaAlign(size_t bytes)
+{
+    return (bytes + kArenaAlignBytes - 1) & ~(size_t)(kArenaAlignBytes - 1);
+}
+
+extern "C" int cm256_arena_create(
+    cm256_encoder_params params, // Encoder parameters
+    int stripeCount,             // Number of stripes to preallocate
+    cm256_arena** arenaOut)      // Output arena
+{
+    if (!arenaOut)
+    {
+        return -3;
+    }
+    *arenaOut = nullptr;
+
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+    if (stripeCount <= 0)
+    {
+        return -1;
+    }
+
+    // The most erasures that can be decoded sets the size of the decomposition
+    const int maxErasures = params.RecoveryCount < params.OriginalCount ? params.RecoveryCount : params.OriginalCount;
+    const int matrixBytes = maxErasures * maxErasures;
+
+    const size_t stride = RoundUpToArenaAlign(params.BlockBytes);
+    const size_t recoveryOffset = stride * params.OriginalCount;
+    const size_t matrixOffset = recoveryOffset + RoundUpToArenaAlign((size_t)params.RecoveryCount * params.BlockBytes);
+
+    cm256_arena* arena = new cm256_arena;
+    arena->Params = params;
+    arena->StripeCount = stripeCount;
+    arena->MatrixBytes = (matrixBytes > CM256Decoder::StackMatrixBytes) ? matrixBytes : 0;
+    arena->MatrixOffset = matrixOffset;
+    arena->StripeBytes = matrixOffset + RoundUpToArenaAlign(arena->MatrixBytes);
+
+    arena->Allocation = new uint8_t[arena->StripeBytes * stripeCount + kArenaAlignBytes];
+    uint8_t* slab = arena->Allocation + ((kArenaAlignBytes - reinterpret_cast<uintptr_t>(arena->Allocation)) & (kArenaAlignBytes - 1));
+
+    arena->Stripes = new cm256_stripe[stripeCount];
+    arena->NextFree = new std::atomic<uint32_t>[stripeCount];
+
+    // Every stripe starts out on the free list, in order
+    for (int i = 0; i < stripeCount; ++i)
+    {
+        uint8_t* stripeData = slab + arena->StripeBytes * i;
+
+        cm256_stripe& stripe = arena->Stripes[i];
+        stripe.Originals = stripeData;
+        stripe.Recovery = stripeData + recoveryOffset;
+        stripe.Stride = static_cast<int>(stride);
+
+        arena->NextFree[i].store(i + 1 < stripeCount ? static_cast<uint32_t>(i + 1) : kArenaListEnd, std::memory_order_relaxed);
+    }
+    arena->FreeHead.store(0, std::memory_order_release);
+
+    *arenaOut = arena;
+    return 0;
+}
+
+extern "C" void cm256_arena_free(cm256_arena* arena)
+{
+    if (arena)
+    {
+        delete[] arena->NextFree;
+        delete[] arena->Stripes;
+        delete[] arena->Allocation;
+        delete arena;
+    }
+}
+
+extern "C" int cm256_arena_acquire(
+    cm256_arena* arena,        // Arena to take a stripe from
+    cm256_stripe** stripeOut)  // Output stripe
+{
+    if (!arena || !stripeOut)
+    {
+        return -3;
+    }
+    *stripeOut = nullptr;
+
+    uint64_t head = arena->FreeHead.load(std::memory_order_acquire);
+    uint32_t index;
+    for (;;)
+    {
+        index = static_cast<uint32_t>(head);
+        if (index == kArenaListEnd)
+        {
+            return -11;
+        }
+
+        const uint32_t next = arena->NextFree[index].load(std::memory_order_relaxed);
+        const uint64_t newHead = ((head & ~(uint64_t)0xffffffff) + kArenaListTag) | next;
+
+        if (arena->FreeHead.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire))
+        {
+            break;
+        }
+    }
+
+    // Point the block descriptors back at the originals, since decoding may have moved them
+    cm256_stripe* stripe = arena->Stripes + index;
+    for (int i = 0; i < arena->Params.OriginalCount; ++i)
+    {
+        stripe->Blocks[i].Block = stripe->Originals + (size_t)stripe->Stride * i;
+        stripe->Blocks[i].Index = static_cast<uint8_t>(i);
+    }
+
+    *stripeOut = stripe;
+    return 0;
+}
+
+extern "C" int cm256_arena_release(
+    cm256_arena* arena,    // Arena the stripe came from
+    cm256_stripe* stripe)  // Stripe to return
+{
+    if (!arena || !stripe)
+    {
+        return -3;
+    }
+    if (stripe < arena->Stripes || stripe >= arena->Stripes + arena->StripeCount)
+    {
+        return -1;
+    }
+
+    const uint32_t index = static_cast<uint32_t>(stripe - arena->Stripes);
+
+    uint64_t head = arena->FreeHead.load(std::memory_order_relaxed);
+    uint64_t newHead;
+    do
+    {
+        arena->NextFree[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        newHead = ((head & ~(uint64_t)0xffffffff) + kArenaListTag) | index;
+    } while (!arena->FreeHead.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed));
+
     return 0;
 }
+
+extern "C" int cm256_arena_decode(
+    cm256_arena* arena,    // Arena the stripe came from
+    cm256_stripe* stripe)  // Stripe whose Blocks describe the received blocks
+{
+    if (!arena || !stripe)
+    {
+        return -3;
+    }
+    if (stripe < arena->Stripes || stripe >= arena->Stripes + arena->StripeCount)
+    {
+        return -1;
+    }
+
+    uint8_t* matrix = arena->MatrixBytes > 0 ? stripe->Originals + arena->MatrixOffset : nullptr;
+    return DecodeWithCache(arena->Params, stripe->Blocks, nullptr, nullptr, matrix, arena->MatrixBytes);
+}
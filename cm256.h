@@ -107,6 +107,10 @@ static inline unsigned char cm256_get_original_block_index(cm256_encoder_params
  * The output recovery blocks are stored end-to-end in 'recoveryBlocks'.
  * 'recoveryBlocks' should have recoveryCount * blockBytes bytes available.
  *
+ * Large blocks are encoded in cache-sized byte strips, producing every
+ * recovery block for one strip before moving on, so that each original
+ * byte is read from memory about once rather than once per recovery block.
+ *
  * Precondition: originalCount + recoveryCount <= 256
  *
  * When transmitting the data, the block index of the data should be sent,
@@ -139,6 +143,179 @@ extern void cm256_encode_block(
     int recoveryBlockIndex,      // Return value from cm256_get_recovery_block_index()
     void* recoveryBlock);        // Output recovery block
 
+/*
+ * Streaming stores
+ *
+ * When the original plus recovery data is much larger than the last level
+ * cache, the encoders write recovery blocks with non-temporal stores so that
+ * they do not evict the originals that are still being read.  This switches
+ * on when (originalCount + recoveryCount) * blockBytes is at least the
+ * threshold, which defaults to 64 MB.  A threshold of 0 always streams, and
+ * a negative threshold never streams.  The output is the same either way.
+ *
+ * This may be called while other threads are encoding.  Each encode call
+ * reads the threshold once when it starts, so a change applies to the calls
+ * that start after it.
+ */
+extern void cm256_set_streaming_threshold(int64_t bytes);
+
+/*
+ * Delta update
+ *
+ * When bytes [offset, offset + bytes) of one original block change, every
+ * recovery block changes by that row's coefficient times (old XOR new) over
+ * the same bytes.  These functions apply the change to the recovery blocks
+ * in place, reading only the changed bytes instead of all of the originals.
+ *
+ * oldData, newData and delta hold just the changed bytes.
+ *
+ * Returns -5 if originalIndex is not an original block index.
+ * Returns -1 if the byte range does not fit within blockBytes.
+ * Returns 0 on success, and any other code indicates failure.
+ */
+
+// Update the recovery blocks for a change from oldData to newData.
+extern int cm256_update(
+    cm256_encoder_params params, // Encoder parameters
+    int originalIndex,           // Original block that changed
+    const void* oldData,         // Previous contents of the changed bytes
+    const void* newData,         // New contents of the changed bytes
+    int offset,                  // First changed byte of the block
+    int bytes,                   // Number of changed bytes
+    void* recoveryBlocks);       // Recovery blocks end-to-end, updated in place
+
+// Update the recovery blocks for a change of (old XOR new) = delta.
+extern int cm256_update_delta(
+    cm256_encoder_params params, // Encoder parameters
+    int originalIndex,           // Original block that changed
+    const void* delta,           // XOR of the previous and new contents of the changed bytes
+    int offset,                  // First changed byte of the block
+    int bytes,                   // Number of changed bytes
+    void* recoveryBlocks);       // Recovery blocks end-to-end, updated in place
+
+
+/*
+ * Reusable encoder context
+ *
+ * When many stripes are encoded with the same parameters, the encoder context
+ * validates the parameters and generates the Cauchy matrix coefficients once
+ * so that each encode call only performs the data math.
+ *
+ * Example:
+ * 	cm256_encoder_ctx* ctx;
+ * 	if (cm256_encoder_create(params, &ctx)) exit(1);
+ * 	for (each stripe) cm256_encoder_encode(ctx, originals, recoveryBlocks);
+ * 	cm256_encoder_free(ctx);
+ *
+ * The context is not modified by encoding, so it may be shared between threads.
+ */
+typedef struct cm256_encoder_ctx_t cm256_encoder_ctx;
+
+// Create an encoder context for the given parameters.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_encoder_create(
+    cm256_encoder_params params, // Encoder parameters
+    cm256_encoder_ctx** ctxOut); // Output encoder context
+
+// Free an encoder context.  Passing null is allowed.
+extern void cm256_encoder_free(cm256_encoder_ctx* ctx);
+
+// Same as cm256_encode() using the parameters of the context.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_encoder_encode(
+    cm256_encoder_ctx* ctx,      // Encoder context
+    cm256_block* originals,      // Array of pointers to original blocks
+    void* recoveryBlocks);       // Output recovery blocks end-to-end
+
+// Same as cm256_encode_batch() using the parameters of the context.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_encoder_encode_batch(
+    cm256_encoder_ctx* ctx,      // Encoder context
+    cm256_block* originals,      // Array of stripeCount * originalCount original blocks
+    void* recoveryBlocks,        // Output stripeCount * recoveryCount recovery blocks end-to-end
+    int stripeCount);            // Number of stripes
+
+// Same as cm256_encode_block() using the parameters of the context.
+// Note: This function does not validate input, use with care.
+extern void cm256_encoder_encode_block(
+    cm256_encoder_ctx* ctx,      // Encoder context
+    cm256_block* originals,      // Array of pointers to original blocks
+    int recoveryBlockIndex,      // Return value from cm256_get_recovery_block_index()
+    void* recoveryBlock);        // Output recovery block
+
+/*
+ * Batch encode
+ *
+ * Encodes 'stripeCount' independent stripes that share the same parameters.
+ * The matrix coefficients are generated once for the whole batch, which
+ * matters when blocks are small and per-call overhead dominates.
+ *
+ * 'originals' holds originalCount blocks for each stripe, stripe after stripe.
+ * The output holds recoveryCount * blockBytes bytes for each stripe, stripe
+ * after stripe, laid out as in cm256_encode().
+ *
+ * Returns 0 on success, and any other code indicates failure.
+ */
+extern int cm256_encode_batch(
+    cm256_encoder_params params, // Encoder parameters
+    cm256_block* originals,      // Array of stripeCount * originalCount original blocks
+    void* recoveryBlocks,        // Output stripeCount * recoveryCount recovery blocks end-to-end
+    int stripeCount);            // Number of stripes
+
+
+/*
+ * Streaming encoder
+ *
+ * Original blocks can be added one at a time as they are produced.  Each
+ * one is folded into every recovery block right away, so the encoding work
+ * is spread out over the stripe and the recovery blocks are ready as soon
+ * as the last original is added.  The output is identical to cm256_encode().
+ *
+ * Example:
+ * 	cm256_stream_encoder* encoder;
+ * 	if (cm256_stream_encoder_create(params, &encoder)) exit(1);
+ * 	for (each stripe) {
+ * 		cm256_stream_encoder_init(encoder, recoveryBlocks);
+ * 		for (each original i, in any order) cm256_stream_encoder_add(encoder, i, originalBlock);
+ * 		if (cm256_stream_encoder_finalize(encoder)) exit(1);
+ * 	}
+ * 	cm256_stream_encoder_free(encoder);
+ *
+ * The original blocks do not need to stay valid after they are added.
+ */
+typedef struct cm256_stream_encoder_t cm256_stream_encoder;
+
+// Create a streaming encoder for the given parameters.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_stream_encoder_create(
+    cm256_encoder_params params,        // Encoder parameters
+    cm256_stream_encoder** encoderOut); // Output streaming encoder
+
+// Free a streaming encoder.  Passing null is allowed.
+extern void cm256_stream_encoder_free(cm256_stream_encoder* encoder);
+
+// Start a new stripe, writing recovery blocks end-to-end into 'recoveryBlocks'.
+// The buffer should have recoveryCount * blockBytes bytes available and must
+// stay valid until cm256_stream_encoder_finalize() is called.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_stream_encoder_init(
+    cm256_stream_encoder* encoder, // Streaming encoder
+    void* recoveryBlocks);         // Output recovery blocks end-to-end
+
+// Add an original block to the current stripe.
+// Returns 0 on success, and any other code indicates failure.
+// Returns -5 if the index is out of range or was already added.
+extern int cm256_stream_encoder_add(
+    cm256_stream_encoder* encoder, // Streaming encoder
+    int originalIndex,             // Return value from cm256_get_original_block_index()
+    const void* originalBlock);    // Original block data
+
+// Complete the current stripe.
+// Returns 0 on success, and any other code indicates failure.
+// Returns -6 if not every original block was added.
+extern int cm256_stream_encoder_finalize(cm256_stream_encoder* encoder);
+
+
 /*
  * Cauchy MDS GF(256) decode
  *
@@ -161,6 +338,635 @@ extern int cm256_decode(
     cm256_encoder_params params, // Encoder parameters
     cm256_block* blocks);        // Array of 'originalCount' blocks as described above
 
+/*
+ * Decode into caller-provided buffers
+ *
+ * Same as cm256_decode() except that the received blocks are not modified.
+ * Each erased original block is written to outputs[originalIndex], and the
+ * other entries of 'outputs' are ignored and may be null.  The decoder reads
+ * the received data once and writes each output directly, so there is no
+ * need to copy the recovery blocks first to preserve them.
+ *
+ * The output buffers must not overlap any of the received blocks.
+ *
+ * Returns 0 on success, and any other code indicates failure.
+ */
+extern int cm256_decode_into(
+    cm256_encoder_params params, // Encoder parameters
+    const cm256_block* blocks,   // Array of 'originalCount' blocks as described above
+    void* const* outputs);       // Array of 'originalCount' output pointers, by original block index
+
+/*
+ * Partial-range decode
+ *
+ * Same as cm256_decode() except that only bytes [offset, offset + bytes) of
+ * each block are read, and only that window of each recovery block is
+ * replaced with original data.  The rest of every block is left untouched,
+ * so a degraded read of part of a large block costs in proportion to the
+ * window rather than to blockBytes.  The recovered Index values are set as
+ * for cm256_decode().
+ *
+ * Each byte column decodes independently, so when only the window of each
+ * block is in memory, cm256_decode() with blockBytes set to the window
+ * length gives the same result.
+ *
+ * Returns -1 if the window does not fit within blockBytes.
+ * Returns 0 on success, and any other code indicates failure.
+ */
+extern int cm256_decode_range(
+    cm256_encoder_params params, // Encoder parameters
+    cm256_block* blocks,         // Array of 'originalCount' blocks as described above
+    int offset,                  // First byte of each block to decode
+    int bytes);                  // Number of bytes of each block to decode
+
+/*
+ * Decode a subset of the erased originals
+ *
+ * Recovers only the original blocks listed in 'wanted', writing original
+ * wanted[i] to outputs[i].  The received blocks are not modified.
+ *
+ * Each output comes straight from its row of the inverse of the Cauchy
+ * system with one multi-source pass over the received blocks, so recovering
+ * one of several erased blocks costs about one block pass per received
+ * block instead of a full solve.  Wanted originals that were received are
+ * copied.
+ *
+ * The output buffers must not overlap any of the received blocks.
+ *
+ * Returns -5 if a block index repeats or a wanted index is out of range.
+ * Returns 0 on success, and any other code indicates failure.
+ */
+extern int cm256_decode_subset(
+    cm256_encoder_params params, // Encoder parameters
+    const cm256_block* blocks,   // Array of 'originalCount' blocks as described above
+    const unsigned char* wanted, // Original block indices to recover
+    int wantedCount,             // Number of entries in 'wanted'
+    void* const* outputs);       // Output block for each entry in 'wanted'
+
+/*
+ * Repair recovery blocks
+ *
+ * Regenerates the recovery blocks listed in 'targets', which are values
+ * returned by cm256_get_recovery_block_index(), from any 'originalCount'
+ * received blocks, writing target i to outputs[i].  The received blocks
+ * may mix originals and recovery blocks, and are not modified.
+ *
+ * The encoding row of each target is combined with the inverse of the
+ * received system once, so each target is produced with one multi-source
+ * pass over the received blocks without restoring the originals first.
+ *
+ * The output buffers must not overlap any of the received blocks.
+ *
+ * Returns -5 if a block index repeats or a target is not a recovery index.
+ * Returns 0 on success, and any other code indicates failure.
+ */
+extern int cm256_repair(
+    cm256_encoder_params params,  // Encoder parameters
+    const cm256_block* blocks,    // Array of 'originalCount' blocks as described above
+    const unsigned char* targets, // Recovery block indices to regenerate
+    int targetCount,              // Number of entries in 'targets'
+    void* const* outputs);        // Output block for each entry in 'targets'
+
+/*
+ * Encode with checksums
+ *
+ * Same as cm256_encode(), and also writes the gf256_crc32c() checksum of
+ * each block to 'crcs': originals 0..originalCount-1 first, followed by the
+ * recovery blocks in output order, for originalCount + recoveryCount
+ * entries in all.
+ *
+ * The blocks are encoded in cache-sized strips, and each strip of every
+ * block is checksummed right after it is encoded while it is still in
+ * cache, so the checksums cost no extra pass over memory.
+ *
+ * Returns 0 on success, and any other code indicates failure.
+ */
+extern int cm256_encode_crc(
+    cm256_encoder_params params, // Encoder parameters
+    cm256_block* originals,      // Array of pointers to original blocks
+    void* recoveryBlocks,        // Output recovery blocks end-to-end
+    uint32_t* crcs);             // Output checksum of each original and recovery block
+
+/*
+ * Decode with checksums
+ *
+ * Same as cm256_decode(), and also checksums the blocks strip by strip as
+ * the decoder streams through them.  'receivedCrcs[i]' is set to the
+ * gf256_crc32c() of blocks[i] as it was received, to compare with the
+ * checksum sent alongside it.  'decodedCrcs[i]' is set to the checksum of
+ * blocks[i] after decoding, which is original block blocks[i].Index, to
+ * compare with the checksums from cm256_encode_crc().
+ *
+ * Either array may be null, and otherwise has 'originalCount' entries.
+ *
+ * Returns 0 on success, and any other code indicates failure.
+ */
+extern int cm256_decode_crc(
+    cm256_encoder_params params, // Encoder parameters
+    cm256_block* blocks,         // Array of 'originalCount' blocks as described above
+    uint32_t* receivedCrcs,      // Optional output checksum of each block as received
+    uint32_t* decodedCrcs);      // Optional output checksum of each block after decoding
+
+/*
+ * Verify recovery blocks
+ *
+ * Checks that the stored recovery blocks, laid out end-to-end as written by
+ * cm256_encode(), still match the original blocks.  Each row is recomputed in
+ * small strips into a scratch buffer that stays in L1 cache and compared with
+ * the stored data, so nothing is written to memory and the scan stops at the
+ * first strip that differs.
+ *
+ * The blocks are checked one strip at a time, every row of a strip before
+ * the next strip.  On a mismatch, 'mismatchRow' is set to the position of the
+ * recovery block in 'recoveryBlocks' and 'mismatchOffset' to the first byte
+ * of that block that differs within the strip.  Either may be null.
+ *
+ * Returns 0 if every recovery block matches.
+ * Returns 1 on a mismatch.
+ * Returns a negative code if the parameters are invalid.
+ */
+extern int cm256_verify(
+    cm256_encoder_params params,  // Encoder parameters
+    const cm256_block* originals, // Array of pointers to original blocks
+    const void* recoveryBlocks,   // Stored recovery blocks end-to-end
+    int* mismatchRow,             // Optional output recovery block position that differs
+    int* mismatchOffset);         // Optional output byte offset that differs
+
+/*
+ * Batch decode
+ *
+ * Decodes 'stripeCount' stripes that share the same parameters and the same
+ * erasure pattern, generating the matrix decomposition only once.
+ *
+ * 'blocks' holds originalCount blocks for each stripe, stripe after stripe.
+ * Each stripe must list the same block Index values in the same order as the
+ * first stripe, or -7 is returned before any stripe is modified.
+ *
+ * Returns 0 on success, and any other code indicates failure.
+ */
+extern int cm256_decode_batch(
+    cm256_encoder_params params, // Encoder parameters
+    cm256_block* blocks,         // Array of stripeCount * originalCount blocks
+    int stripeCount);            // Number of stripes
+
+
+/*
+ * Erasure-pattern cache for the decoder
+ *
+ * Decoding more than one erasure requires factoring a matrix that depends
+ * only on which blocks were lost and which recovery blocks replaced them.
+ * When the same loss patterns repeat, the cache keeps the factored matrices
+ * for the most recently used patterns so that decoding only performs the
+ * data math.  This matters most for small blocks.
+ *
+ * One cache may be used with any parameters.  It is not thread-safe, so use
+ * one cache per thread.
+ */
+typedef struct cm256_decoder_cache_t cm256_decoder_cache;
+
+// Create a cache holding up to 'maxEntries' erasure patterns.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_decoder_cache_create(
+    int maxEntries,                  // Maximum number of erasure patterns to keep
+    cm256_decoder_cache** cacheOut); // Output cache
+
+// Free a cache.  Passing null is allowed.
+extern void cm256_decoder_cache_free(cm256_decoder_cache* cache);
+
+// Report how many decodes reused a cached matrix and how many had to generate one
+extern void cm256_decoder_cache_stats(
+    const cm256_decoder_cache* cache, // Cache to query
+    uint64_t* hits,                   // Output number of lookups that reused a matrix
+    uint64_t* misses);                // Output number of lookups that generated a matrix
+
+// Same as cm256_decode() except that matrix decompositions are reused from the cache.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_decode_cached(
+    cm256_encoder_params params, // Encoder parameters
+    cm256_block* blocks,         // Array of 'originalCount' blocks as described above
+    cm256_decoder_cache* cache); // Erasure-pattern cache
+
+
+/*
+ * Decoder context
+ *
+ * For many stripes with the same parameters, a decoder context validates
+ * the parameters once and keeps its decoder state between calls, so large
+ * recovery counts do not allocate the decoder matrix on every decode.  When
+ * the blocks of a stripe have the same indices in the same order as in the
+ * previous call, the erasure bookkeeping and the matrix are reused, so
+ * back-to-back decodes with one loss pattern only perform the data math.
+ * With an erasure-pattern cache, patterns that come back after others also
+ * skip generating the matrix.
+ *
+ * Example:
+ * 	cm256_decoder_ctx* ctx;
+ * 	if (cm256_decoder_create(params, cache, &ctx)) exit(1);
+ * 	for (each stripe) cm256_decoder_decode(ctx, blocks);
+ * 	cm256_decoder_free(ctx);
+ *
+ * The context is modified by decoding, so use one context per thread.  The
+ * cache may be shared by contexts on the same thread, and must outlive them.
+ */
+typedef struct cm256_decoder_ctx_t cm256_decoder_ctx;
+
+// Create a decoder context for the given parameters.  The cache may be null.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_decoder_create(
+    cm256_encoder_params params, // Encoder parameters
+    cm256_decoder_cache* cache,  // Optional erasure-pattern cache
+    cm256_decoder_ctx** ctxOut); // Output decoder context
+
+// Free a decoder context.  Passing null is allowed.  The cache is not freed.
+extern void cm256_decoder_free(cm256_decoder_ctx* ctx);
+
+// Same as cm256_decode() using the parameters and cache of the context.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_decoder_decode(
+    cm256_decoder_ctx* ctx,      // Decoder context
+    cm256_block* blocks);        // Array of 'originalCount' blocks as described above
+
+
+/*
+ * Scatter-gather blocks
+ *
+ * Each block may be split across several memory segments, for example
+ * fragments in network ring buffers or pooled slabs.  The segment lengths
+ * of each block must add up to blockBytes, and different blocks may be
+ * split at different offsets.  The bulk kernels run directly on the
+ * segments, so no staging copy is needed.
+ *
+ * Returns -8 if the segment lengths of a block do not add up to blockBytes.
+ */
+
+// One contiguous piece of a block
+typedef struct cm256_segment_t {
+    // Pointer to the segment data
+    void* Data;
+
+    // Number of bytes in the segment
+    int Bytes;
+} cm256_segment;
+
+// Descriptor for a data block held in segments
+typedef struct cm256_sg_block_t {
+    // Array of segments in block order
+    const cm256_segment* Segments;
+
+    // Number of segments
+    int SegmentCount;
+
+    // Block index, as described in the cm256_block struct comments above
+    unsigned char Index;
+} cm256_sg_block;
+
+// Same as cm256_encode() with each recovery block written to its own segments.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_encode_sg(
+    cm256_encoder_params params,       // Encoder parameters
+    const cm256_sg_block* originals,   // Array of 'originalCount' original blocks
+    const cm256_sg_block* recovery);   // Array of 'recoveryCount' output recovery blocks
+
+// Same as cm256_decode() for blocks held in segments.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_decode_sg(
+    cm256_encoder_params params, // Encoder parameters
+    cm256_sg_block* blocks);     // Array of 'originalCount' blocks as described above
+
+
+/*
+ * Streaming decoder
+ *
+ * Blocks can be added one at a time as they arrive, in any order.  The
+ * original data is eliminated from the recovery blocks as each block is
+ * added, so once the last block arrives only the final solve remains.
+ * The result is identical to cm256_decode().
+ *
+ * Example:
+ * 	cm256_stream_decoder* decoder;
+ * 	if (cm256_stream_decoder_create(params, &decoder)) exit(1);
+ * 	for (each stripe) {
+ * 		cm256_stream_decoder_init(decoder);
+ * 		for (each received block) cm256_stream_decoder_add_block(decoder, &blocks[i]);
+ * 		if (cm256_stream_decoder_finalize(decoder)) exit(1);
+ * 	}
+ * 	cm256_stream_decoder_free(decoder);
+ *
+ * The decoder keeps the cm256_block pointers that are added, so the block
+ * descriptors and their data must stay valid until the stripe is finalized.
+ * Like cm256_decode(), recovery block data is modified in place, and the
+ * Index of each recovery block is updated on finalize to indicate the
+ * original block that was recovered.
+ */
+typedef struct cm256_stream_decoder_t cm256_stream_decoder;
+
+// Create a streaming decoder for the given parameters.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_stream_decoder_create(
+    cm256_encoder_params params,        // Encoder parameters
+    cm256_stream_decoder** decoderOut); // Output streaming decoder
+
+// Free a streaming decoder.  Passing null is allowed.
+extern void cm256_stream_decoder_free(cm256_stream_decoder* decoder);
+
+// Start a new stripe, forgetting any blocks added before.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_stream_decoder_init(cm256_stream_decoder* decoder);
+
+// Add a received block to the current stripe.
+// Returns 0 on success, and any other code indicates failure.
+// Returns -5 if the index is out of range or was already added.
+// Returns -6 if 'originalCount' blocks were already added.
+extern int cm256_stream_decoder_add_block(
+    cm256_stream_decoder* decoder, // Streaming decoder
+    cm256_block* block);           // Received block
+
+// Recover the erased original data once 'originalCount' blocks are added.
+// Returns 0 on success, and any other code indicates failure.
+// Returns -6 if fewer than 'originalCount' blocks were added.
+extern int cm256_stream_decoder_finalize(cm256_stream_decoder* decoder);
+
+
+/*
+ * Multi-threaded encode and decode
+ *
+ * Each block is split into byte ranges that are processed in parallel.
+ * The ranges start on cache line boundaries so that workers do not write
+ * to the same cache lines, and blocks smaller than about 32 KB per worker
+ * are split into fewer ranges.  The decoder matrix is generated once on
+ * the calling thread and shared by all workers.
+ *
+ * By default the library starts ThreadCount - 1 threads for each call and
+ * runs the first range on the calling thread.  To use an existing thread
+ * pool instead, provide a Scheduler function that runs task(taskContext, i)
+ * for every i in [0, taskCount) and returns only after all of them finish.
+ *
+ * The output is identical to cm256_encode() and cm256_decode().
+ */
+
+// Work item: Process byte range 'taskIndex'
+typedef void (*cm256_task_fn)(void* taskContext, int taskIndex);
+
+// Run task(taskContext, i) for each i in [0, taskCount) and wait for all of them
+typedef void (*cm256_scheduler_fn)(
+    void* schedulerContext, // SchedulerContext from cm256_threading
+    cm256_task_fn task,     // Function to call for each task
+    void* taskContext,      // Context to pass to the task function
+    int taskCount);         // Number of tasks to run
+
+// Threading options
+typedef struct cm256_threading_t {
+    // Maximum number of byte ranges to process in parallel (at least 1)
+    int ThreadCount;
+
+    // Optional: Caller-provided scheduler, or null to use library threads
+    cm256_scheduler_fn Scheduler;
+
+    // Passed to the Scheduler
+    void* SchedulerContext;
+} cm256_threading;
+
+// Run task(taskContext, i) for each i in [0, taskCount) on the Scheduler, or
+// on library threads with the first task on the calling thread, and wait for
+// all of them.  If a thread cannot be started, its task runs on the calling
+// thread instead.  The codec uses this for its own workers, and callers may
+// use it to run related work the same way.
+extern void cm256_run_tasks(
+    const cm256_threading* threading, // Threading options, or null to use library threads
+    cm256_task_fn task,               // Function to call for each task
+    void* taskContext,                // Context to pass to the task function
+    int taskCount);                   // Number of tasks to run
+
+// Same as cm256_encode() using multiple threads.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_encode_mt(
+    cm256_encoder_params params,       // Encoder parameters
+    cm256_block* originals,            // Array of pointers to original blocks
+    void* recoveryBlocks,              // Output recovery blocks end-to-end
+    const cm256_threading* threading); // Threading options
+
+// Same as cm256_decode() using multiple threads.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_decode_mt(
+    cm256_encoder_params params,       // Encoder parameters
+    cm256_block* blocks,               // Array of 'originalCount' blocks as described above
+    const cm256_threading* threading); // Threading options
+
+
+/*
+ * Bit-matrix XOR mode
+ *
+ * An alternative code for CPUs where the GF(256) table-lookup kernels are
+ * slow, such as cores without a fast byte shuffle.  Each block is split into
+ * 8 packets of blockBytes / 8 bytes, and the Cauchy matrix is expanded into
+ * its GF(2) bit-matrix form so that every recovery packet is an XOR of some
+ * original packets.  Encoding and decoding then run only wide XORs, with
+ * sums shared between packets computed once, and are bound by memory
+ * bandwidth instead of table lookups.
+ *
+ * The code is MDS like the default mode, but the recovery data differs when
+ * recoveryCount > 1, so blocks encoded with cm256_xor_encode() must be decoded
+ * with cm256_xor_decode().
+ *
+ * Returns -9 if blockBytes is not a multiple of 8.
+ */
+
+// Same as cm256_encode() using the bit-matrix XOR code.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_xor_encode(
+    cm256_encoder_params params, // Encoder parameters
+    cm256_block* originals,      // Array of pointers to original blocks
+    void* recoveryBlocks);       // Output recovery blocks end-to-end
+
+// Same as cm256_decode() for data encoded by cm256_xor_encode().
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_xor_decode(
+    cm256_encoder_params params, // Encoder parameters
+    cm256_block* blocks);        // Array of 'originalCount' blocks as described above
+
+/*
+ * Schedule cache for the XOR mode
+ *
+ * Each call builds an XOR schedule for its bit matrix, and a decode first
+ * inverts the submatrix of its loss pattern, which can take longer than the
+ * XORs for small blocks.  A cache keeps the schedules for the parameters and
+ * loss patterns seen most recently, like the erasure-pattern cache above.
+ *
+ * One cache may be used with any parameters.  It is not thread-safe, so use
+ * one cache per thread.
+ */
+typedef struct cm256_xor_cache_t cm256_xor_cache;
+
+// Create a cache holding up to 'maxEntries' schedules.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_xor_cache_create(
+    int maxEntries,              // Maximum number of schedules to keep
+    cm256_xor_cache** cacheOut); // Output cache
+
+// Free a cache.  Passing null is allowed.
+extern void cm256_xor_cache_free(cm256_xor_cache* cache);
+
+// Report how many calls reused a cached schedule and how many had to build one
+extern void cm256_xor_cache_stats(
+    const cm256_xor_cache* cache, // Cache to query
+    uint64_t* hits,               // Output number of calls that reused a schedule
+    uint64_t* misses);            // Output number of calls that built a schedule
+
+// Same as cm256_xor_encode() except that the schedule is reused from the cache.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_xor_encode_cached(
+    cm256_encoder_params params, // Encoder parameters
+    cm256_block* originals,      // Array of pointers to original blocks
+    void* recoveryBlocks,        // Output recovery blocks end-to-end
+    cm256_xor_cache* cache);     // Schedule cache
+
+// Same as cm256_xor_decode() except that the schedule is reused from the cache.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_xor_decode_cached(
+    cm256_encoder_params params, // Encoder parameters
+    cm256_block* blocks,         // Array of 'originalCount' blocks as described above
+    cm256_xor_cache* cache);     // Schedule cache
+
+
+/*
+ * Instrumentation
+ *
+ * When cm256.cpp and gf256.cpp are built with CM256_INSTRUMENT defined, the
+ * codec counts the cycles spent in each phase of encoding and decoding, the
+ * times the decoder matrix did not fit on the stack, and the bytes passed
+ * to each gf256 kernel.  gf256_get_backend() reports the kernels in use.
+ * Without CM256_INSTRUMENT the hooks compile to nothing.
+ *
+ * Counters are kept per thread without synchronization.  The library
+ * threads of cm256_encode_mt() and cm256_decode_mt() add their counters to
+ * the calling thread when they are joined.  Tasks run on a caller-provided
+ * scheduler count on the threads that run them.
+ *
+ * Cycles are read from the x86 TSC, and are nanoseconds on other CPUs.
+ */
+
+// Codec phases that are timed
+typedef enum cm256_phase_t {
+    CM256_PHASE_ENCODE,      // Producing recovery data
+    CM256_PHASE_ELIMINATE,   // Adding the received originals into the recovery rows
+    CM256_PHASE_LDU,         // Generating the LDU decomposition of the erasure matrix
+    CM256_PHASE_LOWER_SOLVE, // Eliminating the lower triangle
+    CM256_PHASE_DIAGONAL,    // Dividing by the diagonal
+    CM256_PHASE_UPPER_SOLVE, // Eliminating the upper triangle
+
+    CM256_PHASE_COUNT
+} cm256_phase;
+
+// Counters for the calling thread
+typedef struct cm256_stats_t {
+    uint64_t PhaseCalls[CM256_PHASE_COUNT];
+    uint64_t PhaseCycles[CM256_PHASE_COUNT];
+    uint64_t PhaseBytes[CM256_PHASE_COUNT]; // Bytes of block data written
+
+    // Decodes whose matrix decomposition was too large for the stack
+    uint64_t HeapMatrixFallbacks;
+
+    // Bulk kernel counters from gf256_get_stats()
+    gf256_stats Kernels;
+} cm256_stats;
+
+// Kinds of trace events
+typedef enum cm256_trace_type_t {
+    CM256_TRACE_PHASE,      // A phase finished
+    CM256_TRACE_HEAP_MATRIX // The decoder allocated its matrix on the heap
+} cm256_trace_type;
+
+typedef struct cm256_trace_event_t {
+    cm256_trace_type Type;
+    cm256_phase Phase; // For CM256_TRACE_PHASE
+    uint64_t Cycles;   // For CM256_TRACE_PHASE
+    uint64_t Bytes;    // Block bytes written, or matrix bytes for CM256_TRACE_HEAP_MATRIX
+} cm256_trace_event;
+
+// Called on the thread that did the work, so it must be thread-safe
+typedef void (*cm256_trace_fn)(void* context, const cm256_trace_event* event);
+
+// Copy the calling thread's counters.
+// Returns 0 on success, or -1 if the library was built without CM256_INSTRUMENT.
+extern int cm256_get_stats(cm256_stats* stats);
+
+// Zero the calling thread's counters, including the gf256 kernel counters
+extern void cm256_reset_stats();
+
+// Set the hook called for each trace event, or null to remove it.
+// This must not be called while other threads are using the library.
+// Returns 0 on success, or -1 if the library was built without CM256_INSTRUMENT.
+extern int cm256_set_trace_hook(cm256_trace_fn hook, void* context);
+
+
+/*
+ * Stripe arena
+ *
+ * An arena preallocates a fixed number of stripes for one set of encoder
+ * parameters in a single allocation, and recycles them through a lock-free
+ * free list, so the hot path never calls the allocator.  In each stripe:
+ *
+ * + Every original block starts on a 64-byte boundary, 'Stride' bytes apart,
+ *   so the kernels do not have to handle unaligned heads.
+ * + The recovery blocks are end-to-end as cm256_encode() writes them.  They
+ *   begin on a 64-byte boundary, and each block is aligned as well when
+ *   blockBytes is a multiple of GF256_ALIGN_BYTES.
+ * + Space for the decoder matrix is included, so cm256_arena_decode() does not
+ *   allocate even for large recovery counts.
+ *
+ * Example:
+ * 	cm256_stripe* stripe;
+ * 	if (cm256_arena_acquire(arena, &stripe)) wait or fail;
+ * 	(fill stripe->Originals)
+ * 	cm256_encode(params, stripe->Blocks, stripe->Recovery);
+ * 	cm256_arena_release(arena, stripe);
+ *
+ * Acquire and release may be called from any thread at the same time.  A
+ * stripe is used by one thread at a time, and must be released only once.
+ *
+ * Returns -11 from cm256_arena_acquire() when every stripe is in use.
+ */
+typedef struct cm256_stripe_t {
+    // Descriptors for cm256_encode() and cm256_arena_decode().
+    // cm256_arena_acquire() points the first originalCount at the originals in order
+    cm256_block Blocks[256];
+
+    uint8_t* Originals; // originalCount blocks, 'Stride' bytes apart
+    uint8_t* Recovery;  // recoveryCount blocks end-to-end
+    int Stride;         // blockBytes rounded up to a multiple of 64
+} cm256_stripe;
+
+typedef struct cm256_arena_t cm256_arena;
+
+// Create an arena holding 'stripeCount' stripes for the given parameters.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_arena_create(
+    cm256_encoder_params params, // Encoder parameters
+    int stripeCount,             // Number of stripes to preallocate
+    cm256_arena** arenaOut);     // Output arena
+
+// Free an arena and all of its stripes.  Passing null is allowed.
+// Every stripe must have been released.
+extern void cm256_arena_free(cm256_arena* arena);
+
+// Take a free stripe from the arena.
+// Returns 0 on success, -11 if every stripe is in use, and any other code indicates failure.
+extern int cm256_arena_acquire(
+    cm256_arena* arena,        // Arena to take a stripe from
+    cm256_stripe** stripeOut); // Output stripe
+
+// Return a stripe to the arena.  Its data is left as-is.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_arena_release(
+    cm256_arena* arena,    // Arena the stripe came from
+    cm256_stripe* stripe); // Stripe to return
+
+// Same as cm256_decode() on stripe->Blocks, using the stripe's space for the decoder matrix.
+// Returns 0 on success, and any other code indicates failure.
+extern int cm256_arena_decode(
+    cm256_arena* arena,    // Arena the stripe came from
+    cm256_stripe* stripe); // Stripe whose Blocks describe the received blocks
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,421 @@
+/*
+	Copyright (c) 2015 Christopher A. Taylor.  All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice,
+	  this list of conditions and the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice,
+	  this list of conditions and the following disclaimer in the documentation
+	  and/or other materials provided with the distribution.
+	* Neither the name of CM256 nor the names of its contributors may be
+	  used to endorse or promote products derived from this software without
+	  specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CM256_CODEC_H
+#define CM256_CODEC_H
+
+#include "cm256.h"
+
+#if __cplusplus < 201402L && !(defined(_MSVC_LANG) && _MSVC_LANG >= 201402L)
+    #error "cm256_codec.h requires C++14 for constexpr matrix generation"
+#endif
+
+/*
+ * Fixed-layout codec
+ *
+ * cm256::Codec<K, M> encodes and decodes stripes of K original blocks and
+ * M recovery blocks, producing the same recovery data as cm256_encode() and
+ * accepting the same block descriptors as cm256_decode().
+ *
+ * Because K and M are template parameters the layout is checked at compile
+ * time, the Cauchy matrix is a constexpr table evaluated by the compiler,
+ * and all working storage is sized on the stack with no stack/heap choice.
+ * The bulk math still runs on the runtime-selected gf256 kernels, so
+ * cm256_init() must succeed before any Codec function is called.
+ *
+ * Example:
+ *
+ *      typedef cm256::Codec<10, 4> StorageCodec;
+ *
+ *      const void* originals[10] = { ... };
+ *      void* recovery[4] = { ... };
+ *      StorageCodec::Encode(originals, recovery, blockBytes);
+ *
+ *      cm256_block blocks[10] = { ... }; // Any 10 of the 14 blocks
+ *      if (StorageCodec::Decode(blocks, blockBytes) == 0) { ... }
+ */
+
+namespace cm256 {
+
+namespace detail {
+
+
+//-----------------------------------------------------------------------------
+// Compile-time GF(256) Math
+//
+// These mirror gf256_explog_init() for the default generator polynomial,
+// which is the one cm256_init() selects.
+
+static const unsigned kPolynomial = (0xa6 << 1) | 1;
+
+struct ExpLogTables
+{
+    uint8_t Exp[2 * 255];
+    uint16_t Log[256];
+
+    constexpr ExpLogTables() : Exp(), Log()
+    {
+        unsigned value = 1;
+        for (unsigned i = 0; i < 255; ++i)
+        {
+            Exp[i] = Exp[i + 255] = static_cast<uint8_t>(value);
+            Log[value] = static_cast<uint16_t>(i);
+
+            value <<= 1;
+            if (value >= 256)
+                value ^= kPolynomial;
+        }
+    }
+};
+
+static constexpr ExpLogTables kExpLog{};
+
+/// return x / y, or 0 if either is 0
+constexpr uint8_t Div(uint8_t x, uint8_t y)
+{
+    return (x == 0 || y == 0) ? 0 : kExpLog.Exp[kExpLog.Log[x] + 255 - kExpLog.Log[y]];
+}
+
+/// Encoding matrix for K originals and M recovery blocks.
+/// Row i holds the coefficients of recovery block K + i: see GetMatrixElement()
+/// in cm256.cpp.  The first row is all ones.
+template <int K, int M>
+struct Matrix
+{
+    uint8_t Rows[M][K];
+
+    constexpr Matrix() : Rows()
+    {
+        const uint8_t x_0 = static_cast<uint8_t>(K);
+
+        for (int i = 0; i < M; ++i)
+        {
+            const uint8_t x_i = static_cast<uint8_t>(K + i);
+
+            for (int j = 0; j < K; ++j)
+            {
+                const uint8_t y_j = static_cast<uint8_t>(j);
+                Rows[i][j] = Div(y_j ^ x_0, x_i ^ y_j);
+            }
+        }
+    }
+};
+
+
+} // namespace detail
+
+
+//-----------------------------------------------------------------------------
+// Codec
+
+template <int K, int M>
+class Codec
+{
+    static_assert(K >= 1 && M >= 1, "Codec needs at least one original and one recovery block");
+    static_assert(K + M <= 256, "Codec supports at most 256 blocks in total");
+
+public:
+    static constexpr int OriginalCount = K;
+    static constexpr int RecoveryCount = M;
+
+    /// Compile-time encoding matrix
+    static constexpr detail::Matrix<K, M> kMatrix{};
+
+    /// Value to put in cm256_block::Index for recovery block 0..M-1
+    static constexpr unsigned char RecoveryBlockIndex(int recoveryIndex)
+    {
+        return static_cast<unsigned char>(K + recoveryIndex);
+    }
+
+    /*
+     * Encode
+     *
+     * Produces all M recovery blocks from the K original blocks, each
+     * 'bytes' long.  The output matches cm256_encode() for the same data.
+     */
+    static void Encode(
+        const void* const (&originals)[K], // Original blocks
+        void* const (&recovery)[M],         // Output recovery blocks
+        int bytes)                          // Bytes per block
+    {
+        // If only one block of input data, all recovery blocks are copies
+        if (K == 1)
+        {
+            for (int i = 0; i < M; ++i)
+            {
+                memcpy(recovery[i], originals[0], bytes);
+            }
+            return;
+        }
+
+        // Both rows of an m=2 code are summed from one read of each original
+        if (M == 2)
+        {
+            EncodePair(originals, recovery, bytes, PairTag<M == 2>());
+            return;
+        }
+
+        EncodeParity(originals, recovery[0], bytes);
+
+        // The remaining rows sum all of the products in one pass each
+        for (int i = 1; i < M; ++i)
+        {
+            gf256_mul_multi_mem(recovery[i], kMatrix.Rows[i], originals, K, bytes);
+        }
+    }
+
+    /*
+     * Decode
+     *
+     * Takes any K of the K + M blocks, described as for cm256_decode(), and
+     * recovers the missing originals in place of the recovery blocks that were
+     * passed in, updating their Index members to the original block indices.
+     *
+     * Returns 0 on success.
+     * Returns -5 if a block index repeats or is out of range.
+     */
+    static int Decode(
+        cm256_block (&blocks)[K], // Any K of the blocks
+        int bytes)                // Bytes per block
+    {
+        cm256_block* recovery[M] = {};
+        const void* knownData[K];
+        uint8_t knownIndex[K];
+        uint8_t erasures[M] = {};
+        bool seen[K + M] = {};
+        int recoveryCount = 0, knownCount = 0;
+
+        for (int i = 0; i < K; ++i)
+        {
+            const int index = blocks[i].Index;
+            if (index >= K + M || seen[index])
+            {
+                return -5;
+            }
+            seen[index] = true;
+
+            if (index < K)
+            {
+                knownData[knownCount] = blocks[i].Block;
+                knownIndex[knownCount++] = static_cast<uint8_t>(index);
+            }
+            else
+            {
+                // Keep the recovery rows sorted so the parity row comes first
+                int j = recoveryCount++;
+                for (; j > 0 && recovery[j - 1]->Index > index; --j)
+                {
+                    recovery[j] = recovery[j - 1];
+                }
+                recovery[j] = &blocks[i];
+            }
+        }
+
+        // Nothing is erased
+        if (recoveryCount == 0)
+        {
+            return 0;
+        }
+
+        // If only one block of input data, the recovery block is a copy of it
+        if (K == 1)
+        {
+            recovery[0]->Index = 0;
+            return 0;
+        }
+
+        for (int j = 0, n = 0; j < K; ++j)
+        {
+            if (!seen[j])
+            {
+                erasures[n++] = static_cast<uint8_t>(j);
+            }
+        }
+
+        // Two rows including the parity row are solved in closed form:
+        // see DecodeM2Range() in cm256.cpp
+        if (M >= 2 && recoveryCount == 2 && recovery[0]->Index == K)
+        {
+            DecodeParityPair(recovery, knownData, knownIndex, knownCount, erasures, bytes);
+            return 0;
+        }
+
+        // LU decomposition of the square Cauchy submatrix that maps the erased
+        // originals to the received recovery rows.  Every square submatrix of
+        // a Cauchy matrix is invertible, so no pivoting is needed.
+        const int N = recoveryCount;
+        uint8_t lu[M][M];
+        for (int i = 0; i < N; ++i)
+        {
+            const uint8_t* row = kMatrix.Rows[recovery[i]->Index - K];
+            for (int k = 0; k < N; ++k)
+            {
+                lu[i][k] = row[erasures[k]];
+            }
+        }
+        for (int k = 0; k < N; ++k)
+        {
+            for (int i = k + 1; i < N; ++i)
+            {
+                const uint8_t l_ik = gf256_div(lu[i][k], lu[k][k]);
+                lu[i][k] = l_ik;
+                for (int j = k + 1; j < N; ++j)
+                {
+                    lu[i][j] ^= gf256_mul(l_ik, lu[k][j]);
+                }
+            }
+        }
+
+        uint8_t coefficients[K];
+        const void* sources[K];
+
+        // Forward pass: eliminate the known originals from each recovery row
+        // together with the L terms of the rows above it, in one pass per row
+        for (int i = 0; i < N; ++i)
+        {
+            void* block = recovery[i]->Block;
+            const uint8_t* row = kMatrix.Rows[recovery[i]->Index - K];
+
+            // The parity row is first when present, and is pure XOR
+            if (recovery[i]->Index == K)
+            {
+                for (int j = 0; j < knownCount; ++j)
+                {
+                    gf256_add_mem(block, knownData[j], bytes);
+                }
+                continue;
+            }
+
+            int count = 0;
+            for (int j = 0; j < knownCount; ++j, ++count)
+            {
+                coefficients[count] = row[knownIndex[j]];
+                sources[count] = knownData[j];
+            }
+            for (int j = 0; j < i; ++j, ++count)
+            {
+                coefficients[count] = lu[i][j];
+                sources[count] = recovery[j]->Block;
+            }
+
+            gf256_muladd_multi_mem(block, coefficients, sources, count, bytes);
+        }
+
+        // Backward pass: solve the U system from the bottom row up
+        for (int i = N - 1; i >= 0; --i)
+        {
+            void* block = recovery[i]->Block;
+            const uint8_t u_ii = lu[i][i];
+
+            gf256_div_mem_inplace(block, u_ii, bytes);
+
+            if (i + 1 < N)
+            {
+                int count = 0;
+                for (int j = i + 1; j < N; ++j, ++count)
+                {
+                    coefficients[count] = gf256_div(lu[i][j], u_ii);
+                    sources[count] = recovery[j]->Block;
+                }
+
+                gf256_muladd_multi_mem(block, coefficients, sources, count, bytes);
+            }
+        }
+
+        for (int i = 0; i < N; ++i)
+        {
+            recovery[i]->Index = erasures[i];
+        }
+
+        return 0;
+    }
+
+private:
+    // Recover erasures[0] into recovery[0], the parity row, and erasures[1] into recovery[1]
+    static void DecodeParityPair(
+        cm256_block* const (&recovery)[M],
+        const void* const (&knownData)[K],
+        const uint8_t (&knownIndex)[K],
+        int knownCount,
+        const uint8_t (&erasures)[M],
+        int bytes)
+    {
+        const uint8_t* row = kMatrix.Rows[recovery[1]->Index - K];
+        void* blockP = recovery[0]->Block;
+        void* blockQ = recovery[1]->Block;
+
+        uint8_t coefficients[K];
+        for (int j = 0; j < knownCount; ++j)
+        {
+            coefficients[j] = row[knownIndex[j]];
+        }
+        gf256_muladd_pq_multi_mem(blockP, blockQ, coefficients, knownData, knownCount, bytes);
+
+        // Now blockP = o_a + o_b and blockQ = c_a * o_a + c_b * o_b
+        const uint8_t c_a = row[erasures[0]];
+        const uint8_t c_b = row[erasures[1]];
+        gf256_muladd_mem(blockQ, c_a, blockP, bytes);
+        gf256_div_mem_inplace(blockQ, gf256_add(c_a, c_b), bytes);
+        gf256_add_mem(blockP, blockQ, bytes);
+
+        recovery[0]->Index = erasures[0];
+        recovery[1]->Index = erasures[1];
+    }
+
+    // Selects EncodePair() by whether the code has two recovery rows, so that
+    // a single-row code never instantiates the call with aliased outputs
+    template <bool Pair>
+    struct PairTag {};
+
+    static void EncodePair(const void* const (&originals)[K], void* const (&recovery)[M], int bytes, PairTag<true>)
+    {
+        gf256_mul_pq_multi_mem(recovery[0], recovery[1], kMatrix.Rows[1], originals, K, bytes);
+    }
+
+    static void EncodePair(const void* const (&)[K], void* const (&)[M], int, PairTag<false>)
+    {
+    }
+
+    // recovery[] = sum of all originals
+    static void EncodeParity(const void* const (&originals)[K], void* recovery, int bytes)
+    {
+        gf256_addset_mem(recovery, originals[0], originals[1], bytes);
+        for (int j = 2; j < K; ++j)
+        {
+            gf256_add_mem(recovery, originals[j], bytes);
+        }
+    }
+};
+
+template <int K, int M>
+constexpr detail::Matrix<K, M> Codec<K, M>::kMatrix;
+
+
+} // namespace cm256
+
+#endif // CM256_CODEC_H
@@ -0,0 +1,1237 @@
+/*
+	Copyright (c) 2015 Christopher A. Taylor.  All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice,
+	  this list of conditions and the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice,
+	  this list of conditions and the following disclaimer in the documentation
+	  and/or other materials provided with the distribution.
+	* Neither the name of CM256 nor the names of its contributors may be
+	  used to endorse or promote products derived from this software without
+	  specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cm256_file.h"
+
+#include <string.h>
+#include <atomic>
+
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+//-----------------------------------------------------------------------------
+// Mapped Files
+
+/*
+    Files that are read are mapped whole.  The input is mapped read-only for
+    encoding and read-write for repair, and the shards are mapped read-only
+    for reading headers and read-write for repair, so that blocks failing
+    their checksums can be rewritten in place.
+
+    Shards that are written are not mapped.  Each worker writes its recovery
+    blocks with a positioned write instead, because every page of a new file
+    written through a mapping takes a page fault, which cost more than the
+    copy into the page cache.  A file of zero bytes or a file that is
+    written is opened but not mapped, and Data is null.
+*/
+
+struct MappedFile
+{
+    uint8_t* Data;
+    uint64_t Bytes;
+
+#if defined(_WIN32)
+    HANDLE File;
+    HANDLE Mapping;
+#else
+    int File;
+#endif
+};
+
+enum MapMode
+{
+    // Open an existing file read-only, setting Bytes to its size
+    MapRead,
+
+    // Open an existing file read-write, setting Bytes to its size
+    MapModify,
+
+    // Open or create a file read-write, keeping its data and resizing it to Bytes
+    MapUpdate
+};
+
+static void InitMappedFile(MappedFile& file)
+{
+    file.Data = nullptr;
+    file.Bytes = 0;
+#if defined(_WIN32)
+    file.File = INVALID_HANDLE_VALUE;
+    file.Mapping = nullptr;
+#else
+    file.File = -1;
+#endif
+}
+
+static void UnmapFile(MappedFile& file)
+{
+#if defined(_WIN32)
+    if (file.Data)
+    {
+        UnmapViewOfFile(file.Data);
+    }
+    if (file.Mapping)
+    {
+        CloseHandle(file.Mapping);
+    }
+    if (file.File != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(file.File);
+    }
+#else
+    if (file.Data)
+    {
+        munmap(file.Data, (size_t)file.Bytes);
+    }
+    if (file.File >= 0)
+    {
+        close(file.File);
+    }
+#endif
+    InitMappedFile(file);
+}
+
+// Returns false if the file does not exist or cannot be queried
+static bool QueryFileBytes(const char* path, uint64_t& bytes)
+{
+#if defined(_WIN32)
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &info))
+    {
+        return false;
+    }
+    bytes = ((uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+#else
+    struct stat info;
+    if (stat(path, &info) != 0)
+    {
+        return false;
+    }
+    bytes = (uint64_t)info.st_size;
+#endif
+    return true;
+}
+
+// For MapUpdate 'bytes' is the new size, and otherwise the size is read from the file
+static bool MapFile(const char* path, MapMode mode, uint64_t bytes, MappedFile& file)
+{
+    InitMappedFile(file);
+
+#if defined(_WIN32)
+    const bool writable = (mode != MapRead);
+    file.File = CreateFileA(path,
+        writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+        FILE_SHARE_READ, nullptr,
+        mode == MapUpdate ? OPEN_ALWAYS : OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file.File == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (mode != MapUpdate)
+    {
+        if (!GetFileSizeEx(file.File, &size))
+        {
+            UnmapFile(file);
+            return false;
+        }
+        bytes = (uint64_t)size.QuadPart;
+    }
+    else
+    {
+        size.QuadPart = (LONGLONG)bytes;
+        if (!SetFilePointerEx(file.File, size, nullptr, FILE_BEGIN) || !SetEndOfFile(file.File))
+        {
+            UnmapFile(file);
+            return false;
+        }
+    }
+    file.Bytes = bytes;
+
+    if (bytes == 0)
+    {
+        return true;
+    }
+    if (bytes > (uint64_t)SIZE_MAX)
+    {
+        UnmapFile(file);
+        return false;
+    }
+
+    file.Mapping = CreateFileMappingA(file.File, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+    if (file.Mapping)
+    {
+        file.Data = static_cast<uint8_t*>(MapViewOfFile(file.Mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+    }
+    if (!file.Data)
+    {
+        UnmapFile(file);
+        return false;
+    }
+#else
+    int flags = O_RDWR;
+    if (mode == MapRead)
+    {
+        flags = O_RDONLY;
+    }
+    else if (mode == MapUpdate)
+    {
+        flags |= O_CREAT;
+    }
+    file.File = open(path, flags, 0644);
+    if (file.File < 0)
+    {
+        return false;
+    }
+
+    if (mode != MapUpdate)
+    {
+        struct stat info;
+        if (fstat(file.File, &info) != 0)
+        {
+            UnmapFile(file);
+            return false;
+        }
+        bytes = (uint64_t)info.st_size;
+    }
+    else if (ftruncate(file.File, (off_t)bytes) != 0)
+    {
+        UnmapFile(file);
+        return false;
+    }
+
+    if (bytes == 0)
+    {
+        return true;
+    }
+    if (bytes > (uint64_t)SIZE_MAX)
+    {
+        UnmapFile(file);
+        return false;
+    }
+
+    void* data = mmap(nullptr, (size_t)bytes, mode == MapRead ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_SHARED, file.File, 0);
+    if (data == MAP_FAILED)
+    {
+        UnmapFile(file);
+        return false;
+    }
+    file.Data = static_cast<uint8_t*>(data);
+    file.Bytes = bytes;
+
+    // Stripes are visited roughly in file order
+    posix_madvise(data, (size_t)bytes, POSIX_MADV_SEQUENTIAL);
+#endif
+
+    return true;
+}
+
+// Create or truncate a file to be written with WriteFileAt()
+static bool CreateOutputFile(const char* path, MappedFile& file)
+{
+    InitMappedFile(file);
+
+#if defined(_WIN32)
+    file.File = CreateFileA(path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    return file.File != INVALID_HANDLE_VALUE;
+#else
+    file.File = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    return file.File >= 0;
+#endif
+}
+
+// Write at an offset without moving a shared file position, so workers may write at the same time
+static bool WriteFileAt(const MappedFile& file, uint64_t offset, const uint8_t* data, size_t bytes)
+{
+    while (bytes > 0)
+    {
+        // Keep each call within what both platforms accept
+        const size_t request = bytes < ((size_t)1 << 30) ? bytes : ((size_t)1 << 30);
+
+#if defined(_WIN32)
+        OVERLAPPED position;
+        memset(&position, 0, sizeof(position));
+        position.Offset = (DWORD)offset;
+        position.OffsetHigh = (DWORD)(offset >> 32);
+        DWORD written = 0;
+        if (!WriteFile(file.File, data, (DWORD)request, &written, &position) || written == 0)
+        {
+            return false;
+        }
+#else
+        const ssize_t written = pwrite(file.File, data, request, (off_t)offset);
+        if (written <= 0)
+        {
+            return false;
+        }
+#endif
+
+        offset += (uint64_t)written;
+        data += written;
+        bytes -= (size_t)written;
+    }
+    return true;
+}
+
+// Ask the OS to start reading [offset, offset + bytes) of the file in the background
+static void PrefetchFile(const MappedFile& file, uint64_t offset, uint64_t bytes)
+{
+    if (!file.Data || offset >= file.Bytes)
+    {
+        return;
+    }
+    if (bytes > file.Bytes - offset)
+    {
+        bytes = file.Bytes - offset;
+    }
+
+#if defined(_WIN32)
+#if defined(_WIN32_WINNT) && (_WIN32_WINNT >= 0x0602)
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = file.Data + offset;
+    range.NumberOfBytes = (SIZE_T)bytes;
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+#else
+    // The advice must start on a page boundary
+    const uint64_t pageBytes = (uint64_t)sysconf(_SC_PAGESIZE);
+    const uint64_t start = offset - offset % pageBytes;
+    posix_madvise(file.Data + start, (size_t)(offset + bytes - start), POSIX_MADV_WILLNEED);
+#endif
+}
+
+// Write the mapped or written data and the file size to disk
+static bool FlushFile(const MappedFile& file)
+{
+#if defined(_WIN32)
+    if (file.Data && !FlushViewOfFile(file.Data, 0))
+    {
+        return false;
+    }
+    return FlushFileBuffers(file.File) != 0;
+#else
+    if (file.Data && msync(file.Data, (size_t)file.Bytes, MS_SYNC) != 0)
+    {
+        return false;
+    }
+    return fsync(file.File) == 0;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// Shard Header
+
+/*
+    A shard is the header, then recovery block j of every stripe, then the
+    gf256_crc32c() of each of those blocks as a u32 per stripe.
+
+    The header is little-endian:
+
+        0: "CM256REC"
+        8: Format version (u32)
+       12: OriginalCount (u32)
+       16: RecoveryCount (u32)
+       20: BlockBytes (u32)
+       24: Recovery block index of the shard (u32)
+       28: Zero (u32)
+       32: Size of the protected file in bytes (u64)
+       40: Zeros
+       60: gf256_crc32c() of bytes 0..59 (u32)
+*/
+
+static const uint8_t kHeaderMagic[8] = { 'C', 'M', '2', '5', '6', 'R', 'E', 'C' };
+static const uint32_t kHeaderVersion = 2;
+static const int kHeaderCRCOffset = CM256_FILE_HEADER_BYTES - 4;
+
+static void WriteU32(uint8_t* p, uint32_t x)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        p[i] = (uint8_t)(x >> (i * 8));
+    }
+}
+
+static uint32_t ReadU32(const uint8_t* p)
+{
+    uint32_t x = 0;
+    for (int i = 3; i >= 0; --i)
+    {
+        x = (x << 8) | p[i];
+    }
+    return x;
+}
+
+static void WriteU64(uint8_t* p, uint64_t x)
+{
+    WriteU32(p, (uint32_t)x);
+    WriteU32(p + 4, (uint32_t)(x >> 32));
+}
+
+static uint64_t ReadU64(const uint8_t* p)
+{
+    return ReadU32(p) | ((uint64_t)ReadU32(p + 4) << 32);
+}
+
+struct ShardHeader
+{
+    cm256_encoder_params Params;
+    int RecoveryIndex;
+    uint64_t FileBytes;
+};
+
+static void WriteShardHeader(uint8_t* p, const ShardHeader& header)
+{
+    memset(p, 0, CM256_FILE_HEADER_BYTES);
+    memcpy(p, kHeaderMagic, sizeof(kHeaderMagic));
+    WriteU32(p + 8, kHeaderVersion);
+    WriteU32(p + 12, (uint32_t)header.Params.OriginalCount);
+    WriteU32(p + 16, (uint32_t)header.Params.RecoveryCount);
+    WriteU32(p + 20, (uint32_t)header.Params.BlockBytes);
+    WriteU32(p + 24, (uint32_t)header.RecoveryIndex);
+    WriteU64(p + 32, header.FileBytes);
+    WriteU32(p + kHeaderCRCOffset, gf256_crc32c(0, p, kHeaderCRCOffset));
+}
+
+// Returns false if the header is damaged or from another version
+static bool ReadShardHeader(const uint8_t* p, uint64_t fileBytes, ShardHeader& header)
+{
+    if (fileBytes < CM256_FILE_HEADER_BYTES ||
+        0 != memcmp(p, kHeaderMagic, sizeof(kHeaderMagic)) ||
+        ReadU32(p + 8) != kHeaderVersion ||
+        ReadU32(p + kHeaderCRCOffset) != gf256_crc32c(0, p, kHeaderCRCOffset))
+    {
+        return false;
+    }
+
+    const uint32_t originalCount = ReadU32(p + 12);
+    const uint32_t recoveryCount = ReadU32(p + 16);
+    const uint32_t blockBytes = ReadU32(p + 20);
+    const uint32_t recoveryIndex = ReadU32(p + 24);
+    if (originalCount == 0 || recoveryCount == 0 ||
+        originalCount + recoveryCount > 256 ||
+        blockBytes == 0 || blockBytes > 0x7fffffff ||
+        recoveryIndex >= recoveryCount)
+    {
+        return false;
+    }
+
+    header.Params.OriginalCount = (int)originalCount;
+    header.Params.RecoveryCount = (int)recoveryCount;
+    header.Params.BlockBytes = (int)blockBytes;
+    header.RecoveryIndex = (int)recoveryIndex;
+    header.FileBytes = ReadU64(p + 32);
+    return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// Pipeline
+
+/*
+    Workers take windows of consecutive stripes from a shared counter, so
+    the stripes are visited close to file order and every worker stays busy
+    when some windows take longer.  Before starting a window, a worker
+    prefetches the window that is TaskCount ahead, which is the next one it
+    is likely to take after every worker finishes its current window.
+*/
+
+// Input bytes per window
+static const uint64_t kWindowBytes = 8 * 1024 * 1024;
+
+struct FilePipeline
+{
+    // Stripe parameters
+    cm256_encoder_params Params;
+    uint64_t FileBytes;
+    uint64_t StripeBytes;
+    uint64_t StripeCount;
+    uint64_t WindowStripes;
+    uint64_t WindowCount;
+    int TaskCount;
+
+    // Input file, and bytes of it that survived truncation for repair
+    MappedFile Input;
+    uint64_t PresentBytes;
+
+    // Shard files by recovery block index
+    MappedFile Shards[256];
+    bool ShardValid[256];
+    bool ShardRebuild[256];
+    int RebuildCount;
+
+    // Ranges of the input to repair
+    const cm256_file_range* Damaged;
+    int DamagedCount;
+
+    // Shared encoder for the encode pipeline
+    cm256_encoder_ctx* Encoder;
+
+    // Checksum tables of the shards being written, one after another
+    uint8_t* CRCTables;
+
+    std::atomic<uint64_t> NextWindow;
+    std::atomic<int> Result;
+    std::atomic<uint64_t> DataBlocksRepaired;
+    std::atomic<uint64_t> RecoveryBlocksRepaired;
+};
+
+static void InitPipeline(FilePipeline& pipe, cm256_encoder_params params, uint64_t fileBytes)
+{
+    pipe.Params = params;
+    pipe.FileBytes = fileBytes;
+    pipe.StripeBytes = (uint64_t)params.OriginalCount * params.BlockBytes;
+    pipe.StripeCount = 0;
+    if (pipe.StripeBytes > 0)
+    {
+        pipe.StripeCount = (fileBytes + pipe.StripeBytes - 1) / pipe.StripeBytes;
+    }
+    pipe.WindowStripes = pipe.StripeBytes > 0 ? kWindowBytes / pipe.StripeBytes : 1;
+    if (pipe.WindowStripes < 1)
+    {
+        pipe.WindowStripes = 1;
+    }
+    pipe.WindowCount = (pipe.StripeCount + pipe.WindowStripes - 1) / pipe.WindowStripes;
+    pipe.TaskCount = 1;
+
+    InitMappedFile(pipe.Input);
+    pipe.PresentBytes = fileBytes;
+    for (int i = 0; i < 256; ++i)
+    {
+        InitMappedFile(pipe.Shards[i]);
+        pipe.ShardValid[i] = false;
+        pipe.ShardRebuild[i] = false;
+    }
+    pipe.RebuildCount = 0;
+    pipe.Damaged = nullptr;
+    pipe.DamagedCount = 0;
+    pipe.Encoder = nullptr;
+    pipe.CRCTables = nullptr;
+    pipe.NextWindow = 0;
+    pipe.Result = 0;
+    pipe.DataBlocksRepaired = 0;
+    pipe.RecoveryBlocksRepaired = 0;
+}
+
+static void ClosePipeline(FilePipeline& pipe)
+{
+    UnmapFile(pipe.Input);
+    for (int i = 0; i < 256; ++i)
+    {
+        UnmapFile(pipe.Shards[i]);
+    }
+    cm256_encoder_free(pipe.Encoder);
+    delete[] pipe.CRCTables;
+}
+
+static uint64_t GetShardCRCOffset(const FilePipeline& pipe)
+{
+    return CM256_FILE_HEADER_BYTES + pipe.StripeCount * pipe.Params.BlockBytes;
+}
+
+static uint64_t GetShardFileBytes(const FilePipeline& pipe)
+{
+    return GetShardCRCOffset(pipe) + pipe.StripeCount * 4;
+}
+
+static uint64_t GetShardOffset(const FilePipeline& pipe, uint64_t stripe)
+{
+    return CM256_FILE_HEADER_BYTES + stripe * pipe.Params.BlockBytes;
+}
+
+static uint8_t* GetShardBlock(FilePipeline& pipe, int recoveryIndex, uint64_t stripe)
+{
+    return pipe.Shards[recoveryIndex].Data + GetShardOffset(pipe, stripe);
+}
+
+// Checksum entry of a block in either a mapped shard or a table being written
+static uint8_t* GetShardCRC(FilePipeline& pipe, int recoveryIndex, uint64_t stripe)
+{
+    if (pipe.CRCTables && !pipe.ShardValid[recoveryIndex])
+    {
+        return pipe.CRCTables + (recoveryIndex * pipe.StripeCount + stripe) * 4;
+    }
+    return pipe.Shards[recoveryIndex].Data + GetShardCRCOffset(pipe) + stripe * 4;
+}
+
+// Returns true if the block of a mapped shard matches its checksum
+static bool CheckShardBlock(FilePipeline& pipe, int recoveryIndex, uint64_t stripe)
+{
+    const uint32_t crc = gf256_crc32c(0, GetShardBlock(pipe, recoveryIndex, stripe), pipe.Params.BlockBytes);
+    return crc == ReadU32(GetShardCRC(pipe, recoveryIndex, stripe));
+}
+
+// Allocate the checksum tables of the shards that will be written
+static void AllocateCRCTables(FilePipeline& pipe)
+{
+    pipe.CRCTables = new uint8_t[(size_t)(pipe.Params.RecoveryCount * pipe.StripeCount * 4)];
+}
+
+// Write the checksum table of a shard after its last block
+static bool WriteCRCTable(FilePipeline& pipe, int recoveryIndex)
+{
+    const size_t bytes = (size_t)(pipe.StripeCount * 4);
+    return WriteFileAt(pipe.Shards[recoveryIndex], GetShardCRCOffset(pipe),
+                       pipe.CRCTables + recoveryIndex * bytes, bytes);
+}
+
+// Create a shard file and write its header
+static bool CreateShard(FilePipeline& pipe, const char* path, int recoveryIndex)
+{
+    ShardHeader header;
+    header.Params = pipe.Params;
+    header.RecoveryIndex = recoveryIndex;
+    header.FileBytes = pipe.FileBytes;
+
+    uint8_t headerData[CM256_FILE_HEADER_BYTES];
+    WriteShardHeader(headerData, header);
+
+    return CreateOutputFile(path, pipe.Shards[recoveryIndex]) &&
+           WriteFileAt(pipe.Shards[recoveryIndex], 0, headerData, sizeof(headerData));
+}
+
+// Take the next window of stripes [first, end), or return false when there are none left or a worker failed
+static bool TakeWindow(FilePipeline& pipe, bool prefetchShards, uint64_t& first, uint64_t& end)
+{
+    const uint64_t window = pipe.NextWindow++;
+    if (window >= pipe.WindowCount || pipe.Result != 0)
+    {
+        return false;
+    }
+
+    first = window * pipe.WindowStripes;
+    end = first + pipe.WindowStripes;
+    if (end > pipe.StripeCount)
+    {
+        end = pipe.StripeCount;
+    }
+
+    const uint64_t ahead = first + (uint64_t)pipe.TaskCount * pipe.WindowStripes;
+    if (ahead < pipe.StripeCount)
+    {
+        PrefetchFile(pipe.Input, ahead * pipe.StripeBytes, pipe.WindowStripes * pipe.StripeBytes);
+
+        for (int j = 0; prefetchShards && j < pipe.Params.RecoveryCount; ++j)
+        {
+            if (pipe.ShardValid[j])
+            {
+                PrefetchFile(pipe.Shards[j], CM256_FILE_HEADER_BYTES + ahead * pipe.Params.BlockBytes,
+                             pipe.WindowStripes * pipe.Params.BlockBytes);
+            }
+        }
+    }
+
+    return true;
+}
+
+// Point blocks[] at the originals of the stripe.  The last stripe of the file
+// is copied into 'staging' and padded with zeros.
+static void GetStripeOriginals(FilePipeline& pipe, uint64_t stripe, uint8_t* staging, cm256_block* blocks)
+{
+    const uint64_t offset = stripe * pipe.StripeBytes;
+    uint8_t* data = pipe.Input.Data + offset;
+
+    if (pipe.FileBytes - offset < pipe.StripeBytes)
+    {
+        const size_t tailBytes = (size_t)(pipe.FileBytes - offset);
+        memcpy(staging, data, tailBytes);
+        memset(staging + tailBytes, 0, (size_t)pipe.StripeBytes - tailBytes);
+        data = staging;
+    }
+
+    for (int i = 0; i < pipe.Params.OriginalCount; ++i)
+    {
+        blocks[i].Block = data + (size_t)i * pipe.Params.BlockBytes;
+        blocks[i].Index = cm256_get_original_block_index(pipe.Params, i);
+    }
+}
+
+// Run task(pipe, i) for i in [0, TaskCount) as cm256_encode_mt() does
+static void RunPipeline(FilePipeline& pipe, const cm256_threading* threading, cm256_task_fn task)
+{
+    pipe.TaskCount = 1;
+    if (threading && threading->ThreadCount > 1)
+    {
+        pipe.TaskCount = threading->ThreadCount;
+    }
+    if ((uint64_t)pipe.TaskCount > pipe.WindowCount)
+    {
+        pipe.TaskCount = pipe.WindowCount > 0 ? (int)pipe.WindowCount : 1;
+    }
+
+    // Workers take windows until none are left, so tasks may run in any order
+    cm256_run_tasks(threading, task, &pipe, pipe.TaskCount);
+}
+
+
+//-----------------------------------------------------------------------------
+// Encode
+
+static void EncodeTask(void* taskContext, int /*taskIndex*/)
+{
+    FilePipeline& pipe = *static_cast<FilePipeline*>(taskContext);
+    const cm256_encoder_params& params = pipe.Params;
+
+    const size_t blockBytes = (size_t)params.BlockBytes;
+
+    // Space for the last stripe and the recovery blocks of one stripe
+    uint8_t* staging = nullptr;
+    uint8_t* recovery = new uint8_t[blockBytes * params.RecoveryCount];
+
+    cm256_block blocks[256];
+    uint64_t first, end;
+
+    while (TakeWindow(pipe, false, first, end))
+    {
+        for (uint64_t stripe = first; stripe < end; ++stripe)
+        {
+            if (stripe == pipe.StripeCount - 1 && !staging)
+            {
+                staging = new uint8_t[(size_t)pipe.StripeBytes];
+            }
+            GetStripeOriginals(pipe, stripe, staging, blocks);
+
+            const int encodeResult = cm256_encoder_encode(pipe.Encoder, blocks, recovery);
+            if (encodeResult != 0)
+            {
+                pipe.Result = encodeResult;
+                break;
+            }
+
+            for (int j = 0; j < params.RecoveryCount; ++j)
+            {
+                // Checksum each recovery block while it is still in cache
+                const uint8_t* block = recovery + j * blockBytes;
+                WriteU32(GetShardCRC(pipe, j, stripe), gf256_crc32c(0, block, params.BlockBytes));
+
+                if (!WriteFileAt(pipe.Shards[j], GetShardOffset(pipe, stripe), block, blockBytes))
+                {
+                    pipe.Result = -12;
+                    break;
+                }
+            }
+            if (pipe.Result != 0)
+            {
+                break;
+            }
+        }
+    }
+
+    delete[] staging;
+    delete[] recovery;
+}
+
+extern "C" int cm256_file_encode(
+    cm256_encoder_params params,      // Encoder parameters
+    const char* inputPath,            // File to protect
+    const char* const* recoveryPaths, // Output path of each recovery shard
+    const cm256_threading* threading) // Optional threading options
+{
+    cm256_encoder_ctx* encoder = nullptr;
+    const int createResult = cm256_encoder_create(params, &encoder);
+    if (createResult != 0)
+    {
+        return createResult;
+    }
+    if (!inputPath || !recoveryPaths)
+    {
+        cm256_encoder_free(encoder);
+        return -3;
+    }
+    for (int j = 0; j < params.RecoveryCount; ++j)
+    {
+        if (!recoveryPaths[j])
+        {
+            cm256_encoder_free(encoder);
+            return -3;
+        }
+    }
+
+    int result = 0;
+    MappedFile input;
+    if (!MapFile(inputPath, MapRead, 0, input))
+    {
+        result = -12;
+    }
+
+    FilePipeline* pipe = new FilePipeline;
+    InitPipeline(*pipe, params, input.Bytes);
+    pipe->Input = input;
+    pipe->Encoder = encoder;
+
+    for (int j = 0; result == 0 && j < params.RecoveryCount; ++j)
+    {
+        if (!CreateShard(*pipe, recoveryPaths[j], j))
+        {
+            result = -12;
+        }
+    }
+
+    if (result == 0)
+    {
+        AllocateCRCTables(*pipe);
+        RunPipeline(*pipe, threading, EncodeTask);
+        result = pipe->Result;
+    }
+
+    for (int j = 0; result == 0 && j < params.RecoveryCount; ++j)
+    {
+        if (!WriteCRCTable(*pipe, j) || !FlushFile(pipe->Shards[j]))
+        {
+            result = -12;
+        }
+    }
+
+    ClosePipeline(*pipe);
+    delete pipe;
+    return result;
+}
+
+
+//-----------------------------------------------------------------------------
+// Repair
+
+extern "C" int cm256_file_read_header(
+    const char* recoveryPath,     // Recovery shard file
+    cm256_encoder_params* params, // Output encoder parameters
+    int* recoveryIndex,           // Output recovery block index of the shard, from 0
+    uint64_t* fileBytes)          // Output size of the protected file
+{
+    if (!recoveryPath)
+    {
+        return -3;
+    }
+
+    MappedFile file;
+    if (!MapFile(recoveryPath, MapRead, 0, file))
+    {
+        return -12;
+    }
+
+    ShardHeader header;
+    const bool valid = ReadShardHeader(file.Data, file.Bytes, header);
+    UnmapFile(file);
+    if (!valid)
+    {
+        return -13;
+    }
+
+    if (params)
+    {
+        *params = header.Params;
+    }
+    if (recoveryIndex)
+    {
+        *recoveryIndex = header.RecoveryIndex;
+    }
+    if (fileBytes)
+    {
+        *fileBytes = header.FileBytes;
+    }
+    return 0;
+}
+
+// Mark the originals of the stripe that must be rewritten, and return how many there are
+static int GetStripeErasures(const FilePipeline& pipe, uint64_t stripe, bool* erased)
+{
+    int erasedCount = 0;
+
+    for (int i = 0; i < pipe.Params.OriginalCount; ++i)
+    {
+        const uint64_t start = stripe * pipe.StripeBytes + (uint64_t)i * pipe.Params.BlockBytes;
+        uint64_t end = start + pipe.Params.BlockBytes;
+        if (end > pipe.FileBytes)
+        {
+            end = pipe.FileBytes;
+        }
+
+        // Blocks past the end of the file are zero padding that is never lost
+        bool lost = false;
+        if (start < end)
+        {
+            lost = end > pipe.PresentBytes;
+            for (int r = 0; r < pipe.DamagedCount && !lost; ++r)
+            {
+                const cm256_file_range& range = pipe.Damaged[r];
+                lost = range.Offset < end && (range.Offset <= start ? start - range.Offset < range.Bytes : range.Bytes > 0);
+            }
+        }
+
+        erased[i] = lost;
+        erasedCount += lost ? 1 : 0;
+    }
+
+    return erasedCount;
+}
+
+static void RepairTask(void* taskContext, int /*taskIndex*/)
+{
+    FilePipeline& pipe = *static_cast<FilePipeline*>(taskContext);
+    const cm256_encoder_params& params = pipe.Params;
+    const size_t blockBytes = (size_t)params.BlockBytes;
+
+    // Space for the last stripe and the originals decoded for it, and for the rebuilt recovery blocks
+    uint8_t* staging = nullptr;
+    uint8_t* stagingOutputs = nullptr;
+    uint8_t* rebuilt = new uint8_t[blockBytes * params.RecoveryCount];
+
+    cm256_block blocks[256];
+    bool erased[256];
+    bool corrupt[256];
+    void* outputs[256];
+    unsigned char targets[256];
+    uint64_t first, end;
+
+    while (TakeWindow(pipe, pipe.RebuildCount > 0, first, end))
+    {
+        for (uint64_t stripe = first; stripe < end; ++stripe)
+        {
+            const int erasedCount = GetStripeErasures(pipe, stripe, erased);
+            if (erasedCount == 0 && pipe.RebuildCount == 0)
+            {
+                continue;
+            }
+
+            const bool lastStripe = (stripe == pipe.StripeCount - 1);
+            if (lastStripe && !staging)
+            {
+                staging = new uint8_t[(size_t)pipe.StripeBytes];
+                stagingOutputs = new uint8_t[(size_t)pipe.StripeBytes];
+            }
+            GetStripeOriginals(pipe, stripe, staging, blocks);
+
+            // Replace erased originals with the valid shards in order, skipping
+            // blocks that fail their checksums so they are rewritten below
+            int shard = 0;
+            int corruptCount = 0;
+            for (int j = 0; j < params.RecoveryCount; ++j)
+            {
+                corrupt[j] = false;
+            }
+            for (int i = 0; i < params.OriginalCount; ++i)
+            {
+                if (!erased[i])
+                {
+                    continue;
+                }
+                while (shard < params.RecoveryCount &&
+                       !(pipe.ShardValid[shard] && CheckShardBlock(pipe, shard, stripe)))
+                {
+                    if (pipe.ShardValid[shard])
+                    {
+                        corrupt[shard] = true;
+                        ++corruptCount;
+                    }
+                    ++shard;
+                }
+                if (shard >= params.RecoveryCount)
+                {
+                    // Not expected, since cm256_file_repair() checked these blocks
+                    pipe.Result = -13;
+                    break;
+                }
+
+                blocks[i].Block = GetShardBlock(pipe, shard, stripe);
+                blocks[i].Index = cm256_get_recovery_block_index(params, shard);
+                outputs[i] = lastStripe ? stagingOutputs + i * blockBytes
+                                        : pipe.Input.Data + stripe * pipe.StripeBytes + i * blockBytes;
+                ++shard;
+            }
+            if (pipe.Result != 0)
+            {
+                break;
+            }
+
+            if (erasedCount > 0)
+            {
+                // The originals are decoded straight into the input mapping
+                const int decodeResult = cm256_decode_into(params, blocks, outputs);
+                if (decodeResult != 0)
+                {
+                    pipe.Result = decodeResult;
+                    break;
+                }
+
+                if (lastStripe)
+                {
+                    const uint64_t offset = stripe * pipe.StripeBytes;
+                    for (int i = 0; i < params.OriginalCount; ++i)
+                    {
+                        const uint64_t start = offset + i * blockBytes;
+                        if (erased[i])
+                        {
+                            const uint64_t bytes = pipe.FileBytes - start;
+                            memcpy(pipe.Input.Data + start, outputs[i], (size_t)(bytes < blockBytes ? bytes : blockBytes));
+                        }
+                    }
+                }
+
+                pipe.DataBlocksRepaired += (uint64_t)erasedCount;
+            }
+
+            if (pipe.RebuildCount > 0 || corruptCount > 0)
+            {
+                int targetCount = 0;
+                for (int j = 0; j < params.RecoveryCount; ++j)
+                {
+                    if (pipe.ShardRebuild[j] || corrupt[j])
+                    {
+                        targets[targetCount] = cm256_get_recovery_block_index(params, j);
+                        outputs[targetCount] = rebuilt + targetCount * blockBytes;
+                        ++targetCount;
+                    }
+                }
+
+                const int repairResult = cm256_repair(params, blocks, targets, targetCount, outputs);
+                if (repairResult != 0)
+                {
+                    pipe.Result = repairResult;
+                    break;
+                }
+
+                for (int t = 0; t < targetCount; ++t)
+                {
+                    const int j = targets[t] - params.OriginalCount;
+                    const uint8_t* block = rebuilt + t * blockBytes;
+                    WriteU32(GetShardCRC(pipe, j, stripe), gf256_crc32c(0, block, params.BlockBytes));
+
+                    // Corrupt blocks of valid shards are rewritten through the mapping
+                    if (corrupt[j])
+                    {
+                        memcpy(GetShardBlock(pipe, j, stripe), block, blockBytes);
+                    }
+                    else if (!WriteFileAt(pipe.Shards[j], GetShardOffset(pipe, stripe), block, blockBytes))
+                    {
+                        pipe.Result = -12;
+                        break;
+                    }
+                }
+
+                pipe.RecoveryBlocksRepaired += (uint64_t)corruptCount;
+            }
+        }
+    }
+
+    delete[] staging;
+    delete[] stagingOutputs;
+    delete[] rebuilt;
+}
+
+extern "C" int cm256_file_repair(
+    const char* inputPath,              // Protected file
+    const char* const* recoveryPaths,   // Path of each recovery shard
+    int recoveryCount,                  // Number of entries in 'recoveryPaths'
+    const cm256_file_range* damaged,    // Optional ranges of the input known to be damaged
+    int damagedCount,                   // Number of entries in 'damaged'
+    const cm256_threading* threading,   // Optional threading options
+    cm256_file_repair_result* resultOut) // Optional output summary
+{
+    if (resultOut)
+    {
+        resultOut->DataBlocksRepaired = 0;
+        resultOut->RecoveryBlocksRepaired = 0;
+        resultOut->RecoveryShardsRebuilt = 0;
+    }
+    if (!inputPath || !recoveryPaths || (damagedCount > 0 && !damaged))
+    {
+        return -3;
+    }
+    if (recoveryCount <= 0 || recoveryCount > 255 || damagedCount < 0)
+    {
+        return -1;
+    }
+    for (int j = 0; j < recoveryCount; ++j)
+    {
+        if (!recoveryPaths[j])
+        {
+            return -3;
+        }
+    }
+
+    // Read every shard header, and take the parameters from the first valid one
+    MappedFile* shards = new MappedFile[recoveryCount];
+    ShardHeader* headers = new ShardHeader[recoveryCount];
+    bool* valid = new bool[recoveryCount];
+    int reference = -1;
+
+    for (int j = 0; j < recoveryCount; ++j)
+    {
+        valid[j] = MapFile(recoveryPaths[j], MapModify, 0, shards[j]) &&
+                   ReadShardHeader(shards[j].Data, shards[j].Bytes, headers[j]) &&
+                   headers[j].RecoveryIndex == j;
+        if (valid[j] && reference < 0)
+        {
+            reference = j;
+        }
+    }
+
+    FilePipeline* pipe = new FilePipeline;
+    int result = 0;
+
+    if (reference < 0 || headers[reference].Params.RecoveryCount != recoveryCount)
+    {
+        result = -13;
+        InitPipeline(*pipe, cm256_encoder_params(), 0);
+    }
+    else
+    {
+        const ShardHeader& ref = headers[reference];
+        InitPipeline(*pipe, ref.Params, ref.FileBytes);
+
+        for (int j = 0; j < recoveryCount; ++j)
+        {
+            pipe->ShardValid[j] = valid[j] &&
+                                  0 == memcmp(&headers[j].Params, &ref.Params, sizeof(ref.Params)) &&
+                                  headers[j].FileBytes == ref.FileBytes &&
+                                  shards[j].Bytes == GetShardFileBytes(*pipe);
+            if (pipe->ShardValid[j])
+            {
+                pipe->Shards[j] = shards[j];
+            }
+            else
+            {
+                UnmapFile(shards[j]);
+                pipe->ShardRebuild[j] = true;
+                ++pipe->RebuildCount;
+            }
+        }
+
+        pipe->Damaged = damaged;
+        pipe->DamagedCount = damagedCount;
+    }
+
+    delete[] shards;
+    delete[] headers;
+    delete[] valid;
+
+    // Check that the input was not extended, and that every stripe can be repaired before writing
+    if (result == 0)
+    {
+        uint64_t presentBytes = 0;
+        if (!QueryFileBytes(inputPath, presentBytes))
+        {
+            presentBytes = 0;
+        }
+        if (presentBytes > pipe->FileBytes)
+        {
+            result = -13;
+        }
+        pipe->PresentBytes = presentBytes;
+    }
+
+    // The shard blocks that will replace lost originals are checked here too,
+    // so no shard is created or truncated for a repair that cannot finish
+    bool erased[256];
+    bool anyErased = false;
+    for (uint64_t stripe = 0; result == 0 && stripe < pipe->StripeCount; ++stripe)
+    {
+        const int erasedCount = GetStripeErasures(*pipe, stripe, erased);
+        int usableCount = 0;
+        for (int j = 0; j < recoveryCount && usableCount < erasedCount; ++j)
+        {
+            if (pipe->ShardValid[j] && CheckShardBlock(*pipe, j, stripe))
+            {
+                ++usableCount;
+            }
+        }
+        if (usableCount < erasedCount)
+        {
+            result = -13;
+        }
+        anyErased |= (erasedCount > 0);
+    }
+
+    if (result == 0 && (anyErased || pipe->RebuildCount > 0))
+    {
+        // Map the input read-write to repair it in place, restoring its size
+        const bool update = anyErased || pipe->PresentBytes != pipe->FileBytes;
+        if (!MapFile(inputPath, update ? MapUpdate : MapRead, pipe->FileBytes, pipe->Input))
+        {
+            result = -12;
+        }
+
+        for (int j = 0; result == 0 && j < recoveryCount; ++j)
+        {
+            if (pipe->ShardRebuild[j] && !CreateShard(*pipe, recoveryPaths[j], j))
+            {
+                result = -12;
+            }
+        }
+
+        if (result == 0)
+        {
+            if (pipe->RebuildCount > 0)
+            {
+                AllocateCRCTables(*pipe);
+            }
+            RunPipeline(*pipe, threading, RepairTask);
+            result = pipe->Result;
+        }
+
+        if (result == 0 && update && !FlushFile(pipe->Input))
+        {
+            result = -12;
+        }
+        for (int j = 0; result == 0 && j < recoveryCount; ++j)
+        {
+            if (pipe->ShardRebuild[j])
+            {
+                if (!WriteCRCTable(*pipe, j) || !FlushFile(pipe->Shards[j]))
+                {
+                    result = -12;
+                }
+            }
+            else if (pipe->RecoveryBlocksRepaired > 0 && !FlushFile(pipe->Shards[j]))
+            {
+                result = -12;
+            }
+        }
+    }
+
+    if (result == 0 && resultOut)
+    {
+        resultOut->DataBlocksRepaired = pipe->DataBlocksRepaired;
+        resultOut->RecoveryBlocksRepaired = pipe->RecoveryBlocksRepaired;
+        resultOut->RecoveryShardsRebuilt = pipe->RebuildCount;
+    }
+
+    ClosePipeline(*pipe);
+    delete pipe;
+    return result;
+}
@@ -0,0 +1,158 @@
+/*
+	Copyright (c) 2015 Christopher A. Taylor.  All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice,
+	  this list of conditions and the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice,
+	  this list of conditions and the following disclaimer in the documentation
+	  and/or other materials provided with the distribution.
+	* Neither the name of CM256 nor the names of its contributors may be
+	  used to endorse or promote products derived from this software without
+	  specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CM256_FILE_H
+#define CM256_FILE_H
+
+#include "cm256.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * File encode and repair pipeline
+ *
+ * Protects a file with 'recoveryCount' recovery shard files.  The file is
+ * cut into stripes of originalCount * blockBytes bytes, where original block
+ * i of stripe s is at file offset (s * originalCount + i) * blockBytes, and
+ * the last stripe is padded with zeros.  Recovery shard j holds recovery
+ * block j of every stripe end-to-end after a CM256_FILE_HEADER_BYTES header
+ * that records the parameters, the shard index and the file size, followed
+ * by a gf256_crc32c() of each of those blocks, 4 bytes per stripe.  Shard
+ * files are CM256_FILE_HEADER_BYTES + stripeCount * (blockBytes + 4) bytes.
+ *
+ * The input and the shards that are read are memory-mapped and encoded or
+ * decoded in place, so the input is not copied except for the last stripe,
+ * and repaired originals are written straight into the input mapping.  Each
+ * worker takes a window of stripes at a time and asks the OS to read ahead
+ * the window it will reach next, and writes recovery blocks to the shards
+ * with positioned writes that the OS writes back in the background.
+ * Reading, math and writing then overlap.  The files are flushed to disk
+ * before returning.
+ *
+ * The mappings cover whole files, so on 32-bit builds the files must fit in
+ * the address space.
+ *
+ * cm256_init() must be called first.  The threading options are the same as
+ * for cm256_encode_mt(), where each task processes windows until none are
+ * left, and may be null to use only the calling thread.
+ */
+
+// Bytes before the first recovery block of each shard file
+#define CM256_FILE_HEADER_BYTES 64
+
+// Range of bytes in the input file
+typedef struct cm256_file_range_t {
+    // Offset of the first byte
+    uint64_t Offset;
+
+    // Number of bytes
+    uint64_t Bytes;
+} cm256_file_range;
+
+// Summary of the work done by cm256_file_repair()
+typedef struct cm256_file_repair_result_t {
+    // Original blocks that were rewritten in the input file
+    uint64_t DataBlocksRepaired;
+
+    // Blocks of valid shards that failed their checksums and were rewritten
+    uint64_t RecoveryBlocksRepaired;
+
+    // Recovery shard files that were rewritten
+    int RecoveryShardsRebuilt;
+} cm256_file_repair_result;
+
+/*
+ * Write the recovery shards of a file.
+ * 'recoveryPaths' has params.RecoveryCount entries.  params.BlockBytes is
+ * the size of each block of a stripe, and 64 KB or more keeps the I/O large.
+ *
+ * Returns -12 if a file cannot be opened, sized, mapped, written or flushed.
+ * Returns 0 on success, and any other code indicates failure.
+ */
+extern int cm256_file_encode(
+    cm256_encoder_params params,       // Encoder parameters
+    const char* inputPath,             // File to protect
+    const char* const* recoveryPaths,  // Output path of each recovery shard
+    const cm256_threading* threading); // Optional threading options
+
+/*
+ * Read the header of a recovery shard file written by cm256_file_encode().
+ * Any output pointer may be null.
+ *
+ * Returns -12 if the file cannot be read, and -13 if it has no valid header.
+ * Returns 0 on success, and any other code indicates failure.
+ */
+extern int cm256_file_read_header(
+    const char* recoveryPath,     // Recovery shard file
+    cm256_encoder_params* params, // Output encoder parameters
+    int* recoveryIndex,           // Output recovery block index of the shard, from 0
+    uint64_t* fileBytes);         // Output size of the protected file
+
+/*
+ * Repair a file and its recovery shards.
+ *
+ * The parameters are read from the shard headers.  A shard that is missing,
+ * or whose header does not match the others or its position in
+ * 'recoveryPaths', or whose size is wrong, is rewritten.  Original blocks
+ * of the input that overlap a 'damaged' range, or that are missing because
+ * the file is shorter than when it was encoded, are rewritten in place.  A
+ * missing input file is created.
+ *
+ * The shards do not hold checksums of the input, so damage inside the
+ * input must be reported in 'damaged'.  Each shard block is checked against
+ * its checksum before it is used, and a block that fails is skipped in
+ * favor of the next valid shard and then rewritten in place.  Stripes with
+ * no damaged blocks are not read unless a shard is rewritten, so damage in
+ * shard blocks that are never used is not detected.
+ *
+ * Returns -12 if a file cannot be opened, sized, mapped, written or flushed.
+ * Returns -13 if no shard is valid, 'recoveryCount' does not match the
+ * shards, the input is longer than when it was encoded, or a stripe lost
+ * more blocks than there are valid shard blocks that pass their checksums.
+ * Nothing is written in this case.
+ * Returns 0 on success, and any other code indicates failure.
+ */
+extern int cm256_file_repair(
+    const char* inputPath,               // Protected file
+    const char* const* recoveryPaths,    // Path of each recovery shard
+    int recoveryCount,                   // Number of entries in 'recoveryPaths'
+    const cm256_file_range* damaged,     // Optional ranges of the input known to be damaged
+    int damagedCount,                    // Number of entries in 'damaged'
+    const cm256_threading* threading,    // Optional threading options
+    cm256_file_repair_result* resultOut); // Optional output summary
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // CM256_FILE_H
@@ -0,0 +1,596 @@
+/*
+	Copyright (c) 2015 Christopher A. Taylor.  All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice,
+	  this list of conditions and the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice,
+	  this list of conditions and the following disclaimer in the documentation
+	  and/or other materials provided with the distribution.
+	* Neither the name of CM256 nor the names of its contributors may be
+	  used to endorse or promote products derived from this software without
+	  specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cm65536.h"
+
+extern "C" int cm65536_init_(int version)
+{
+    if (version != CM65536_VERSION)
+    {
+        // User's header does not match library version
+        return -10;
+    }
+
+    // Return error code from GF(65536) init if required
+    return gf65536_init();
+}
+
+
+/*
+    Wide Cauchy Matrix
+
+    This is the matrix of cm256.cpp with x_i, y_j taken from GF(65536):
+
+        a_ij = (y_j + x_0) div (x_i + y_j)
+
+    The y_j values are the original indices 0...(originalCount - 1) and the
+    x_i values are the recovery indices from originalCount up, so the first
+    recovery row x_0 = originalCount is all ones.
+*/
+
+static GF256_FORCE_INLINE uint16_t GetMatrixElement(uint16_t x_i, uint16_t x_0, uint16_t y_j)
+{
+    return gf65536_div(gf65536_add(y_j, x_0), gf65536_add(x_i, y_j));
+}
+
+static int ValidateParams(const cm65536_encoder_params& params)
+{
+    if (params.OriginalCount <= 0 ||
+        params.RecoveryCount <= 0 ||
+        params.BlockBytes <= 0 ||
+        (params.BlockBytes & 1) != 0)
+    {
+        return -1;
+    }
+    if (params.OriginalCount + params.RecoveryCount > 65536)
+    {
+        return -2;
+    }
+    return 0;
+}
+
+/*
+    Tiled Passes
+
+    With thousands of originals, one strip of every original no longer fits
+    in cache the way it does for cm256.  Instead each pass reads one strip of
+    one input at a time and applies it to the same strip of every output row,
+    so the strip width is chosen to keep one strip of every output in cache.
+    Each input byte is then read from memory about once per pass.
+*/
+
+// Cache budget for one strip of every output row
+static const int kTileCacheBytes = 256 * 1024;
+
+// Smallest strip worth rebuilding the product tables of every element for
+static const int kTileMinBytes = 1024;
+
+// Strips are cut on cache line boundaries, which also keeps them a whole number of words
+static const int kTileAlignBytes = 64;
+
+// Returns the strip width for passes that write 'rows' output rows
+static int GetTileBytes(int blockBytes, int rows)
+{
+    int tileBytes = kTileCacheBytes / (rows + 1);
+    tileBytes -= tileBytes % kTileAlignBytes;
+
+    if (tileBytes < kTileMinBytes)
+    {
+        tileBytes = kTileMinBytes;
+    }
+
+    return tileBytes < blockBytes ? tileBytes : blockBytes;
+}
+
+
+//-----------------------------------------------------------------------------
+// Encoder
+
+// Encode the byte range [offset, offset + bytes) of every recovery block
+static void EncodeRange(
+    const cm65536_encoder_params& params, // Encoder parameters
+    const cm65536_block* originals,       // Array of pointers to original blocks
+    uint8_t* recoveryData,                // Output recovery blocks end-to-end, not offset
+    int offset,                           // Byte offset into each block
+    int bytes)                            // Number of bytes to produce
+{
+    const uint16_t x_0 = static_cast<uint16_t>(params.OriginalCount);
+
+    // For each original data column,
+    for (int j = 0; j < params.OriginalCount; ++j)
+    {
+        const uint8_t* original = static_cast<const uint8_t*>(originals[j].Block) + offset;
+        const uint16_t y_j = static_cast<uint16_t>(j);
+        uint8_t* recoveryBlock = recoveryData + offset;
+
+        // Add its products into this strip of every recovery row while it is in cache
+        for (int i = 0; i < params.RecoveryCount; ++i, recoveryBlock += params.BlockBytes)
+        {
+            // The first row is a parity, and a single original is copied as-is
+            if (i == 0 || params.OriginalCount == 1)
+            {
+                if (j == 0)
+                {
+                    memcpy(recoveryBlock, original, bytes);
+                }
+                else
+                {
+                    gf256_add_mem(recoveryBlock, original, bytes);
+                }
+                continue;
+            }
+
+            const uint16_t x_i = static_cast<uint16_t>(params.OriginalCount + i);
+            const uint16_t a_ij = GetMatrixElement(x_i, x_0, y_j);
+
+            if (j == 0)
+            {
+                gf65536_mul_mem(recoveryBlock, original, a_ij, bytes);
+            }
+            else
+            {
+                gf65536_muladd_mem(recoveryBlock, a_ij, original, bytes);
+            }
+        }
+    }
+}
+
+extern "C" int cm65536_encode(
+    cm65536_encoder_params params, // Encoder parameters
+    cm65536_block* originals,      // Array of pointers to original blocks
+    void* recoveryBlocks)          // Output recovery blocks end-to-end
+{
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+    if (!originals || !recoveryBlocks)
+    {
+        return -3;
+    }
+
+    uint8_t* recoveryData = static_cast<uint8_t*>(recoveryBlocks);
+    const int tileBytes = GetTileBytes(params.BlockBytes, params.RecoveryCount);
+
+    // For each strip of the blocks,
+    for (int offset = 0; offset < params.BlockBytes; offset += tileBytes)
+    {
+        int bytes = params.BlockBytes - offset;
+        if (bytes > tileBytes)
+        {
+            bytes = tileBytes;
+        }
+
+        EncodeRange(params, originals, recoveryData, offset, bytes);
+    }
+
+    return 0;
+}
+
+extern "C" void cm65536_encode_block(
+    cm65536_encoder_params params, // Encoder parameters
+    cm65536_block* originals,      // Array of pointers to original blocks
+    int recoveryBlockIndex,        // Return value from cm65536_get_recovery_block_index()
+    void* recoveryBlock)           // Output recovery block
+{
+    const uint16_t x_0 = static_cast<uint16_t>(params.OriginalCount);
+    const uint16_t x_i = static_cast<uint16_t>(recoveryBlockIndex);
+
+    memcpy(recoveryBlock, originals[0].Block, params.BlockBytes);
+
+    // If only one block of input data, it is repeated
+    if (params.OriginalCount == 1)
+    {
+        return;
+    }
+
+    // The first row is all ones, so its first column needs no multiply either
+    if (x_i != x_0)
+    {
+        gf65536_mul_mem_inplace(recoveryBlock, GetMatrixElement(x_i, x_0, 0), params.BlockBytes);
+    }
+
+    for (int j = 1; j < params.OriginalCount; ++j)
+    {
+        const uint16_t y_j = static_cast<uint16_t>(j);
+        const uint16_t a_ij = (x_i == x_0) ? 1 : GetMatrixElement(x_i, x_0, y_j);
+
+        gf65536_muladd_mem(recoveryBlock, a_ij, originals[j].Block, params.BlockBytes);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Decoder
+
+/*
+    This is the decoder of cm256.cpp widened to 16-bit row indices: the
+    received originals are eliminated from the received recovery rows, and
+    the remaining N x N Cauchy system is solved with the same G = L * D * U
+    decomposition.  The arrays are sized for the parameters at runtime since
+    N may be in the thousands.
+*/
+
+struct CM65536Decoder
+{
+    // Encode parameters
+    cm65536_encoder_params Params;
+
+    // Recovery blocks
+    cm65536_block** Recovery;
+    int RecoveryCount;
+
+    // Original blocks
+    cm65536_block** Original;
+    int OriginalCount;
+
+    // Row indices that were erased
+    uint16_t* ErasuresIndices;
+
+    // Decomposition G = L * D * U, set by PrepareDecode()
+    uint16_t* Matrix;
+
+    CM65536Decoder() : Recovery(nullptr), RecoveryCount(0), Original(nullptr), OriginalCount(0),
+                       ErasuresIndices(nullptr), Matrix(nullptr) {}
+    ~CM65536Decoder()
+    {
+        delete[] Recovery;
+        delete[] Original;
+        delete[] ErasuresIndices;
+        delete[] Matrix;
+    }
+
+    // Initialize the decoder, or return false if a block index repeats or is out of range
+    bool Initialize(const cm65536_encoder_params& params, cm65536_block* blocks);
+
+    // Generate the decomposition for the erased rows
+    void PrepareDecode();
+
+    // Eliminate the received originals from every recovery row over [offset, offset + bytes)
+    void EliminateRange(int offset, int bytes);
+
+    // Solve for the byte range [offset, offset + bytes) of each block after eliminating the originals
+    void SolveRange(int offset, int bytes);
+
+    // Decode every erased row
+    void Decode();
+
+private:
+    void GenerateLDUDecomposition(uint16_t* matrix_L, uint16_t* diag_D, uint16_t* matrix_U);
+};
+
+bool CM65536Decoder::Initialize(const cm65536_encoder_params& params, cm65536_block* blocks)
+{
+    Params = params;
+
+    const int K = params.OriginalCount;
+    const int rowCount = params.OriginalCount + params.RecoveryCount;
+
+    Recovery = new cm65536_block*[K];
+    Original = new cm65536_block*[K];
+    ErasuresIndices = new uint16_t[K];
+
+    // Marks each row index that has been received
+    uint8_t* received = new uint8_t[rowCount];
+    memset(received, 0, rowCount);
+
+    bool success = true;
+
+    // For each input block,
+    for (int ii = 0; ii < K; ++ii)
+    {
+        cm65536_block* block = blocks + ii;
+        const int row = block->Index;
+
+        // Error out if a row index repeats or does not exist
+        if (row >= rowCount || received[row])
+        {
+            success = false;
+            break;
+        }
+        received[row] = 1;
+
+        if (row < K)
+        {
+            Original[OriginalCount++] = block;
+        }
+        else
+        {
+            Recovery[RecoveryCount++] = block;
+        }
+    }
+
+    // Identify erasures
+    for (int ii = 0, indexCount = 0; success && indexCount < RecoveryCount; ++ii)
+    {
+        if (!received[ii])
+        {
+            ErasuresIndices[indexCount++] = static_cast<uint16_t>(ii);
+        }
+    }
+
+    delete[] received;
+    return success;
+}
+
+// Generate the LU decomposition of the matrix; see CM256Decoder::GenerateLDUDecomposition()
+void CM65536Decoder::GenerateLDUDecomposition(uint16_t* matrix_L, uint16_t* diag_D, uint16_t* matrix_U)
+{
+    // Matrix size NxN
+    const int N = RecoveryCount;
+
+    // Generators, and a temporary buffer for the rotated row of U
+    uint16_t* g = new uint16_t[N * 3];
+    uint16_t* b = g + N;
+    uint16_t* rotated_row_U = b + N;
+    for (int i = 0; i < N; ++i)
+    {
+        g[i] = 1;
+        b[i] = 1;
+    }
+
+    uint16_t* last_U = matrix_U + ((N - 1) * N) / 2 - 1;
+    int firstOffset_U = 0;
+
+    const uint16_t x_0 = static_cast<uint16_t>(Params.OriginalCount);
+
+    for (int k = 0; k < N - 1; ++k)
+    {
+        const uint16_t x_k = Recovery[k]->Index;
+        const uint16_t y_k = ErasuresIndices[k];
+
+        // D_kk = (x_k + y_k)
+        // L_kk = g[k] / (x_k + y_k)
+        // U_kk = b[k] * (x_0 + y_k) / (x_k + y_k)
+        const uint16_t D_kk = gf65536_add(x_k, y_k);
+        const uint16_t L_kk = gf65536_div(g[k], D_kk);
+        const uint16_t U_kk = gf65536_mul(gf65536_div(b[k], D_kk), gf65536_add(x_0, y_k));
+
+        // diag_D[k] = D_kk * L_kk * U_kk
+        diag_D[k] = gf65536_mul(D_kk, gf65536_mul(L_kk, U_kk));
+
+        // Computing the k-th row of L and U
+        uint16_t* row_L = matrix_L;
+        uint16_t* row_U = rotated_row_U;
+        for (int j = k + 1; j < N; ++j)
+        {
+            const uint16_t x_j = Recovery[j]->Index;
+            const uint16_t y_j = ErasuresIndices[j];
+
+            // L_jk = g[j] / (x_j + y_k)
+            // U_kj = b[j] / (x_k + y_j)
+            *matrix_L++ = gf65536_div(g[j], gf65536_add(x_j, y_k));
+            *row_U++ = gf65536_div(b[j], gf65536_add(x_k, y_j));
+
+            // g[j] = g[j] * (x_j + x_k) / (x_j + y_k)
+            // b[j] = b[j] * (y_j + y_k) / (y_j + x_k)
+            g[j] = gf65536_mul(g[j], gf65536_div(gf65536_add(x_j, x_k), gf65536_add(x_j, y_k)));
+            b[j] = gf65536_mul(b[j], gf65536_div(gf65536_add(y_j, y_k), gf65536_add(y_j, x_k)));
+        }
+
+        // L_jk /= L_kk
+        // U_kj /= U_kk
+        // The rows are little-endian words, so the bulk kernels divide them in place
+        const int count = N - (k + 1);
+        gf65536_div_mem_inplace(row_L, L_kk, count * 2);
+        gf65536_div_mem_inplace(rotated_row_U, U_kk, count * 2);
+
+        // Copy U matrix row into place in memory.
+        uint16_t* output_U = last_U + firstOffset_U;
+        row_U = rotated_row_U;
+        for (int j = k + 1; j < N; ++j)
+        {
+            *output_U = *row_U++;
+            output_U -= j;
+        }
+        firstOffset_U -= k + 2;
+    }
+
+    // Multiply diagonal matrix into U
+    uint16_t* row_U = matrix_U;
+    for (int j = N - 1; j > 0; --j)
+    {
+        const uint16_t y_j = ErasuresIndices[j];
+        const int count = j;
+
+        gf65536_mul_mem_inplace(row_U, gf65536_add(x_0, y_j), count * 2);
+        row_U += count;
+    }
+
+    const uint16_t x_n = Recovery[N - 1]->Index;
+    const uint16_t y_n = ErasuresIndices[N - 1];
+
+    // D_nn = 1 / (x_n + y_n)
+    // L_nn = g[N-1]
+    // U_nn = b[N-1] * (x_0 + y_n)
+    const uint16_t L_nn = g[N - 1];
+    const uint16_t U_nn = gf65536_mul(b[N - 1], gf65536_add(x_0, y_n));
+
+    // diag_D[N-1] = L_nn * D_nn * U_nn
+    diag_D[N - 1] = gf65536_div(gf65536_mul(L_nn, U_nn), gf65536_add(x_n, y_n));
+
+    delete[] g;
+}
+
+void CM65536Decoder::PrepareDecode()
+{
+    const int N = RecoveryCount;
+
+    Matrix = new uint16_t[N * N];
+
+    uint16_t* matrix_U = Matrix;
+    uint16_t* diag_D = matrix_U + (N - 1) * N / 2;
+    uint16_t* matrix_L = diag_D + N;
+    GenerateLDUDecomposition(matrix_L, diag_D, matrix_U);
+}
+
+void CM65536Decoder::EliminateRange(int offset, int bytes)
+{
+    const uint16_t x_0 = static_cast<uint16_t>(Params.OriginalCount);
+
+    // For each received original,
+    for (int originalIndex = 0; originalIndex < OriginalCount; ++originalIndex)
+    {
+        const uint8_t* inBlock = static_cast<const uint8_t*>(Original[originalIndex]->Block) + offset;
+        const uint16_t y_j = Original[originalIndex]->Index;
+
+        // Add its products into this strip of every recovery row while it is in cache
+        for (int recoveryIndex = 0; recoveryIndex < RecoveryCount; ++recoveryIndex)
+        {
+            uint8_t* outBlock = static_cast<uint8_t*>(Recovery[recoveryIndex]->Block) + offset;
+            const uint16_t x_i = Recovery[recoveryIndex]->Index;
+
+            // The first recovery row is all ones, so it is just a parity
+            if (x_i == x_0)
+            {
+                gf256_add_mem(outBlock, inBlock, bytes);
+            }
+            else
+            {
+                gf65536_muladd_mem(outBlock, GetMatrixElement(x_i, x_0, y_j), inBlock, bytes);
+            }
+        }
+    }
+}
+
+void CM65536Decoder::SolveRange(int offset, int bytes)
+{
+    // Matrix size is NxN, where N is the number of recovery blocks used.
+    const int N = RecoveryCount;
+
+    const uint16_t* matrix_U = Matrix;
+    const uint16_t* diag_D = matrix_U + (N - 1) * N / 2;
+    const uint16_t* matrix_L = diag_D + N;
+
+    /*
+        Eliminate lower left triangle.
+    */
+    for (int j = 0; j < N - 1; ++j)
+    {
+        const uint8_t* block_j = static_cast<const uint8_t*>(Recovery[j]->Block) + offset;
+
+        for (int i = j + 1; i < N; ++i)
+        {
+            uint8_t* block_i = static_cast<uint8_t*>(Recovery[i]->Block) + offset;
+            const uint16_t c_ij = *matrix_L++; // Matrix elements are stored column-first, top-down.
+
+            gf65536_muladd_mem(block_i, c_ij, block_j, bytes);
+        }
+    }
+
+    /*
+        Eliminate diagonal.
+    */
+    for (int i = 0; i < N; ++i)
+    {
+        uint8_t* block = static_cast<uint8_t*>(Recovery[i]->Block) + offset;
+
+        gf65536_div_mem_inplace(block, diag_D[i], bytes);
+    }
+
+    /*
+        Eliminate upper right triangle.
+    */
+    for (int j = N - 1; j >= 1; --j)
+    {
+        const uint8_t* block_j = static_cast<const uint8_t*>(Recovery[j]->Block) + offset;
+
+        for (int i = j - 1; i >= 0; --i)
+        {
+            uint8_t* block_i = static_cast<uint8_t*>(Recovery[i]->Block) + offset;
+            const uint16_t c_ij = *matrix_U++; // Matrix elements are stored column-first, bottom-up.
+
+            gf65536_muladd_mem(block_i, c_ij, block_j, bytes);
+        }
+    }
+}
+
+void CM65536Decoder::Decode()
+{
+    PrepareDecode();
+
+    const int tileBytes = GetTileBytes(Params.BlockBytes, RecoveryCount);
+
+    // Finish every pass over one strip of the recovery rows while it is in cache
+    for (int offset = 0; offset < Params.BlockBytes; offset += tileBytes)
+    {
+        int bytes = Params.BlockBytes - offset;
+        if (bytes > tileBytes)
+        {
+            bytes = tileBytes;
+        }
+
+        EliminateRange(offset, bytes);
+        SolveRange(offset, bytes);
+    }
+
+    for (int i = 0; i < RecoveryCount; ++i)
+    {
+        Recovery[i]->Index = ErasuresIndices[i];
+    }
+}
+
+extern "C" int cm65536_decode(
+    cm65536_encoder_params params, // Encoder parameters
+    cm65536_block* blocks)         // Array of 'originalCount' blocks as described above
+{
+    const int paramsResult = ValidateParams(params);
+    if (paramsResult != 0)
+    {
+        return paramsResult;
+    }
+    if (!blocks)
+    {
+        return -3;
+    }
+
+    // If there is only one block,
+    if (params.OriginalCount == 1)
+    {
+        // It is the same block repeated
+        blocks[0].Index = 0;
+        return 0;
+    }
+
+    CM65536Decoder state;
+    if (!state.Initialize(params, blocks))
+    {
+        return -5;
+    }
+
+    // If nothing is erased,
+    if (state.RecoveryCount <= 0)
+    {
+        return 0;
+    }
+
+    state.Decode();
+    return 0;
+}
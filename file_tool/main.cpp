@@ -0,0 +1,270 @@
+/*
+	Copyright (c) 2015 Christopher A. Taylor.  All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice,
+	  this list of conditions and the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice,
+	  this list of conditions and the following disclaimer in the documentation
+	  and/or other materials provided with the distribution.
+	* Neither the name of CM256 nor the names of its contributors may be
+	  used to endorse or promote products derived from this software without
+	  specific prior written permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+    File protection tool
+
+    Writes recovery shards for a file with cm256_file_encode(), and repairs
+    the file and its shards with cm256_file_repair().  Shard j is written to
+    <prefix>.<j>, where the prefix defaults to <input>.cm256.
+
+    Build from the repository root:
+
+        g++ -O2 -std=c++11 -o cm256_file file_tool/main.cpp cm256_file.cpp cm256.cpp gf256.cpp -lpthread
+
+    Run with no arguments for the options.
+*/
+
+#include "../cm256_file.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+
+
+//------------------------------------------------------------------------------
+// Options
+
+// Most damaged ranges accepted on the command line
+static const int kMaxDamaged = 64;
+
+// Longest shard path
+static const int kMaxPathBytes = 4096;
+
+struct ToolOptions
+{
+    bool Encode;
+    const char* Input;
+    const char* Prefix;
+    cm256_encoder_params Params;
+    int Threads;
+    cm256_file_range Damaged[kMaxDamaged];
+    int DamagedCount;
+};
+
+static void PrintUsage()
+{
+    fprintf(stderr,
+        "usage: cm256_file encode [options] <input>\n"
+        "       cm256_file repair [options] <input>\n"
+        "  -k N             original blocks per stripe (default 10)\n"
+        "  -m N             recovery shards (default 4)\n"
+        "  -b N             bytes per block (default 1048576)\n"
+        "  -t N             worker threads (default one per CPU)\n"
+        "  -o PREFIX        shard j is PREFIX.j (default <input>.cm256)\n"
+        "  -d OFFSET:BYTES  repair: a damaged range of the input (may repeat)\n");
+}
+
+// Parse "offset:bytes".
+// Returns false on a parse error
+static bool ParseRange(const char* text, cm256_file_range& range)
+{
+    char* end = nullptr;
+    range.Offset = strtoull(text, &end, 10);
+    if (end == text || *end != ':')
+    {
+        return false;
+    }
+    text = end + 1;
+    range.Bytes = strtoull(text, &end, 10);
+    return end != text && *end == '\0';
+}
+
+static bool ParseOptions(int argc, char** argv, ToolOptions& options)
+{
+    if (argc < 3)
+    {
+        return false;
+    }
+    if (0 == strcmp(argv[1], "encode"))
+        options.Encode = true;
+    else if (0 == strcmp(argv[1], "repair"))
+        options.Encode = false;
+    else
+        return false;
+
+    options.Input = nullptr;
+    options.Prefix = nullptr;
+    options.Params.OriginalCount = 10;
+    options.Params.RecoveryCount = 4;
+    options.Params.BlockBytes = 1024 * 1024;
+    options.Threads = (int)std::thread::hardware_concurrency();
+    options.DamagedCount = 0;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        if (arg[0] != '-')
+        {
+            if (options.Input)
+            {
+                return false;
+            }
+            options.Input = arg;
+            continue;
+        }
+
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!value)
+        {
+            return false;
+        }
+        ++i;
+
+        bool ok = true;
+        if (0 == strcmp(arg, "-k"))
+            ok = (options.Params.OriginalCount = atoi(value)) > 0;
+        else if (0 == strcmp(arg, "-m"))
+            ok = (options.Params.RecoveryCount = atoi(value)) > 0;
+        else if (0 == strcmp(arg, "-b"))
+            ok = (options.Params.BlockBytes = atoi(value)) > 0;
+        else if (0 == strcmp(arg, "-t"))
+            ok = (options.Threads = atoi(value)) > 0;
+        else if (0 == strcmp(arg, "-o"))
+            options.Prefix = value;
+        else if (0 == strcmp(arg, "-d") && !options.Encode && options.DamagedCount < kMaxDamaged)
+            ok = ParseRange(value, options.Damaged[options.DamagedCount++]);
+        else
+            ok = false;
+
+        if (!ok)
+        {
+            return false;
+        }
+    }
+
+    if (options.Threads < 1)
+    {
+        options.Threads = 1;
+    }
+    return options.Input != nullptr;
+}
+
+
+//------------------------------------------------------------------------------
+// Entrypoint
+
+int main(int argc, char** argv)
+{
+    ToolOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    if (cm256_init())
+    {
+        fprintf(stderr, "cm256_init failed\n");
+        return 2;
+    }
+
+    char prefix[kMaxPathBytes];
+    if (options.Prefix)
+    {
+        snprintf(prefix, sizeof(prefix), "%s", options.Prefix);
+    }
+    else
+    {
+        snprintf(prefix, sizeof(prefix), "%s.cm256", options.Input);
+    }
+
+    static char paths[256][kMaxPathBytes + 8];
+    const char* pathList[256];
+    for (int j = 0; j < 256; ++j)
+    {
+        snprintf(paths[j], sizeof(paths[j]), "%s.%d", prefix, j);
+        pathList[j] = paths[j];
+    }
+
+    // For repair the shard count comes from the first shard with a valid header
+    int recoveryCount = options.Params.RecoveryCount;
+    uint64_t fileBytes = 0;
+    if (!options.Encode)
+    {
+        recoveryCount = 0;
+        for (int j = 0; j < 255 && recoveryCount == 0; ++j)
+        {
+            cm256_encoder_params params;
+            if (cm256_file_read_header(pathList[j], &params, nullptr, &fileBytes) == 0)
+            {
+                recoveryCount = params.RecoveryCount;
+            }
+        }
+        if (recoveryCount == 0)
+        {
+            fprintf(stderr, "no valid shards named %s.N\n", prefix);
+            return 2;
+        }
+    }
+
+    cm256_threading threading;
+    threading.ThreadCount = options.Threads;
+    threading.Scheduler = nullptr;
+    threading.SchedulerContext = nullptr;
+
+    const auto t0 = std::chrono::steady_clock::now();
+
+    int result;
+    cm256_file_repair_result repair;
+    if (options.Encode)
+    {
+        result = cm256_file_encode(options.Params, options.Input, pathList, &threading);
+    }
+    else
+    {
+        result = cm256_file_repair(options.Input, pathList, recoveryCount,
+                                   options.Damaged, options.DamagedCount, &threading, &repair);
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    if (result != 0)
+    {
+        fprintf(stderr, "%s failed: %d\n", options.Encode ? "encode" : "repair", result);
+        return 2;
+    }
+
+    if (options.Encode)
+    {
+        cm256_file_read_header(pathList[0], nullptr, nullptr, &fileBytes);
+        printf("wrote %d shards %s.0..%d for %llu bytes in %.3f s (%.1f MB/s)\n",
+               recoveryCount, prefix, recoveryCount - 1, (unsigned long long)fileBytes,
+               seconds, seconds > 0. ? fileBytes / seconds / 1000000. : 0.);
+    }
+    else
+    {
+        printf("repaired %llu data blocks and %llu shard blocks, and rebuilt %d of %d shards in %.3f s\n",
+               (unsigned long long)repair.DataBlocksRepaired, (unsigned long long)repair.RecoveryBlocksRepaired,
+               repair.RecoveryShardsRebuilt, recoveryCount, seconds);
+    }
+
+    return 0;
+}
@@ -57,17 +57,36 @@
     #define GF256_TARGET_MOBILE
 #endif // ANDROID
 
-#if defined(__AVX2__) || (defined (_MSC_VER) && _MSC_VER >= 1900)
+// 64-bit ARM Linux servers build the same ARM code paths as mobile targets,
+// where NEON is always present and unaligned accesses are as fast as aligned
+// ones.  Other 64-bit ARM platforms are left to opt in with their own defines.
+#if defined(__aarch64__) && defined(__linux__) && !defined(ANDROID) && !defined(__ANDROID__) && !defined(IOS)
+    #define GF256_TARGET_ARM_SERVER
+    #if !defined(GF256_TARGET_MOBILE)
+        #define GF256_TARGET_MOBILE
+    #endif
+    #if !defined(HAVE_ARM_NEON_H)
+        #define HAVE_ARM_NEON_H
+    #endif
+#endif // GF256_TARGET_ARM_SERVER
+
+// AVX2 kernels are compiled with per-function target attributes and selected
+// at runtime, so a binary built for baseline x86-64 still uses them
+#if !defined(GF256_TARGET_MOBILE) && !defined(GF256_NO_AVX2) && \
+    (defined(__AVX2__) || (defined (_MSC_VER) && _MSC_VER >= 1900) || \
+     (defined(__clang__) && __clang_major__ >= 4) || \
+     (defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 5))
     #define GF256_TRY_AVX2 /* 256-bit */
     #include <immintrin.h>
     #define GF256_ALIGN_BYTES 32
-#else // __AVX2__
+#else // GF256_TRY_AVX2
     #define GF256_ALIGN_BYTES 16
-#endif // __AVX2__
+#endif // GF256_TRY_AVX2
 
 #if !defined(GF256_TARGET_MOBILE)
     // Note: MSVC currently only supports SSSE3 but not AVX2
     #include <tmmintrin.h> // SSSE3: _mm_shuffle_epi8
+    #include <nmmintrin.h> // SSE4.2: _mm_crc32_u64
     #include <emmintrin.h> // SSE2
 #endif // GF256_TARGET_MOBILE
 
@@ -75,14 +94,23 @@
     #include <arm_neon.h>
 #endif // HAVE_ARM_NEON_H
 
+#if defined(__ARM_FEATURE_CRC32)
+    #include <arm_acle.h> // ARMv8 CRC: __crc32cd
+#endif // __ARM_FEATURE_CRC32
+
 #if defined(GF256_TARGET_MOBILE)
 
+# if !defined(GF256_TARGET_ARM_SERVER)
     #define GF256_ALIGNED_ACCESSES /* Inputs must be aligned to GF256_ALIGN_BYTES */
+# endif
 
 # if defined(HAVE_ARM_NEON_H)
     // Compiler-specific 128-bit SIMD register keyword
     #define GF256_M128 uint8x16_t
     #define GF256_TRY_NEON
+#  if defined(__aarch64__) || defined(_M_ARM64)
+    #define GF256_TRY_NEON4X /* 64 bytes per iteration in the 32 AArch64 vector registers */
+#  endif
 #else
     #define GF256_M128 uint64_t
 # endif
@@ -94,7 +122,31 @@
 
 #endif // GF256_TARGET_MOBILE
 
-#ifdef GF256_TRY_AVX2
+// GFNI kernels are compiled with per-function target attributes and selected
+// at runtime, so they do not require building with -mgfni or -mavx512bw
+#if !defined(GF256_TARGET_MOBILE) && !defined(GF256_NO_GFNI)
+# if (defined(__clang__) && __clang_major__ >= 7) || \
+     (defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 8) || \
+     (defined(_MSC_VER) && !defined(__clang__) && _MSC_VER >= 1920)
+    #define GF256_TRY_GFNI /* GF2P8AFFINEQB with 256-bit and 512-bit registers */
+    #include <immintrin.h>
+
+    // Compiler-specific 512-bit SIMD register keyword
+    #define GF256_M512 __m512i
+# endif
+#endif // GF256_TARGET_MOBILE
+
+// SVE2 kernels are compiled with per-function target attributes and selected
+// at runtime from the Linux hardware capability bits
+#if defined(GF256_TARGET_ARM_SERVER) && !defined(GF256_NO_SVE2) && \
+    (defined(__ARM_FEATURE_SVE2) || \
+     (defined(__clang__) && __clang_major__ >= 17) || \
+     (defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 14))
+    #define GF256_TRY_SVE2 /* Scalable TBL and EOR3 */
+    #include <arm_sve.h>
+#endif // GF256_TRY_SVE2
+
+#if defined(GF256_TRY_AVX2) || defined(GF256_TRY_GFNI)
     // Compiler-specific 256-bit SIMD register keyword
     #define GF256_M256 __m256i
 #endif
@@ -102,6 +154,18 @@
 // Compiler-specific C++11 restrict keyword
 #define GF256_RESTRICT __restrict
 
+// Compiler-specific thread-local storage keyword for plain data
+#ifdef _MSC_VER
+    #define GF256_THREAD_LOCAL __declspec(thread)
+#else
+    #define GF256_THREAD_LOCAL __thread
+#endif
+
+// Building cm256 with instrumentation also counts the kernel calls it makes
+#if defined(CM256_INSTRUMENT) && !defined(GF256_INSTRUMENT)
+    #define GF256_INSTRUMENT
+#endif
+
 // Compiler-specific force inline keyword
 #ifdef _MSC_VER
     #define GF256_FORCE_INLINE inline __forceinline
@@ -137,31 +201,109 @@ extern void gf256_memswap(void * GF256_RESTRICT vx, void * GF256_RESTRICT vy, in
     #pragma warning(disable: 4324) // warning C4324: 'gf256_ctx' : structure was padded due to __declspec(align())
 #endif // _MSC_VER
 
+/// Implementations of the bulk memory operations.
+/// gf256_init() selects the last one that is available.
+typedef enum gf256_backend_t
+{
+    GF256_BACKEND_SCALAR,  ///< Portable 64-bit words and table lookups
+    GF256_BACKEND_SSSE3,   ///< 128-bit PSHUFB nibble tables
+    GF256_BACKEND_AVX2,    ///< 256-bit VPSHUFB nibble tables
+    GF256_BACKEND_GFNI,    ///< 256-bit GF2P8AFFINEQB
+    GF256_BACKEND_GFNI512, ///< 512-bit GF2P8AFFINEQB with AVX-512BW
+    GF256_BACKEND_NEON,    ///< 128-bit VTBL nibble tables
+    GF256_BACKEND_NEON4X,  ///< 128-bit VTBL nibble tables, 64 bytes per iteration on AArch64
+    GF256_BACKEND_SVE2,    ///< Scalable TBL nibble tables with EOR3
+
+    GF256_BACKEND_COUNT
+} gf256_backend;
+
+/// Bulk memory kernels for one backend.
+/// These have the same contracts as the gf256_*_mem() functions below, except
+/// that the multiplies do not have special cases for y = 0 or y = 1, and
+/// MulMem also accepts vz == vx so it can scale a buffer in place.
+struct gf256_kernels
+{
+    void (*AddMem)(void * GF256_RESTRICT vx, const void * GF256_RESTRICT vy, int bytes);
+    void (*Add2Mem)(void * GF256_RESTRICT vz, const void * GF256_RESTRICT vx,
+                    const void * GF256_RESTRICT vy, int bytes);
+    void (*AddSetMem)(void * GF256_RESTRICT vz, const void * GF256_RESTRICT vx,
+                      const void * GF256_RESTRICT vy, int bytes);
+    void (*MulMem)(void * vz, const void * vx, uint8_t y, int bytes);
+    void (*MulAddMem)(void * GF256_RESTRICT vz, uint8_t y, const void * GF256_RESTRICT vx, int bytes);
+    void (*MulMultiMem)(void * GF256_RESTRICT vz, const uint8_t * GF256_RESTRICT y,
+                        const void * const * GF256_RESTRICT vx, int count, int bytes);
+    void (*MulAddMultiMem)(void * GF256_RESTRICT vz, const uint8_t * GF256_RESTRICT y,
+                           const void * const * GF256_RESTRICT vx, int count, int bytes);
+    void (*MulPQMultiMem)(void * GF256_RESTRICT vp, void * GF256_RESTRICT vq, const uint8_t * GF256_RESTRICT y,
+                          const void * const * GF256_RESTRICT vx, int count, int bytes);
+    void (*MulAddPQMultiMem)(void * GF256_RESTRICT vp, void * GF256_RESTRICT vq, const uint8_t * GF256_RESTRICT y,
+                             const void * const * GF256_RESTRICT vx, int count, int bytes);
+};
+
+/**
+    Table Build Modes
+
+    By default gf256_init() fills in the tables below at startup.
+
+    With GF256_STATIC_TABLES defined, the tables are generated at compile time
+    instead, so GF256Ctx is read-only data that every process mapping the
+    library shares through the page cache, and gf256_init() only selects and
+    self-tests the kernels.  Building gf256.cpp this way requires C++14, and
+    compilers with a low constant evaluation limit may need it raised, e.g.
+    /constexpr:steps10000000 for MSVC or -fconstexpr-steps=10000000 for Clang.
+
+    With GF256_COMPACT_TABLES defined, gf256_mul() and gf256_div() use the
+    log/exp tables, which fit in under 2 KB of cache instead of touching
+    the 64 KB product tables, and the 64 KB DIV table is left out.  This
+    suits the matrix setup in cm256, which does many scattered scalar
+    multiplies.  gf256_div() then requires y to be nonzero.
+
+    These change the layout of gf256_ctx, so define them the same way for
+    every file that includes this header.
+*/
+
 /// The context object stores tables required to perform library calculations
 struct gf256_ctx
 {
     /// We require memory to be aligned since the SIMD instructions benefit from
     /// or require aligned accesses to the table data.
+    /// The tables are bytes so that they can be generated at compile time.
     struct
     {
-        GF256_ALIGNED GF256_M128 TABLE_LO_Y[256];
-        GF256_ALIGNED GF256_M128 TABLE_HI_Y[256];
+        GF256_ALIGNED uint8_t TABLE_LO_Y[256][16];
+        GF256_ALIGNED uint8_t TABLE_HI_Y[256][16];
     } MM128;
 #ifdef GF256_TRY_AVX2
+    /// VPSHUFB looks up each 128-bit lane separately, so each table is repeated
     struct
     {
-        GF256_ALIGNED GF256_M256 TABLE_LO_Y[256];
-        GF256_ALIGNED GF256_M256 TABLE_HI_Y[256];
+        GF256_ALIGNED uint8_t TABLE_LO_Y[256][32];
+        GF256_ALIGNED uint8_t TABLE_HI_Y[256][32];
     } MM256;
 #endif // GF256_TRY_AVX2
 
     /// Mul/Div/Inv/Sqr tables
     uint8_t GF256_MUL_TABLE[256 * 256];
+#ifndef GF256_COMPACT_TABLES
     uint8_t GF256_DIV_TABLE[256 * 256];
+#endif // GF256_COMPACT_TABLES
     uint8_t GF256_INV_TABLE[256];
     uint8_t GF256_SQR_TABLE[256];
 
+#ifdef GF256_TRY_GFNI
+    /// GF2P8AFFINEQB bit matrices that multiply each byte by y
+    uint64_t GF256_AFFINE_TABLE[256];
+#endif // GF256_TRY_GFNI
+
+    /// CRC32C slicing-by-8 tables for gf256_crc32c() without hardware support
+    uint32_t CRC32C_TABLE[8][256];
+
+    /// CRC32C lane shift tables for the three-way hardware kernel
+    uint32_t CRC32C_SHIFT_LONG[4][256];
+    uint32_t CRC32C_SHIFT_SHORT[4][256];
+
     /// Log/Exp tables
+    /// LOG[0] = 512 indexes the zero half of EXP, so products with 0 need no branch
     uint16_t GF256_LOG_TABLE[256];
     uint8_t GF256_EXP_TABLE[512 * 2 + 1];
 
@@ -173,7 +315,11 @@ struct gf256_ctx
     #pragma warning(pop)
 #endif // _MSC_VER
 
+#ifdef GF256_STATIC_TABLES
+extern const gf256_ctx GF256Ctx;
+#else // GF256_STATIC_TABLES
 extern gf256_ctx GF256Ctx;
+#endif // GF256_STATIC_TABLES
 
 
 //------------------------------------------------------------------------------
@@ -201,6 +347,84 @@ extern int gf256_init_(int version);
 #define gf256_init() gf256_init_(GF256_VERSION)
 
 
+//------------------------------------------------------------------------------
+// Backend Selection
+
+/**
+    The bulk memory operations dispatch through a kernel table, which
+    gf256_init() fills with the fastest backend that this binary contains and
+    this CPU supports.  Every kernel it contains is self-tested before use.
+*/
+
+/// Returns the backend selected by gf256_init()
+extern gf256_backend gf256_get_backend();
+
+/// Returns a short name for the backend, such as "avx2"
+extern const char* gf256_backend_name(gf256_backend backend);
+
+/// Returns nonzero if the backend was compiled in and is supported by this CPU
+extern int gf256_backend_available(gf256_backend backend);
+
+/**
+    Switch all bulk memory operations to the given backend.
+
+    This is meant for testing and benchmarking.  The kernel table is copied
+    without synchronization, so call it only before any thread starts
+    encoding or decoding, or after all of them have finished.  The scalar
+    backend also switches gf256_crc32c() to its portable tables, so that
+    path can be tested too.
+
+    Returns 0 on success.
+    Returns -1 if the backend is not available.
+*/
+extern int gf256_set_backend(gf256_backend backend);
+
+
+//------------------------------------------------------------------------------
+// Kernel Counters
+
+/**
+    When built with GF256_INSTRUMENT defined, each bulk memory operation
+    counts its calls and the bytes it reads from its sources, per thread and
+    without synchronization.  Otherwise the counting compiles to nothing and
+    gf256_get_stats() reports zeros.
+*/
+
+/// Bulk memory operations that are counted
+typedef enum gf256_op_t
+{
+    GF256_OP_ADD,             ///< gf256_add_mem()
+    GF256_OP_ADD2,            ///< gf256_add2_mem()
+    GF256_OP_ADDSET,          ///< gf256_addset_mem()
+    GF256_OP_MUL,             ///< gf256_mul_mem(), gf256_div_mem() and their _inplace forms
+    GF256_OP_MULADD,          ///< gf256_muladd_mem()
+    GF256_OP_MUL_MULTI,       ///< gf256_mul_multi_mem()
+    GF256_OP_MULADD_MULTI,    ///< gf256_muladd_multi_mem()
+    GF256_OP_MUL_PQ_MULTI,    ///< gf256_mul_pq_multi_mem()
+    GF256_OP_MULADD_PQ_MULTI, ///< gf256_muladd_pq_multi_mem()
+    GF256_OP_CRC32C,          ///< gf256_crc32c()
+
+    GF256_OP_COUNT
+} gf256_op;
+
+/// Counters for the calling thread
+typedef struct gf256_stats_t
+{
+    uint64_t Calls[GF256_OP_COUNT];
+    uint64_t Bytes[GF256_OP_COUNT]; ///< Source bytes: count * bytes for the multi-source operations
+} gf256_stats;
+
+/// Copy the calling thread's counters.
+/// Returns 0 on success, or -1 if the library was built without GF256_INSTRUMENT
+extern int gf256_get_stats(gf256_stats* stats);
+
+/// Add counters gathered on another thread to the calling thread's counters
+extern void gf256_merge_stats(const gf256_stats* stats);
+
+/// Zero the calling thread's counters
+extern void gf256_reset_stats();
+
+
 //------------------------------------------------------------------------------
 // Math Operations
 
@@ -214,14 +438,22 @@ static GF256_FORCE_INLINE uint8_t gf256_add(uint8_t x, uint8_t y)
 /// For repeated multiplication by a constant, it is faster to put the constant in y.
 static GF256_FORCE_INLINE uint8_t gf256_mul(uint8_t x, uint8_t y)
 {
+#ifdef GF256_COMPACT_TABLES
+    return GF256Ctx.GF256_EXP_TABLE[GF256Ctx.GF256_LOG_TABLE[x] + GF256Ctx.GF256_LOG_TABLE[y]];
+#else // GF256_COMPACT_TABLES
     return GF256Ctx.GF256_MUL_TABLE[((unsigned)y << 8) + x];
+#endif // GF256_COMPACT_TABLES
 }
 
 /// return x / y
 /// Memory-access optimized for constant divisors in y.
 static GF256_FORCE_INLINE uint8_t gf256_div(uint8_t x, uint8_t y)
 {
+#ifdef GF256_COMPACT_TABLES
+    return GF256Ctx.GF256_EXP_TABLE[GF256Ctx.GF256_LOG_TABLE[x] + 255 - GF256Ctx.GF256_LOG_TABLE[y]];
+#else // GF256_COMPACT_TABLES
     return GF256Ctx.GF256_DIV_TABLE[((unsigned)y << 8) + x];
+#endif // GF256_COMPACT_TABLES
 }
 
 /// return 1 / x
@@ -256,10 +488,36 @@ extern void gf256_addset_mem(void * GF256_RESTRICT vz, const void * GF256_RESTRI
 extern void gf256_mul_mem(void * GF256_RESTRICT vz,
                           const void * GF256_RESTRICT vx, uint8_t y, int bytes);
 
+/// Performs "z[] *= y" bulk memory operation in place
+extern void gf256_mul_mem_inplace(void * vz, uint8_t y, int bytes);
+
 /// Performs "z[] += x[] * y" bulk memory operation
 extern void gf256_muladd_mem(void * GF256_RESTRICT vz, uint8_t y,
                              const void * GF256_RESTRICT vx, int bytes);
 
+/// Performs "z[] = x_0[] * y_0 + x_1[] * y_1 + ..." bulk memory operation
+/// Multiplies 'count' source buffers by matching coefficients and sums them into z.
+/// The running sum is held in registers so z is only written once per pass.
+extern void gf256_mul_multi_mem(void * GF256_RESTRICT vz, const uint8_t * GF256_RESTRICT y,
+                                const void * const * GF256_RESTRICT vx, int count, int bytes);
+
+/// Performs "z[] += x_0[] * y_0 + x_1[] * y_1 + ..." bulk memory operation
+/// Like gf256_mul_multi_mem() except that the sum is added to the existing z.
+extern void gf256_muladd_multi_mem(void * GF256_RESTRICT vz, const uint8_t * GF256_RESTRICT y,
+                                   const void * const * GF256_RESTRICT vx, int count, int bytes);
+
+/// Performs "p[] = x_0[] + x_1[] + ..." and "q[] = x_0[] * y_0 + x_1[] * y_1 + ..."
+/// Each source buffer is read once for both sums, as needed for P + Q parity.
+/// p and q must not overlap each other or the sources.
+extern void gf256_mul_pq_multi_mem(void * GF256_RESTRICT vp, void * GF256_RESTRICT vq,
+                                   const uint8_t * GF256_RESTRICT y,
+                                   const void * const * GF256_RESTRICT vx, int count, int bytes);
+
+/// Like gf256_mul_pq_multi_mem() except that the sums are added to the existing p and q.
+extern void gf256_muladd_pq_multi_mem(void * GF256_RESTRICT vp, void * GF256_RESTRICT vq,
+                                      const uint8_t * GF256_RESTRICT y,
+                                      const void * const * GF256_RESTRICT vx, int count, int bytes);
+
 /// Performs "x[] /= y" bulk memory operation
 static GF256_FORCE_INLINE void gf256_div_mem(void * GF256_RESTRICT vz,
                                              const void * GF256_RESTRICT vx, uint8_t y, int bytes)
@@ -268,12 +526,50 @@ static GF256_FORCE_INLINE void gf256_div_mem(void * GF256_RESTRICT vz,
     gf256_mul_mem(vz, vx, y == 1 ? (uint8_t)1 : GF256Ctx.GF256_INV_TABLE[y], bytes);
 }
 
+/// Performs "z[] /= y" bulk memory operation in place
+static GF256_FORCE_INLINE void gf256_div_mem_inplace(void * vz, uint8_t y, int bytes)
+{
+    // Multiply by inverse
+    gf256_mul_mem_inplace(vz, y == 1 ? (uint8_t)1 : GF256Ctx.GF256_INV_TABLE[y], bytes);
+}
+
 
 //------------------------------------------------------------------------------
 // Misc Operations
 
-/// Swap two memory buffers in-place
-extern void gf256_memswap(void * GF256_RESTRICT vx, void * GF256_RESTRICT vy, int bytes);
+/**
+    Copy a buffer with non-temporal stores that bypass the cache.
+
+    Use this for the final write of output that will not be read again soon,
+    so the output does not evict data that is still being read.  The stores
+    are fenced before returning.  Where there are no streaming stores this is
+    a plain memcpy().
+*/
+extern void gf256_memcpy_nt(void * GF256_RESTRICT vz, const void * GF256_RESTRICT vx, int bytes);
+
+/**
+    Same as gf256_memcpy_nt() except that the stores are not fenced.
+
+    A loop streaming out many chunks calls gf256_stream_fence() once after
+    the last one instead of paying for a fence per chunk.
+*/
+extern void gf256_memcpy_nt_unfenced(void * GF256_RESTRICT vz, const void * GF256_RESTRICT vx, int bytes);
+
+/// Order the streaming stores made so far before any later stores
+extern void gf256_stream_fence();
+
+/**
+    Continue a CRC32C (Castagnoli) checksum over another buffer.
+
+    Pass 0 to start a new checksum.  Checksumming a buffer in several pieces
+    gives the same result as checksumming it all at once:
+
+        gf256_crc32c(gf256_crc32c(0, a, n), a + n, m) == gf256_crc32c(0, a, n + m)
+
+    This uses SSE4.2 or ARMv8 CRC instructions when they are available,
+    except with the scalar backend, which uses the slicing-by-8 tables.
+*/
+extern uint32_t gf256_crc32c(uint32_t crc, const void * GF256_RESTRICT data, int bytes);
 
 
 #ifdef __cplusplus
@@ -0,0 +1,763 @@
+/** \file
+    \brief GF(65536) Main C API Source
+    \copyright Copyright (c) 2017 Christopher A. Taylor.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+    * Neither the name of GF256 nor the names of its contributors may be
+      used to endorse or promote products derived from this software without
+      specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "gf65536.h"
+
+//------------------------------------------------------------------------------
+// Kernel Targets
+//
+// Same as in gf256.cpp: each SIMD kernel is compiled for its own instruction
+// set, and the kernels of the backend gf256 is using are called at runtime.
+
+#if !defined(GF256_TARGET_MOBILE)
+# if defined(_MSC_VER) && !defined(__clang__)
+    #define GF65536_TARGET_SSSE3
+    #define GF65536_TARGET_AVX2
+    #define GF65536_TARGET_GFNI
+# else
+    #define GF65536_TARGET_SSSE3 __attribute__((target("ssse3")))
+    #define GF65536_TARGET_AVX2 __attribute__((target("avx2")))
+    #define GF65536_TARGET_GFNI __attribute__((target("avx2,gfni")))
+# endif
+#endif // GF256_TARGET_MOBILE
+
+// The ARMv7 shuffle only looks up 8 bytes at a time, so only AArch64 gets NEON kernels
+#if defined(GF256_TRY_NEON) && defined(__aarch64__)
+    #define GF65536_TRY_NEON
+#endif
+
+
+//------------------------------------------------------------------------------
+// Context Object
+
+// Context object for GF(65536) math
+gf65536_ctx GF65536Ctx;
+static bool Initialized = false;
+
+// x^16 + x^5 + x^3 + x^2 + 1, which is primitive so 2 generates the field
+static const unsigned kPolynomial = 0x1002D;
+
+// return x * 2
+static GF256_FORCE_INLINE uint16_t gf65536_mul_x(uint16_t x)
+{
+    return static_cast<uint16_t>((x << 1) ^ ((x & 0x8000) ? (kPolynomial & 0xffff) : 0));
+}
+
+// Fill the log/exp tables, or return false if 2 does not generate the field
+static bool gf65536_explog_init()
+{
+    uint16_t* LogTable = GF65536Ctx.GF65536_LOG_TABLE;
+    uint16_t* ExpTable = GF65536Ctx.GF65536_EXP_TABLE;
+
+    LogTable[0] = 0;
+
+    uint16_t x = 1;
+    for (unsigned jj = 0; jj < 65535; ++jj)
+    {
+        if (x == 1 && jj != 0)
+            return false;
+
+        ExpTable[jj] = x;
+        ExpTable[jj + 65535] = x;
+        LogTable[x] = static_cast<uint16_t>(jj);
+
+        x = gf65536_mul_x(x);
+    }
+
+    return x == 1;
+}
+
+
+//------------------------------------------------------------------------------
+// Product Tables
+//
+// Multiplication by y is linear over GF(2), so the product of a word is the
+// sum of the products of its four nibbles.  A word x = n_0 + n_1 * 2^4 +
+// n_2 * 2^8 + n_3 * 2^12, so x * y = sum of T_k[n_k] with T_k[n] = y * n * 2^4k.
+// Each 16-entry table is split into low and high bytes for the byte shuffles.
+
+struct gf65536_mul_tables
+{
+    // Low and high bytes of y * (n << 4k) for nibble position k and nibble n
+    GF256_ALIGNED uint8_t Lo[4][16];
+    GF256_ALIGNED uint8_t Hi[4][16];
+};
+
+static void gf65536_build_tables(uint16_t y, gf65536_mul_tables& tables)
+{
+    // y * 2^b for the next input bit b
+    uint16_t product = y;
+
+    for (int k = 0; k < 4; ++k)
+    {
+        uint16_t table[16];
+        table[0] = 0;
+
+        // Each bit doubles the table: T[n + 2^b] = T[n] + y * 2^b
+        for (int bit = 0; bit < 4; ++bit, product = gf65536_mul_x(product))
+        {
+            const int n = 1 << bit;
+            for (int i = 0; i < n; ++i)
+            {
+                table[n + i] = table[i] ^ product;
+            }
+        }
+
+        for (int n = 0; n < 16; ++n)
+        {
+            tables.Lo[k][n] = static_cast<uint8_t>(table[n]);
+            tables.Hi[k][n] = static_cast<uint8_t>(table[n] >> 8);
+        }
+    }
+}
+
+/*
+    The tables are also linear in y, so the tables for any y are the sum of
+    the tables for its four nibbles n * 2^4q.  Those 64 are built once, and
+    each call sums four of them instead of rebuilding its own, which costs
+    more than the kernel itself over a few kilobytes.
+*/
+static gf65536_mul_tables NibbleTables[4][16];
+
+#if defined(GF256_TRY_GFNI) && defined(GF256_TRY_AVX2)
+
+/*
+    GFNI Matrices
+
+    With the low and high bytes of each word separated, the product is
+
+        lo' = A_ll * lo + A_lh * hi
+        hi' = A_hl * lo + A_hh * hi
+
+    where each A is an 8x8 bit matrix.  Column b of the four matrices holds
+    the bits of y * 2^b for the low byte and y * 2^(8+b) for the high byte.
+*/
+
+struct gf65536_affine_tables
+{
+    uint64_t LoFromLo, LoFromHi, HiFromLo, HiFromHi;
+};
+
+// Build the GF2P8AFFINEQB matrix from 8 columns, taking the output bits from bit 'shift' up
+static uint64_t gf65536_affine_matrix(const uint16_t* columns, int shift)
+{
+    uint64_t matrix = 0;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        unsigned row = 0;
+
+        for (int k = 0; k < 8; ++k)
+        {
+            if ((columns[k] >> (shift + i)) & 1)
+                row |= 1 << k;
+        }
+
+        matrix |= (uint64_t)row << (8 * (7 - i));
+    }
+
+    return matrix;
+}
+
+static void gf65536_build_affine(uint16_t y, gf65536_affine_tables& tables)
+{
+    uint16_t columns[16];
+    columns[0] = y;
+    for (int b = 1; b < 16; ++b)
+    {
+        columns[b] = gf65536_mul_x(columns[b - 1]);
+    }
+
+    tables.LoFromLo = gf65536_affine_matrix(columns, 0);
+    tables.HiFromLo = gf65536_affine_matrix(columns, 8);
+    tables.LoFromHi = gf65536_affine_matrix(columns + 8, 0);
+    tables.HiFromHi = gf65536_affine_matrix(columns + 8, 8);
+}
+
+// Matrices for y = n * 2^4q, summed the same way as NibbleTables
+static gf65536_affine_tables NibbleAffine[4][16];
+
+// return the matrices for y
+static GF256_FORCE_INLINE gf65536_affine_tables gf65536_get_affine(uint16_t y)
+{
+    const gf65536_affine_tables& t0 = NibbleAffine[0][y & 15];
+    const gf65536_affine_tables& t1 = NibbleAffine[1][(y >> 4) & 15];
+    const gf65536_affine_tables& t2 = NibbleAffine[2][(y >> 8) & 15];
+    const gf65536_affine_tables& t3 = NibbleAffine[3][y >> 12];
+
+    gf65536_affine_tables tables;
+    tables.LoFromLo = t0.LoFromLo ^ t1.LoFromLo ^ t2.LoFromLo ^ t3.LoFromLo;
+    tables.LoFromHi = t0.LoFromHi ^ t1.LoFromHi ^ t2.LoFromHi ^ t3.LoFromHi;
+    tables.HiFromLo = t0.HiFromLo ^ t1.HiFromLo ^ t2.HiFromLo ^ t3.HiFromLo;
+    tables.HiFromHi = t0.HiFromHi ^ t1.HiFromHi ^ t2.HiFromHi ^ t3.HiFromHi;
+    return tables;
+}
+
+#endif // GF256_TRY_GFNI
+
+// Build the tables for every nibble y = n * 2^4q
+static void gf65536_tables_init()
+{
+    for (int q = 0; q < 4; ++q)
+    {
+        for (int n = 0; n < 16; ++n)
+        {
+            const uint16_t y = static_cast<uint16_t>(n << (4 * q));
+
+            gf65536_build_tables(y, NibbleTables[q][n]);
+#if defined(GF256_TRY_GFNI) && defined(GF256_TRY_AVX2)
+            gf65536_build_affine(y, NibbleAffine[q][n]);
+#endif // GF256_TRY_GFNI
+        }
+    }
+}
+
+
+//------------------------------------------------------------------------------
+// Portable Kernels
+
+// z[] (+)= x[] * y one little-endian word at a time
+static void gf65536_muladd_portable(uint8_t * z1, uint16_t y,
+                                    const uint8_t * x1, int bytes, bool accumulate)
+{
+    const unsigned logY = GF65536Ctx.GF65536_LOG_TABLE[y];
+
+    for (int i = 0; i + 1 < bytes; i += 2)
+    {
+        const uint16_t x = static_cast<uint16_t>(x1[i] | (x1[i + 1] << 8));
+        uint16_t product = (x == 0) ? 0 : GF65536Ctx.GF65536_EXP_TABLE[GF65536Ctx.GF65536_LOG_TABLE[x] + logY];
+
+        if (accumulate)
+        {
+            product ^= static_cast<uint16_t>(z1[i] | (z1[i + 1] << 8));
+        }
+
+        z1[i] = static_cast<uint8_t>(product);
+        z1[i + 1] = static_cast<uint8_t>(product >> 8);
+    }
+}
+
+static void gf65536_mul_mem_scalar(uint8_t * z1, const uint8_t * x1,
+                                   uint16_t y, int bytes)
+{
+    gf65536_muladd_portable(z1, y, x1, bytes, false);
+}
+
+static void gf65536_muladd_mem_scalar(uint8_t * GF256_RESTRICT z1, uint16_t y,
+                                      const uint8_t * GF256_RESTRICT x1, int bytes)
+{
+    gf65536_muladd_portable(z1, y, x1, bytes, true);
+}
+
+
+//------------------------------------------------------------------------------
+// SSSE3 Kernels
+//
+// Each pass loads 16 words as two registers, packs their low bytes into one
+// register and their high bytes into another, looks up the products of the
+// four nibbles in each, and interleaves the product bytes back into words.
+
+#if !defined(GF256_TARGET_MOBILE)
+
+// Sum the nibble tables of y
+static GF256_FORCE_INLINE GF65536_TARGET_SSSE3 void gf65536_load_tables_ssse3(
+    uint16_t y, GF256_M128* lo_tables, GF256_M128* hi_tables)
+{
+    const gf65536_mul_tables& t0 = NibbleTables[0][y & 15];
+    const gf65536_mul_tables& t1 = NibbleTables[1][(y >> 4) & 15];
+    const gf65536_mul_tables& t2 = NibbleTables[2][(y >> 8) & 15];
+    const gf65536_mul_tables& t3 = NibbleTables[3][y >> 12];
+
+    for (int k = 0; k < 4; ++k)
+    {
+        lo_tables[k] = _mm_xor_si128(
+            _mm_xor_si128(_mm_load_si128(reinterpret_cast<const GF256_M128*>(t0.Lo[k])),
+                          _mm_load_si128(reinterpret_cast<const GF256_M128*>(t1.Lo[k]))),
+            _mm_xor_si128(_mm_load_si128(reinterpret_cast<const GF256_M128*>(t2.Lo[k])),
+                          _mm_load_si128(reinterpret_cast<const GF256_M128*>(t3.Lo[k]))));
+        hi_tables[k] = _mm_xor_si128(
+            _mm_xor_si128(_mm_load_si128(reinterpret_cast<const GF256_M128*>(t0.Hi[k])),
+                          _mm_load_si128(reinterpret_cast<const GF256_M128*>(t1.Hi[k]))),
+            _mm_xor_si128(_mm_load_si128(reinterpret_cast<const GF256_M128*>(t2.Hi[k])),
+                          _mm_load_si128(reinterpret_cast<const GF256_M128*>(t3.Hi[k]))));
+    }
+}
+
+static GF256_FORCE_INLINE GF65536_TARGET_SSSE3 void gf65536_muladd_ssse3(
+    uint8_t * z1, uint16_t y, const uint8_t * x1, int bytes, bool accumulate)
+{
+    GF256_M128 lo_tables[4], hi_tables[4];
+    gf65536_load_tables_ssse3(y, lo_tables, hi_tables);
+
+    const GF256_M128 byte_mask = _mm_set1_epi16(0x00ff);
+    const GF256_M128 clr_mask = _mm_set1_epi8(0x0f);
+
+    // Handle multiples of 32 bytes
+    while (bytes >= 32)
+    {
+        const GF256_M128 a = _mm_loadu_si128(reinterpret_cast<const GF256_M128*>(x1));
+        const GF256_M128 b = _mm_loadu_si128(reinterpret_cast<const GF256_M128*>(x1 + 16));
+
+        const GF256_M128 lo = _mm_packus_epi16(_mm_and_si128(a, byte_mask), _mm_and_si128(b, byte_mask));
+        const GF256_M128 hi = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+
+        const GF256_M128 n0 = _mm_and_si128(lo, clr_mask);
+        const GF256_M128 n1 = _mm_and_si128(_mm_srli_epi64(lo, 4), clr_mask);
+        const GF256_M128 n2 = _mm_and_si128(hi, clr_mask);
+        const GF256_M128 n3 = _mm_and_si128(_mm_srli_epi64(hi, 4), clr_mask);
+
+        GF256_M128 p_lo = _mm_xor_si128(_mm_shuffle_epi8(lo_tables[0], n0), _mm_shuffle_epi8(lo_tables[1], n1));
+        p_lo = _mm_xor_si128(p_lo, _mm_xor_si128(_mm_shuffle_epi8(lo_tables[2], n2), _mm_shuffle_epi8(lo_tables[3], n3)));
+        GF256_M128 p_hi = _mm_xor_si128(_mm_shuffle_epi8(hi_tables[0], n0), _mm_shuffle_epi8(hi_tables[1], n1));
+        p_hi = _mm_xor_si128(p_hi, _mm_xor_si128(_mm_shuffle_epi8(hi_tables[2], n2), _mm_shuffle_epi8(hi_tables[3], n3)));
+
+        GF256_M128 z0 = _mm_unpacklo_epi8(p_lo, p_hi);
+        GF256_M128 z16 = _mm_unpackhi_epi8(p_lo, p_hi);
+        if (accumulate)
+        {
+            z0 = _mm_xor_si128(z0, _mm_loadu_si128(reinterpret_cast<const GF256_M128*>(z1)));
+            z16 = _mm_xor_si128(z16, _mm_loadu_si128(reinterpret_cast<const GF256_M128*>(z1 + 16)));
+        }
+        _mm_storeu_si128(reinterpret_cast<GF256_M128*>(z1), z0);
+        _mm_storeu_si128(reinterpret_cast<GF256_M128*>(z1 + 16), z16);
+
+        bytes -= 32, x1 += 32, z1 += 32;
+    }
+
+    gf65536_muladd_portable(z1, y, x1, bytes, accumulate);
+}
+
+static GF65536_TARGET_SSSE3 void gf65536_mul_mem_ssse3(uint8_t * z1, const uint8_t * x1,
+                                                       uint16_t y, int bytes)
+{
+    gf65536_muladd_ssse3(z1, y, x1, bytes, false);
+}
+
+static GF65536_TARGET_SSSE3 void gf65536_muladd_mem_ssse3(uint8_t * GF256_RESTRICT z1, uint16_t y,
+                                                          const uint8_t * GF256_RESTRICT x1, int bytes)
+{
+    gf65536_muladd_ssse3(z1, y, x1, bytes, true);
+}
+
+#endif // GF256_TARGET_MOBILE
+
+
+//------------------------------------------------------------------------------
+// AVX2 Kernels
+//
+// The 256-bit pack and unpack instructions work within each 128-bit lane,
+// and the unpack exactly undoes the lane order of the pack, so this is the
+// SSSE3 kernel with wider registers.
+
+#if defined(GF256_TRY_AVX2)
+
+// Separate the low bytes and the high bytes of 32 words in a and b
+static GF256_FORCE_INLINE GF65536_TARGET_AVX2 void gf65536_split_avx2(
+    const GF256_M256& a, const GF256_M256& b, GF256_M256& lo, GF256_M256& hi)
+{
+    const GF256_M256 byte_mask = _mm256_set1_epi16(0x00ff);
+    lo = _mm256_packus_epi16(_mm256_and_si256(a, byte_mask), _mm256_and_si256(b, byte_mask));
+    hi = _mm256_packus_epi16(_mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8));
+}
+
+static GF256_FORCE_INLINE GF65536_TARGET_AVX2 void gf65536_muladd_avx2(
+    uint8_t * z1, uint16_t y, const uint8_t * x1, int bytes, bool accumulate)
+{
+    GF256_M128 lo_tables128[4], hi_tables128[4];
+    gf65536_load_tables_ssse3(y, lo_tables128, hi_tables128);
+
+    GF256_M256 lo_tables[4], hi_tables[4];
+    for (int k = 0; k < 4; ++k)
+    {
+        lo_tables[k] = _mm256_broadcastsi128_si256(lo_tables128[k]);
+        hi_tables[k] = _mm256_broadcastsi128_si256(hi_tables128[k]);
+    }
+
+    const GF256_M256 clr_mask = _mm256_set1_epi8(0x0f);
+
+    // Handle multiples of 64 bytes
+    while (bytes >= 64)
+    {
+        const GF256_M256 a = _mm256_loadu_si256(reinterpret_cast<const GF256_M256*>(x1));
+        const GF256_M256 b = _mm256_loadu_si256(reinterpret_cast<const GF256_M256*>(x1 + 32));
+
+        GF256_M256 lo, hi;
+        gf65536_split_avx2(a, b, lo, hi);
+
+        const GF256_M256 n0 = _mm256_and_si256(lo, clr_mask);
+        const GF256_M256 n1 = _mm256_and_si256(_mm256_srli_epi64(lo, 4), clr_mask);
+        const GF256_M256 n2 = _mm256_and_si256(hi, clr_mask);
+        const GF256_M256 n3 = _mm256_and_si256(_mm256_srli_epi64(hi, 4), clr_mask);
+
+        GF256_M256 p_lo = _mm256_xor_si256(_mm256_shuffle_epi8(lo_tables[0], n0), _mm256_shuffle_epi8(lo_tables[1], n1));
+        p_lo = _mm256_xor_si256(p_lo, _mm256_xor_si256(_mm256_shuffle_epi8(lo_tables[2], n2), _mm256_shuffle_epi8(lo_tables[3], n3)));
+        GF256_M256 p_hi = _mm256_xor_si256(_mm256_shuffle_epi8(hi_tables[0], n0), _mm256_shuffle_epi8(hi_tables[1], n1));
+        p_hi = _mm256_xor_si256(p_hi, _mm256_xor_si256(_mm256_shuffle_epi8(hi_tables[2], n2), _mm256_shuffle_epi8(hi_tables[3], n3)));
+
+        GF256_M256 z0 = _mm256_unpacklo_epi8(p_lo, p_hi);
+        GF256_M256 z32 = _mm256_unpackhi_epi8(p_lo, p_hi);
+        if (accumulate)
+        {
+            z0 = _mm256_xor_si256(z0, _mm256_loadu_si256(reinterpret_cast<const GF256_M256*>(z1)));
+            z32 = _mm256_xor_si256(z32, _mm256_loadu_si256(reinterpret_cast<const GF256_M256*>(z1 + 32)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<GF256_M256*>(z1), z0);
+        _mm256_storeu_si256(reinterpret_cast<GF256_M256*>(z1 + 32), z32);
+
+        bytes -= 64, x1 += 64, z1 += 64;
+    }
+
+    gf65536_muladd_portable(z1, y, x1, bytes, accumulate);
+}
+
+static GF65536_TARGET_AVX2 void gf65536_mul_mem_avx2(uint8_t * z1, const uint8_t * x1,
+                                                     uint16_t y, int bytes)
+{
+    gf65536_muladd_avx2(z1, y, x1, bytes, false);
+}
+
+static GF65536_TARGET_AVX2 void gf65536_muladd_mem_avx2(uint8_t * GF256_RESTRICT z1, uint16_t y,
+                                                        const uint8_t * GF256_RESTRICT x1, int bytes)
+{
+    gf65536_muladd_avx2(z1, y, x1, bytes, true);
+}
+
+#endif // GF256_TRY_AVX2
+
+
+//------------------------------------------------------------------------------
+// GFNI Kernels
+
+#if defined(GF256_TRY_GFNI) && defined(GF256_TRY_AVX2)
+
+static GF256_FORCE_INLINE GF65536_TARGET_GFNI void gf65536_muladd_gfni(
+    uint8_t * z1, uint16_t y, const uint8_t * x1, int bytes, bool accumulate)
+{
+    const gf65536_affine_tables tables = gf65536_get_affine(y);
+
+    const GF256_M256 lo_from_lo = _mm256_set1_epi64x((long long)tables.LoFromLo);
+    const GF256_M256 lo_from_hi = _mm256_set1_epi64x((long long)tables.LoFromHi);
+    const GF256_M256 hi_from_lo = _mm256_set1_epi64x((long long)tables.HiFromLo);
+    const GF256_M256 hi_from_hi = _mm256_set1_epi64x((long long)tables.HiFromHi);
+
+    // Handle multiples of 64 bytes
+    while (bytes >= 64)
+    {
+        const GF256_M256 a = _mm256_loadu_si256(reinterpret_cast<const GF256_M256*>(x1));
+        const GF256_M256 b = _mm256_loadu_si256(reinterpret_cast<const GF256_M256*>(x1 + 32));
+
+        GF256_M256 lo, hi;
+        gf65536_split_avx2(a, b, lo, hi);
+
+        const GF256_M256 p_lo = _mm256_xor_si256(_mm256_gf2p8affine_epi64_epi8(lo, lo_from_lo, 0),
+                                                 _mm256_gf2p8affine_epi64_epi8(hi, lo_from_hi, 0));
+        const GF256_M256 p_hi = _mm256_xor_si256(_mm256_gf2p8affine_epi64_epi8(lo, hi_from_lo, 0),
+                                                 _mm256_gf2p8affine_epi64_epi8(hi, hi_from_hi, 0));
+
+        GF256_M256 z0 = _mm256_unpacklo_epi8(p_lo, p_hi);
+        GF256_M256 z32 = _mm256_unpackhi_epi8(p_lo, p_hi);
+        if (accumulate)
+        {
+            z0 = _mm256_xor_si256(z0, _mm256_loadu_si256(reinterpret_cast<const GF256_M256*>(z1)));
+            z32 = _mm256_xor_si256(z32, _mm256_loadu_si256(reinterpret_cast<const GF256_M256*>(z1 + 32)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<GF256_M256*>(z1), z0);
+        _mm256_storeu_si256(reinterpret_cast<GF256_M256*>(z1 + 32), z32);
+
+        bytes -= 64, x1 += 64, z1 += 64;
+    }
+
+    gf65536_muladd_portable(z1, y, x1, bytes, accumulate);
+}
+
+static GF65536_TARGET_GFNI void gf65536_mul_mem_gfni(uint8_t * z1, const uint8_t * x1,
+                                                     uint16_t y, int bytes)
+{
+    gf65536_muladd_gfni(z1, y, x1, bytes, false);
+}
+
+static GF65536_TARGET_GFNI void gf65536_muladd_mem_gfni(uint8_t * GF256_RESTRICT z1, uint16_t y,
+                                                        const uint8_t * GF256_RESTRICT x1, int bytes)
+{
+    gf65536_muladd_gfni(z1, y, x1, bytes, true);
+}
+
+#endif // GF256_TRY_GFNI
+
+
+//------------------------------------------------------------------------------
+// NEON Kernels
+//
+// The de-interleaving loads and interleaving stores split the low and high
+// bytes of 16 words directly.
+
+#if defined(GF65536_TRY_NEON)
+
+static GF256_FORCE_INLINE void gf65536_muladd_neon(
+    uint8_t * z1, uint16_t y, const uint8_t * x1, int bytes, bool accumulate)
+{
+    const gf65536_mul_tables& t0 = NibbleTables[0][y & 15];
+    const gf65536_mul_tables& t1 = NibbleTables[1][(y >> 4) & 15];
+    const gf65536_mul_tables& t2 = NibbleTables[2][(y >> 8) & 15];
+    const gf65536_mul_tables& t3 = NibbleTables[3][y >> 12];
+
+    GF256_M128 lo_tables[4], hi_tables[4];
+    for (int k = 0; k < 4; ++k)
+    {
+        lo_tables[k] = veorq_u8(veorq_u8(vld1q_u8(t0.Lo[k]), vld1q_u8(t1.Lo[k])),
+                                veorq_u8(vld1q_u8(t2.Lo[k]), vld1q_u8(t3.Lo[k])));
+        hi_tables[k] = veorq_u8(veorq_u8(vld1q_u8(t0.Hi[k]), vld1q_u8(t1.Hi[k])),
+                                veorq_u8(vld1q_u8(t2.Hi[k]), vld1q_u8(t3.Hi[k])));
+    }
+
+    const GF256_M128 clr_mask = vdupq_n_u8(0x0f);
+
+    // Handle multiples of 32 bytes
+    while (bytes >= 32)
+    {
+        const uint8x16x2_t x = vld2q_u8(x1);
+
+        const GF256_M128 n0 = vandq_u8(x.val[0], clr_mask);
+        const GF256_M128 n1 = vshrq_n_u8(x.val[0], 4);
+        const GF256_M128 n2 = vandq_u8(x.val[1], clr_mask);
+        const GF256_M128 n3 = vshrq_n_u8(x.val[1], 4);
+
+        uint8x16x2_t p;
+        p.val[0] = veorq_u8(veorq_u8(vqtbl1q_u8(lo_tables[0], n0), vqtbl1q_u8(lo_tables[1], n1)),
+                            veorq_u8(vqtbl1q_u8(lo_tables[2], n2), vqtbl1q_u8(lo_tables[3], n3)));
+        p.val[1] = veorq_u8(veorq_u8(vqtbl1q_u8(hi_tables[0], n0), vqtbl1q_u8(hi_tables[1], n1)),
+                            veorq_u8(vqtbl1q_u8(hi_tables[2], n2), vqtbl1q_u8(hi_tables[3], n3)));
+
+        if (accumulate)
+        {
+            const uint8x16x2_t z = vld2q_u8(z1);
+            p.val[0] = veorq_u8(p.val[0], z.val[0]);
+            p.val[1] = veorq_u8(p.val[1], z.val[1]);
+        }
+        vst2q_u8(z1, p);
+
+        bytes -= 32, x1 += 32, z1 += 32;
+    }
+
+    gf65536_muladd_portable(z1, y, x1, bytes, accumulate);
+}
+
+static void gf65536_mul_mem_neon(uint8_t * z1, const uint8_t * x1,
+                                 uint16_t y, int bytes)
+{
+    gf65536_muladd_neon(z1, y, x1, bytes, false);
+}
+
+static void gf65536_muladd_mem_neon(uint8_t * GF256_RESTRICT z1, uint16_t y,
+                                    const uint8_t * GF256_RESTRICT x1, int bytes)
+{
+    gf65536_muladd_neon(z1, y, x1, bytes, true);
+}
+
+#endif // GF65536_TRY_NEON
+
+
+//------------------------------------------------------------------------------
+// Kernel Table
+
+// MulMem loads each word of x1[] before storing to the same offset of z1[],
+// so it takes z1 == x1 to scale a buffer in place
+struct gf65536_kernels
+{
+    void (*MulMem)(uint8_t * z1, const uint8_t * x1, uint16_t y, int bytes);
+    void (*MulAddMem)(uint8_t * GF256_RESTRICT z1, uint16_t y, const uint8_t * GF256_RESTRICT x1, int bytes);
+};
+
+// Kernels for each gf256 backend, filled in by gf65536_init()
+static gf65536_kernels Kernels[GF256_BACKEND_COUNT];
+
+// Returns the kernels that go with a gf256 backend, falling back to the widest compiled-in match
+static gf65536_kernels gf65536_find_kernels(gf256_backend backend)
+{
+    gf65536_kernels kernels = { gf65536_mul_mem_scalar, gf65536_muladd_mem_scalar };
+
+    switch (backend)
+    {
+#if defined(GF256_TRY_GFNI) && defined(GF256_TRY_AVX2)
+    case GF256_BACKEND_GFNI:
+    case GF256_BACKEND_GFNI512:
+        kernels.MulMem = gf65536_mul_mem_gfni;
+        kernels.MulAddMem = gf65536_muladd_mem_gfni;
+        break;
+#endif // GF256_TRY_GFNI
+#if defined(GF256_TRY_AVX2)
+# if !defined(GF256_TRY_GFNI)
+    case GF256_BACKEND_GFNI:
+    case GF256_BACKEND_GFNI512:
+# endif
+    case GF256_BACKEND_AVX2:
+        kernels.MulMem = gf65536_mul_mem_avx2;
+        kernels.MulAddMem = gf65536_muladd_mem_avx2;
+        break;
+#endif // GF256_TRY_AVX2
+#if !defined(GF256_TARGET_MOBILE)
+    case GF256_BACKEND_SSSE3:
+        kernels.MulMem = gf65536_mul_mem_ssse3;
+        kernels.MulAddMem = gf65536_muladd_mem_ssse3;
+        break;
+#endif // GF256_TARGET_MOBILE
+#if defined(GF65536_TRY_NEON)
+    case GF256_BACKEND_NEON:
+    case GF256_BACKEND_NEON4X:
+    case GF256_BACKEND_SVE2:
+        kernels.MulMem = gf65536_mul_mem_neon;
+        kernels.MulAddMem = gf65536_muladd_mem_neon;
+        break;
+#endif // GF65536_TRY_NEON
+    default:
+        break;
+    }
+
+    return kernels;
+}
+
+// Check the kernels against gf65536_mul() over lengths that exercise every tail
+static bool gf65536_self_test(const gf65536_kernels& kernels)
+{
+    static const int kTestBytes = 64 + 32 + 16 + 8 + 4 + 2;
+    uint8_t x[kTestBytes], z[kTestBytes], expected[kTestBytes];
+
+    for (int i = 0; i < kTestBytes; ++i)
+    {
+        x[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+
+    static const uint16_t kTestValues[4] = { 2, 0x8000, 0x1234, 0xffff };
+    for (int t = 0; t < 4; ++t)
+    {
+        const uint16_t y = kTestValues[t];
+
+        for (int i = 0; i < kTestBytes; i += 2)
+        {
+            const uint16_t product = gf65536_mul(static_cast<uint16_t>(x[i] | (x[i + 1] << 8)), y);
+            expected[i] = static_cast<uint8_t>(product);
+            expected[i + 1] = static_cast<uint8_t>(product >> 8);
+        }
+
+        kernels.MulMem(z, x, y, kTestBytes);
+        if (memcmp(z, expected, kTestBytes) != 0)
+            return false;
+
+        // Adding the same product again cancels it
+        kernels.MulAddMem(z, y, x, kTestBytes);
+        for (int i = 0; i < kTestBytes; ++i)
+        {
+            if (z[i] != 0)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+//------------------------------------------------------------------------------
+// Initialization
+
+extern "C" int gf65536_init_(int version)
+{
+    if (version != GF65536_VERSION)
+        return -1; // User's header does not match library version.
+
+    // Avoid multiple initialization
+    if (Initialized)
+        return 0;
+
+    const int gf256Result = gf256_init();
+    if (gf256Result != 0)
+        return gf256Result;
+
+    if (!gf65536_explog_init())
+        return -3; // Polynomial is not primitive
+
+    gf65536_tables_init();
+
+    // Self-test the kernels of every backend this CPU supports
+    for (int i = 0; i < GF256_BACKEND_COUNT; ++i)
+    {
+        const gf256_backend backend = static_cast<gf256_backend>(i);
+        Kernels[i] = gf65536_find_kernels(backend);
+
+        if (gf256_backend_available(backend) && !gf65536_self_test(Kernels[i]))
+            return -3;
+    }
+
+    Initialized = true;
+    return 0;
+}
+
+
+//------------------------------------------------------------------------------
+// Operations
+
+extern "C" void gf65536_mul_mem(void * GF256_RESTRICT vz, const void * GF256_RESTRICT vx, uint16_t y, int bytes)
+{
+    // Use a single if-statement to handle special cases
+    if (y <= 1)
+    {
+        if (y == 0)
+            memset(vz, 0, bytes);
+        else if (vz != vx)
+            memcpy(vz, vx, bytes);
+        return;
+    }
+
+    Kernels[gf256_get_backend()].MulMem(reinterpret_cast<uint8_t*>(vz), reinterpret_cast<const uint8_t*>(vx), y, bytes);
+}
+
+extern "C" void gf65536_mul_mem_inplace(void * vz, uint16_t y, int bytes)
+{
+    if (y <= 1)
+    {
+        if (y == 0)
+            memset(vz, 0, bytes);
+        return;
+    }
+
+    Kernels[gf256_get_backend()].MulMem(reinterpret_cast<uint8_t*>(vz), reinterpret_cast<const uint8_t*>(vz), y, bytes);
+}
+
+extern "C" void gf65536_muladd_mem(void * GF256_RESTRICT vz, uint16_t y,
+                                   const void * GF256_RESTRICT vx, int bytes)
+{
+    // Use a single if-statement to handle special cases
+    if (y <= 1)
+    {
+        if (y == 1)
+            gf256_add_mem(vz, vx, bytes);
+        return;
+    }
+
+    Kernels[gf256_get_backend()].MulAddMem(reinterpret_cast<uint8_t*>(vz), y, reinterpret_cast<const uint8_t*>(vx), bytes);
+}
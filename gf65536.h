@@ -0,0 +1,161 @@
+/** \file
+    \brief GF(65536) Main C API Header
+    \copyright Copyright (c) 2017 Christopher A. Taylor.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+    * Neither the name of GF256 nor the names of its contributors may be
+      used to endorse or promote products derived from this software without
+      specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CAT_GF65536_H
+#define CAT_GF65536_H
+
+/** \page GF65536 GF(65536) Math Module
+
+    This module provides GF(2^^16) math for codes with more than 256 blocks.
+
+    Field elements are 16-bit words, and buffers hold them in little-endian
+    byte order, so every buffer length passed to the bulk operations must be
+    even.  Addition is still XOR, so the gf256_add*_mem() functions are used
+    for it directly.
+
+    Multiplying a buffer by a constant splits each word into four nibbles and
+    looks up the partial products with byte shuffles, using the low and high
+    bytes of 4 x 16-entry tables built for the constant.  With GFNI the same
+    product is four 8x8 bit-matrix multiplies on the low and high bytes.
+
+    The bulk operations use the kernels of the backend that gf256_init()
+    selected (or gf256_set_backend() chose), so both fields switch together.
+*/
+
+#include "gf256.h"
+
+/// Library header version
+#define GF65536_VERSION 1
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+//------------------------------------------------------------------------------
+// GF(65536) Context
+
+/// The context object stores tables required to perform library calculations
+struct gf65536_ctx
+{
+    /// Log/Exp tables.  The exp table is doubled so sums of logs need no modulus
+    uint16_t GF65536_LOG_TABLE[65536];
+    uint16_t GF65536_EXP_TABLE[65535 * 2];
+};
+
+extern gf65536_ctx GF65536Ctx;
+
+
+//------------------------------------------------------------------------------
+// Initialization
+
+/**
+    Fill in the tables and self-test the bulk kernels of every backend that
+    gf256 supports on this CPU.  This also calls gf256_init().
+
+    Returns 0 on success and other values on failure.
+*/
+extern int gf65536_init_(int version);
+#define gf65536_init() gf65536_init_(GF65536_VERSION)
+
+
+//------------------------------------------------------------------------------
+// Math Operations
+
+/// return x + y
+static GF256_FORCE_INLINE uint16_t gf65536_add(uint16_t x, uint16_t y)
+{
+    return (uint16_t)(x ^ y);
+}
+
+/// return x * y
+static GF256_FORCE_INLINE uint16_t gf65536_mul(uint16_t x, uint16_t y)
+{
+    if (x == 0 || y == 0)
+        return 0;
+    return GF65536Ctx.GF65536_EXP_TABLE[GF65536Ctx.GF65536_LOG_TABLE[x] + GF65536Ctx.GF65536_LOG_TABLE[y]];
+}
+
+/// return x / y, where y is nonzero
+static GF256_FORCE_INLINE uint16_t gf65536_div(uint16_t x, uint16_t y)
+{
+    if (x == 0)
+        return 0;
+    return GF65536Ctx.GF65536_EXP_TABLE[GF65536Ctx.GF65536_LOG_TABLE[x] + 65535 - GF65536Ctx.GF65536_LOG_TABLE[y]];
+}
+
+/// return 1 / x, where x is nonzero
+static GF256_FORCE_INLINE uint16_t gf65536_inv(uint16_t x)
+{
+    return GF65536Ctx.GF65536_EXP_TABLE[65535 - GF65536Ctx.GF65536_LOG_TABLE[x]];
+}
+
+
+//------------------------------------------------------------------------------
+// Bulk Memory Math Operations
+
+/**
+    Performs "z[] = x[] * y" in GF(65536).
+    This is the same as gf65536_div_mem() with the inverse of y.
+    bytes must be even.
+*/
+extern void gf65536_mul_mem(void * GF256_RESTRICT vz, const void * GF256_RESTRICT vx, uint16_t y, int bytes);
+
+/// Performs "z[] *= y" in GF(65536) in place.  bytes must be even.
+extern void gf65536_mul_mem_inplace(void * vz, uint16_t y, int bytes);
+
+/**
+    Performs "z[] += x[] * y" in GF(65536).
+    This is the main kernel of encoding and decoding wide codes.
+    bytes must be even.
+*/
+extern void gf65536_muladd_mem(void * GF256_RESTRICT vz, uint16_t y,
+                               const void * GF256_RESTRICT vx, int bytes);
+
+/// Performs "z[] = x[] / y" in GF(65536).  bytes must be even.
+static GF256_FORCE_INLINE void gf65536_div_mem(void * GF256_RESTRICT vz,
+                                               const void * GF256_RESTRICT vx, uint16_t y, int bytes)
+{
+    // Multiply by inverse
+    gf65536_mul_mem(vz, vx, gf65536_inv(y), bytes);
+}
+
+/// Performs "z[] /= y" in GF(65536) in place.  bytes must be even.
+static GF256_FORCE_INLINE void gf65536_div_mem_inplace(void * vz, uint16_t y, int bytes)
+{
+    // Multiply by inverse
+    gf65536_mul_mem_inplace(vz, gf65536_inv(y), bytes);
+}
+
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // CAT_GF65536_H
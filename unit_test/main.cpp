@@ -32,6 +32,9 @@
 #endif
 
 #include <iostream>
+#include <thread>
+#include <atomic>
+#include <stdio.h>
 using namespace std;
 
 #ifdef _MSC_VER
@@ -40,6 +43,14 @@ using namespace std;
 
 
 #include "../cm256.h"
+#include "../cm65536.h"
+#include "../cm256_file.h"
+
+// The fixed-layout codec requires C++14
+#if __cplusplus >= 201402L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L)
+    #define CM256_TEST_FIXED_CODEC
+    #include "../cm256_codec.h"
+#endif
 
 #include <Windows.h>
 
@@ -73,162 +84,2809 @@ void initializeBlocks(cm256_block originals[256], int blockCount, int blockBytes
     }
 }
 
-bool validateSolution(cm256_block_t* blocks, int blockCount, int blockBytes)
+bool validateSolution(cm256_block_t* blocks, int blockCount, int blockBytes)
+{
+    uint8_t seen[256] = { 0 };
+
+    for (int i = 0; i < blockCount; ++i)
+    {
+        uint8_t index = blocks[i].Index;
+
+        if (index >= blockCount)
+        {
+            return false;
+        }
+
+        if (seen[index])
+        {
+            return false;
+        }
+
+        seen[index] = 1;
+
+        for (int j = 0; j < blockBytes; ++j)
+        {
+            const uint8_t expected = (uint8_t)(index + j * 13);
+            uint8_t* blockData = (uint8_t*)blocks[i].Block;
+            if (blockData[j] != expected)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Originals filled by initializeBlocks(), their recovery blocks, and block
+// descriptors that start out pointing at the originals
+struct TestStripe
+{
+    cm256_encoder_params Params;
+    uint8_t* OriginalData;
+    uint8_t* RecoveryData;
+
+    // Copies of recovery blocks handed to the decoder, one slot per recovery row
+    uint8_t* ReceivedData;
+
+    cm256_block Blocks[256];
+
+    TestStripe(int originalCount, int recoveryCount, int blockBytes)
+    {
+        Params.OriginalCount = originalCount;
+        Params.RecoveryCount = recoveryCount;
+        Params.BlockBytes = blockBytes;
+        OriginalData = new uint8_t[originalCount * blockBytes];
+        RecoveryData = new uint8_t[recoveryCount * blockBytes];
+        ReceivedData = new uint8_t[recoveryCount * blockBytes];
+        ResetBlocks();
+        initializeBlocks(Blocks, originalCount, blockBytes);
+    }
+    ~TestStripe()
+    {
+        delete[] OriginalData;
+        delete[] RecoveryData;
+        delete[] ReceivedData;
+    }
+    TestStripe(const TestStripe&) = delete;
+    TestStripe& operator=(const TestStripe&) = delete;
+
+    uint8_t* Original(int originalIndex) const
+    {
+        return OriginalData + originalIndex * Params.BlockBytes;
+    }
+    uint8_t* Recovery(int recoveryIndex) const
+    {
+        return RecoveryData + recoveryIndex * Params.BlockBytes;
+    }
+
+    // Returns true if cm256_encode() succeeds
+    bool Encode()
+    {
+        return cm256_encode(Params, Blocks, RecoveryData) == 0;
+    }
+
+    // Point every descriptor back at its original
+    void ResetBlocks()
+    {
+        for (int i = 0; i < Params.OriginalCount; ++i)
+        {
+            Blocks[i].Block = Original(i);
+            Blocks[i].Index = cm256_get_original_block_index(Params, i);
+        }
+    }
+
+    // Replace an original with a copy of a recovery block, so RecoveryData
+    // survives decoding in place
+    void Receive(int originalIndex, int recoveryIndex)
+    {
+        uint8_t* received = ReceivedData + recoveryIndex * Params.BlockBytes;
+        memcpy(received, Recovery(recoveryIndex), Params.BlockBytes);
+        Blocks[originalIndex].Block = received;
+        Blocks[originalIndex].Index = cm256_get_recovery_block_index(Params, recoveryIndex);
+    }
+
+    // Returns true if the descriptors hold every original exactly once
+    bool Validate()
+    {
+        return validateSolution(Blocks, Params.OriginalCount, Params.BlockBytes);
+    }
+};
+
+
+bool ExampleFileUsage()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    cm256_encoder_params params;
+
+    // Number of bytes per file block
+    params.BlockBytes = 1296;
+
+    // Number of blocks
+    params.OriginalCount = 100;
+
+    // Number of additional recovery blocks generated by encoder
+    params.RecoveryCount = 30;
+
+    // Size of the original file
+    static const int OriginalFileBytes = params.OriginalCount * params.BlockBytes;
+
+    // Allocate and fill the original file data
+    uint8_t* originalFileData = new uint8_t[OriginalFileBytes];
+    for (int i = 0; i < OriginalFileBytes; ++i)
+    {
+        originalFileData[i] = (uint8_t)i;
+    }
+
+    // Pointers to data
+    cm256_block blocks[256];
+    for (int i = 0; i < params.OriginalCount; ++i)
+    {
+        blocks[i].Block = originalFileData + i * params.BlockBytes;
+    }
+
+    // Recovery data
+    uint8_t* recoveryBlocks = new uint8_t[params.RecoveryCount * params.BlockBytes];
+
+    // Generate recovery data
+    if (cm256_encode(params, blocks, recoveryBlocks))
+    {
+        return false;
+    }
+
+    // Initialize the indices
+    for (int i = 0; i < params.OriginalCount; ++i)
+    {
+        blocks[i].Index = cm256_get_original_block_index(params, i);
+    }
+
+    //// Simulate loss of data, substituting a recovery block in its place ////
+    for (int i = 0; i < params.RecoveryCount && i < params.OriginalCount; ++i)
+    {
+        blocks[i].Block = recoveryBlocks + params.BlockBytes * i; // First recovery block
+        blocks[i].Index = cm256_get_recovery_block_index(params, i); // First recovery block index
+    }
+    //// Simulate loss of data, substituting a recovery block in its place ////
+
+    if (cm256_decode(params, blocks))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < params.RecoveryCount && i < params.OriginalCount; ++i)
+    {
+        uint8_t* block = (uint8_t*)blocks[i].Block;
+        int index = blocks[i].Index;
+
+        for (int j = 0; j < params.BlockBytes; ++j)
+        {
+            const uint8_t expected = (uint8_t)(j + index * params.BlockBytes);
+            if (block[j] != expected)
+            {
+                return false;
+            }
+        }
+    }
+
+    delete[] originalFileData;
+    delete[] recoveryBlocks;
+
+    return true;
+}
+
+bool CheckMemSwap()
+{
+    unsigned char buffa[16 + 8 + 4 + 3];
+    memset(buffa, 1, sizeof(buffa));
+    unsigned char buffb[16 + 8 + 4 + 3];
+    memset(buffb, 2, sizeof(buffb));
+
+    gf256_memswap(buffa, buffb, (int)sizeof(buffa));
+
+    for (int i = 0; i < (int)sizeof(buffa); ++i)
+    {
+        if (buffa[i] != 2)
+        {
+            return false;
+        }
+        if (buffb[i] != 1)
+        {
+            return false;
+        }
+    }
+
+    gf256_memswap(buffa, buffb, (int)sizeof(buffa));
+
+    for (int i = 0; i < (int)sizeof(buffa); ++i)
+    {
+        if (buffa[i] != 1)
+        {
+            return false;
+        }
+        if (buffb[i] != 2)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Shift-and-add multiply, which depends on no tables
+static uint8_t ReferenceMul(uint8_t x, uint8_t y)
+{
+    unsigned product = 0, a = x;
+    for (; y; y >>= 1, a <<= 1)
+    {
+        if (a & 0x100)
+        {
+            a ^= GF256Ctx.Polynomial;
+        }
+        if (y & 1)
+        {
+            product ^= a;
+        }
+    }
+    return (uint8_t)product;
+}
+
+// The scalar math must agree with the reference however the tables were built
+bool FieldTablesTest()
+{
+    if (gf256_init())
+    {
+        return false;
+    }
+
+    for (int x = 0; x < 256; ++x)
+    {
+        for (int y = 0; y < 256; ++y)
+        {
+            const uint8_t product = ReferenceMul((uint8_t)x, (uint8_t)y);
+            if (gf256_mul((uint8_t)x, (uint8_t)y) != product ||
+                (y != 0 && gf256_div(product, (uint8_t)y) != x))
+            {
+                cout << "Field tables failed for x=" << x << " y=" << y << endl;
+                return false;
+            }
+        }
+
+        if (gf256_sqr((uint8_t)x) != ReferenceMul((uint8_t)x, (uint8_t)x) ||
+            (x != 0 && ReferenceMul((uint8_t)x, gf256_inv((uint8_t)x)) != 1))
+        {
+            return false;
+        }
+    }
+
+    return gf256_inv(0) == 0;
+}
+
+// Check the multi-source kernels against a byte-at-a-time sum of products,
+// with a guard byte after z to catch writes past the end
+static bool CheckMultiKernels(const uint8_t* pool, int poolStride, int count, int bytes)
+{
+    uint8_t y[256];
+    const void* srcs[256];
+    for (int j = 0; j < count; ++j)
+    {
+        // Include the 0 and 1 coefficients, and sources at every alignment
+        y[j] = (uint8_t)(j == 1 ? 1 : j * 37);
+        srcs[j] = pool + j * poolStride + j % 16;
+    }
+
+    uint8_t* base = new uint8_t[bytes + 1];
+    uint8_t* actual = new uint8_t[bytes + 1];
+    uint8_t* expected = new uint8_t[bytes + 1];
+
+    for (int i = 0; i <= bytes; ++i)
+    {
+        base[i] = (uint8_t)(i * 13 + count);
+    }
+
+    bool success = true;
+
+    for (int accumulate = 0; accumulate < 2 && success; ++accumulate)
+    {
+        for (int i = 0; i < bytes; ++i)
+        {
+            uint8_t sum = accumulate ? base[i] : 0;
+            for (int j = 0; j < count; ++j)
+            {
+                sum ^= gf256_mul(static_cast<const uint8_t*>(srcs[j])[i], y[j]);
+            }
+            expected[i] = sum;
+        }
+        expected[bytes] = base[bytes];
+
+        memcpy(actual, base, bytes + 1);
+        if (accumulate)
+        {
+            gf256_muladd_multi_mem(actual, y, srcs, count, bytes);
+        }
+        else
+        {
+            gf256_mul_multi_mem(actual, y, srcs, count, bytes);
+        }
+
+        if (0 != memcmp(actual, expected, bytes + 1))
+        {
+            cout << (accumulate ? "gf256_muladd_multi_mem" : "gf256_mul_multi_mem") << " failed for "
+                 << count << " sources of " << bytes << " bytes" << endl;
+            success = false;
+        }
+    }
+
+    delete[] base;
+    delete[] actual;
+    delete[] expected;
+
+    return success;
+}
+
+bool MultiKernelTest()
+{
+    if (gf256_init())
+    {
+        return false;
+    }
+
+    // Source counts around the kernel unroll and register limits, and lengths
+    // around the 16-, 32- and 64-byte loops
+    static const int kCounts[] = { 1, 2, 3, 4, 5, 7, 8, 9, 16, 17, 64, 255 };
+    static const int kBytes[] = { 0, 1, 15, 16, 17, 31, 33, 63, 64, 65, 100, 1000, 4097 };
+    static const int kMaxBytes = 4097;
+    static const int kStride = kMaxBytes + 16;
+
+    uint8_t* pool = new uint8_t[255 * kStride];
+    for (int i = 0; i < 255 * kStride; ++i)
+    {
+        pool[i] = (uint8_t)((i * 131) ^ (i >> 8));
+    }
+
+    bool success = true;
+    for (int c = 0; c < 12 && success; ++c)
+    {
+        for (int b = 0; b < 13 && success; ++b)
+        {
+            success = CheckMultiKernels(pool, kStride, kCounts[c], kBytes[b]);
+        }
+    }
+
+    delete[] pool;
+
+    return success;
+}
+
+// Check the strip-tiled cm256_encode() against encoding each recovery block
+// whole with cm256_encode_block(), and against threaded ranges that do not
+// start on strip boundaries
+static bool CheckTiledEncode(int originalCount, int recoveryCount, int blockBytes)
+{
+    TestStripe stripe(originalCount, recoveryCount, blockBytes);
+    const cm256_encoder_params params = stripe.Params;
+
+    uint8_t* actual = new uint8_t[recoveryCount * blockBytes];
+
+    bool success = stripe.Encode();
+
+    for (int j = 0; j < recoveryCount && success; ++j)
+    {
+        uint8_t* block = actual + j * blockBytes;
+        cm256_encode_block(params, stripe.Blocks, cm256_get_recovery_block_index(params, j), block);
+        if (0 != memcmp(block, stripe.Recovery(j), blockBytes))
+        {
+            success = false;
+        }
+    }
+
+    cm256_threading threading = { 3, nullptr, nullptr };
+    memset(actual, 0, recoveryCount * blockBytes);
+    if (success &&
+        (cm256_encode_mt(params, stripe.Blocks, actual, &threading) ||
+         0 != memcmp(actual, stripe.RecoveryData, recoveryCount * blockBytes)))
+    {
+        success = false;
+    }
+
+    delete[] actual;
+
+    return success;
+}
+
+bool TiledEncodeTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    // Strips of 23808 bytes for k=10, and the 1024-byte minimum for k=250,
+    // each with a partial last strip
+    return CheckTiledEncode(10, 3, 100003) &&
+           CheckTiledEncode(10, 6, 23808 * 2) &&
+           CheckTiledEncode(250, 4, 5000) &&
+           CheckTiledEncode(100, 100, 3000) &&
+           CheckTiledEncode(10, 2, 100003) &&
+           CheckTiledEncode(10, 1, 100003);
+}
+
+bool EncoderContextTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    TestStripe stripe(10, 4, 1200);
+    const cm256_encoder_params params = stripe.Params;
+
+    cm256_encoder_ctx* ctx = nullptr;
+    if (cm256_encoder_create(params, &ctx))
+    {
+        return false;
+    }
+
+    uint8_t* actual = new uint8_t[params.RecoveryCount * params.BlockBytes];
+
+    bool success = true;
+
+    for (int trial = 0; trial < 10 && success; ++trial)
+    {
+        for (int i = 0; i < params.BlockBytes * params.OriginalCount; ++i)
+        {
+            stripe.OriginalData[i] = (uint8_t)(i * 7 + trial);
+        }
+
+        if (!stripe.Encode() ||
+            cm256_encoder_encode(ctx, stripe.Blocks, actual))
+        {
+            success = false;
+            break;
+        }
+
+        if (0 != memcmp(stripe.RecoveryData, actual, params.RecoveryCount * params.BlockBytes))
+        {
+            success = false;
+        }
+
+        const int recoveryIndex = trial % params.RecoveryCount;
+        cm256_encoder_encode_block(ctx, stripe.Blocks, cm256_get_recovery_block_index(params, recoveryIndex), actual);
+
+        if (0 != memcmp(stripe.Recovery(recoveryIndex), actual, params.BlockBytes))
+        {
+            success = false;
+        }
+    }
+
+    cm256_encoder_free(ctx);
+
+    delete[] actual;
+
+    return success;
+}
+
+static bool CheckDecoderContext(cm256_decoder_ctx* ctx, cm256_encoder_params params, int lost, int trial)
+{
+    TestStripe stripe(params.OriginalCount, params.RecoveryCount, params.BlockBytes);
+
+    bool success = stripe.Encode();
+
+    // Replace 'lost' originals, rotating with the trial, by recovery blocks
+    for (int i = 0; i < lost; ++i)
+    {
+        stripe.Receive((trial + i * 3) % params.OriginalCount, (trial + i) % params.RecoveryCount);
+    }
+
+    if (success && cm256_decoder_decode(ctx, stripe.Blocks))
+    {
+        success = false;
+    }
+
+    return success && stripe.Validate();
+}
+
+// Decode one stripe through the cache with loss pattern 'pattern', and check the
+// hit and miss counts afterwards
+static bool CheckCachedDecode(cm256_decoder_cache* cache, int pattern, uint64_t hits, uint64_t misses)
+{
+    // Patterns of 3, 4 and 5 losses, so replacing an entry may grow its matrix
+    static const int kLost[3] = { 3, 4, 5 };
+
+    TestStripe stripe(20, 6, 333);
+    bool success = stripe.Encode();
+
+    for (int i = 0; i < kLost[pattern]; ++i)
+    {
+        stripe.Receive(pattern + i * 3, (pattern + i) % 6);
+    }
+
+    success = success && cm256_decode_cached(stripe.Params, stripe.Blocks, cache) == 0 && stripe.Validate();
+
+    uint64_t actualHits = 0, actualMisses = 0;
+    cm256_decoder_cache_stats(cache, &actualHits, &actualMisses);
+
+    return success && actualHits == hits && actualMisses == misses;
+}
+
+bool DecoderCacheTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    cm256_decoder_cache* cache = nullptr;
+    if (cm256_decoder_cache_create(2, &cache))
+    {
+        return false;
+    }
+
+    TestStripe stripe(20, 6, 333);
+    bool success = cm256_decode_cached(stripe.Params, stripe.Blocks, nullptr) == -3;
+
+    // Two entries with patterns A = 0, B = 1 and C = 2
+    success = success &&
+              CheckCachedDecode(cache, 0, 0, 1) && // A misses
+              CheckCachedDecode(cache, 0, 1, 1) && // A hits
+              CheckCachedDecode(cache, 1, 1, 2) && // B misses
+              CheckCachedDecode(cache, 0, 2, 2) && // A hits, so B is least recently used
+              CheckCachedDecode(cache, 2, 2, 3) && // C misses and evicts B
+              CheckCachedDecode(cache, 0, 3, 3) && // A was kept
+              CheckCachedDecode(cache, 1, 3, 4) && // B was evicted, and replaces C
+              CheckCachedDecode(cache, 2, 3, 5) && // C was evicted, and replaces A
+              CheckCachedDecode(cache, 1, 4, 5) && // B hits in the reused entry
+              CheckCachedDecode(cache, 2, 5, 5);   // C hits in the reused entry
+
+    // Two losses replaced by the parity row and one other row need no matrix,
+    // so they neither look up nor insert a pattern
+    success = success && stripe.Encode();
+    stripe.Receive(4, 0);
+    stripe.Receive(9, 3);
+    success = success && cm256_decode_cached(stripe.Params, stripe.Blocks, cache) == 0 && stripe.Validate();
+
+    uint64_t hits = 0, misses = 0;
+    cm256_decoder_cache_stats(cache, &hits, &misses);
+    success = success && hits == 5 && misses == 5;
+
+    cm256_decoder_cache_free(cache);
+
+    return success;
+}
+
+bool DecoderContextTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    cm256_encoder_params params;
+    params.BlockBytes = 1000;
+    params.OriginalCount = 100;
+    params.RecoveryCount = 60;
+
+    // Invalid arguments
+    cm256_decoder_ctx* ctx = nullptr;
+    if (cm256_decoder_create(params, nullptr, nullptr) != -3 ||
+        cm256_decoder_decode(nullptr, nullptr) != -3)
+    {
+        return false;
+    }
+    params.OriginalCount = 200;
+    if (cm256_decoder_create(params, nullptr, &ctx) != -2 || ctx)
+    {
+        return false;
+    }
+    params.OriginalCount = 100;
+    cm256_decoder_free(nullptr);
+
+    cm256_decoder_cache* cache = nullptr;
+    if (cm256_decoder_cache_create(4, &cache))
+    {
+        return false;
+    }
+
+    bool success = true;
+
+    // With and without a cache, vary the loss count so the matrix moves between
+    // the stack and the heap, and repeat patterns so the cache is hit
+    for (int useCache = 0; useCache < 2 && success; ++useCache)
+    {
+        if (cm256_decoder_create(params, useCache ? cache : nullptr, &ctx))
+        {
+            success = false;
+            break;
+        }
+
+        static const int kLost[] = { 3, 60, 1, 2, 50, 0, 3, 60 };
+        for (int trial = 0; trial < 16 && success; ++trial)
+        {
+            success = CheckDecoderContext(ctx, params, kLost[trial / 2], trial / 2);
+        }
+
+        // Repeated row index
+        cm256_block pair[100];
+        for (int i = 0; i < params.OriginalCount; ++i)
+        {
+            pair[i].Block = nullptr;
+            pair[i].Index = (uint8_t)(i < 2 ? 0 : i);
+        }
+        if (success && cm256_decoder_decode(ctx, pair) != -5)
+        {
+            success = false;
+        }
+
+        cm256_decoder_free(ctx);
+    }
+
+    uint64_t hits = 0, misses = 0;
+    cm256_decoder_cache_stats(cache, &hits, &misses);
+    if (hits == 0 || misses == 0)
+    {
+        success = false;
+    }
+
+    cm256_decoder_cache_free(cache);
+
+    return success;
+}
+
+bool StreamEncoderTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    TestStripe stripe(10, 4, 1200);
+    const cm256_encoder_params params = stripe.Params;
+
+    cm256_stream_encoder* encoder = nullptr;
+    if (cm256_stream_encoder_create(params, &encoder))
+    {
+        return false;
+    }
+
+    uint8_t* actual = new uint8_t[params.RecoveryCount * params.BlockBytes];
+
+    bool success = true;
+
+    for (int trial = 0; trial < 10 && success; ++trial)
+    {
+        for (int i = 0; i < params.BlockBytes * params.OriginalCount; ++i)
+        {
+            stripe.OriginalData[i] = (uint8_t)(i * 11 + trial);
+        }
+
+        if (!stripe.Encode() ||
+            cm256_stream_encoder_init(encoder, actual))
+        {
+            success = false;
+            break;
+        }
+
+        // Add the originals out of order
+        for (int i = 0; i < params.OriginalCount; ++i)
+        {
+            const int originalIndex = (i * 3 + trial) % params.OriginalCount;
+            if (cm256_stream_encoder_add(encoder, originalIndex, stripe.Original(originalIndex)))
+            {
+                success = false;
+            }
+        }
+
+        if (cm256_stream_encoder_finalize(encoder) ||
+            0 != memcmp(stripe.RecoveryData, actual, params.RecoveryCount * params.BlockBytes))
+        {
+            success = false;
+        }
+    }
+
+    cm256_stream_encoder_free(encoder);
+
+    delete[] actual;
+
+    return success;
+}
+
+bool StreamDecoderTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    TestStripe stripe(10, 4, 1200);
+    const cm256_encoder_params params = stripe.Params;
+
+    cm256_stream_decoder* decoder = nullptr;
+    if (cm256_stream_decoder_create(params, &decoder))
+    {
+        return false;
+    }
+
+    bool success = stripe.Encode();
+
+    for (int trial = 0; trial < params.RecoveryCount && success; ++trial)
+    {
+        // Lose the first 'trial + 1' originals and replace them with recovery blocks
+        const int lost = trial + 1;
+        stripe.ResetBlocks();
+        for (int i = 0; i < lost; ++i)
+        {
+            stripe.Receive(i, params.RecoveryCount - 1 - i);
+        }
+
+        cm256_stream_decoder_init(decoder);
+
+        // Blocks arrive out of order, mixing originals and recovery blocks
+        for (int i = 0; i < params.OriginalCount; ++i)
+        {
+            const int blockIndex = (params.OriginalCount - 1 - i * 3 % params.OriginalCount + trial) % params.OriginalCount;
+            if (cm256_stream_decoder_add_block(decoder, &stripe.Blocks[blockIndex]))
+            {
+                success = false;
+            }
+        }
+
+        if (cm256_stream_decoder_finalize(decoder) || !stripe.Validate())
+        {
+            success = false;
+        }
+    }
+
+    cm256_stream_decoder_free(decoder);
+
+    return success;
+}
+
+bool BatchCodecTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    cm256_encoder_params params;
+    params.BlockBytes = 300;
+    params.OriginalCount = 8;
+    params.RecoveryCount = 3;
+
+    static const int kStripes = 5;
+    const int stripeOriginalBytes = params.OriginalCount * params.BlockBytes;
+    const int stripeRecoveryBytes = params.RecoveryCount * params.BlockBytes;
+
+    uint8_t* orig_data = new uint8_t[kStripes * stripeOriginalBytes];
+    uint8_t* expected = new uint8_t[kStripes * stripeRecoveryBytes];
+    uint8_t* actual = new uint8_t[kStripes * stripeRecoveryBytes];
+
+    for (int i = 0; i < kStripes * stripeOriginalBytes; ++i)
+    {
+        orig_data[i] = (uint8_t)(i * 5 + 1);
+    }
+
+    cm256_block blocks[kStripes * 256];
+    for (int i = 0; i < kStripes * params.OriginalCount; ++i)
+    {
+        blocks[i].Block = orig_data + i * params.BlockBytes;
+    }
+
+    bool success = true;
+
+    for (int stripe = 0; stripe < kStripes; ++stripe)
+    {
+        if (cm256_encode(params, blocks + stripe * params.OriginalCount, expected + stripe * stripeRecoveryBytes))
+        {
+            success = false;
+        }
+    }
+
+    if (cm256_encode_batch(params, blocks, actual, kStripes) ||
+        0 != memcmp(expected, actual, kStripes * stripeRecoveryBytes))
+    {
+        success = false;
+    }
+
+    // Lose the same two originals from every stripe
+    for (int stripe = 0; stripe < kStripes; ++stripe)
+    {
+        cm256_block* stripeBlocks = blocks + stripe * params.OriginalCount;
+
+        for (int i = 0; i < params.OriginalCount; ++i)
+        {
+            stripeBlocks[i].Index = cm256_get_original_block_index(params, i);
+        }
+        for (int i = 0; i < 2; ++i)
+        {
+            stripeBlocks[i * 3].Block = actual + stripe * stripeRecoveryBytes + (i + 1) * params.BlockBytes;
+            stripeBlocks[i * 3].Index = cm256_get_recovery_block_index(params, i + 1);
+        }
+    }
+
+    if (success && cm256_decode_batch(params, blocks, kStripes))
+    {
+        success = false;
+    }
+
+    for (int stripe = 0; stripe < kStripes && success; ++stripe)
+    {
+        cm256_block* stripeBlocks = blocks + stripe * params.OriginalCount;
+
+        for (int i = 0; i < 2; ++i)
+        {
+            const cm256_block& block = stripeBlocks[i * 3];
+            if (0 != memcmp(block.Block, orig_data + stripe * stripeOriginalBytes + block.Index * params.BlockBytes, params.BlockBytes))
+            {
+                success = false;
+            }
+        }
+    }
+
+    delete[] orig_data;
+    delete[] expected;
+    delete[] actual;
+
+    return success;
+}
+
+bool DecodeIntoTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    TestStripe stripe(12, 4, 1000);
+    const cm256_encoder_params params = stripe.Params;
+
+    uint8_t* output_data = new uint8_t[params.OriginalCount * params.BlockBytes];
+
+    bool success = stripe.Encode();
+
+    for (int lost = 1; lost <= params.RecoveryCount && success; ++lost)
+    {
+        void* outputs[256];
+
+        // Lose every third original, replacing them with the last recovery blocks
+        stripe.ResetBlocks();
+        for (int i = 0; i < params.OriginalCount; ++i)
+        {
+            outputs[i] = nullptr;
+        }
+        for (int i = 0; i < lost; ++i)
+        {
+            const int originalIndex = i * 3 + 1;
+            stripe.Receive(originalIndex, params.RecoveryCount - lost + i);
+            outputs[originalIndex] = output_data + originalIndex * params.BlockBytes;
+        }
+
+        if (cm256_decode_into(params, stripe.Blocks, outputs))
+        {
+            success = false;
+            break;
+        }
+
+        // Outputs hold the originals and the received blocks are unchanged
+        for (int i = 0; i < lost; ++i)
+        {
+            const int originalIndex = i * 3 + 1;
+            const int recoveryIndex = params.RecoveryCount - lost + i;
+            if (0 != memcmp(outputs[originalIndex], stripe.Original(originalIndex), params.BlockBytes) ||
+                stripe.Blocks[originalIndex].Index != cm256_get_recovery_block_index(params, recoveryIndex) ||
+                0 != memcmp(stripe.Blocks[originalIndex].Block, stripe.Recovery(recoveryIndex), params.BlockBytes))
+            {
+                success = false;
+            }
+        }
+    }
+
+    delete[] output_data;
+
+    return success;
+}
+
+bool ScatterGatherTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    TestStripe stripe(10, 3, 1500);
+    const cm256_encoder_params params = stripe.Params;
+
+    uint8_t* actual = new uint8_t[params.RecoveryCount * params.BlockBytes];
+
+    bool success = stripe.Encode();
+
+    // Split every block in two at a different offset
+    cm256_segment segments[256][2];
+    cm256_sg_block sg_blocks[256];
+    for (int i = 0; i < params.OriginalCount + params.RecoveryCount; ++i)
+    {
+        uint8_t* data = (i < params.OriginalCount) ?
+            stripe.Original(i) :
+            actual + (i - params.OriginalCount) * params.BlockBytes;
+        const int split = 100 + i * 97;
+
+        segments[i][0].Data = data;
+        segments[i][0].Bytes = split;
+        segments[i][1].Data = data + split;
+        segments[i][1].Bytes = params.BlockBytes - split;
+
+        sg_blocks[i].Segments = segments[i];
+        sg_blocks[i].SegmentCount = 2;
+        sg_blocks[i].Index = (unsigned char)i;
+    }
+
+    if (cm256_encode_sg(params, sg_blocks, sg_blocks + params.OriginalCount) ||
+        0 != memcmp(stripe.RecoveryData, actual, params.RecoveryCount * params.BlockBytes))
+    {
+        success = false;
+    }
+
+    // Replace the first originals with the recovery blocks and decode
+    for (int i = 0; i < params.RecoveryCount; ++i)
+    {
+        sg_blocks[i * 2] = sg_blocks[params.OriginalCount + i];
+    }
+
+    if (success && cm256_decode_sg(params, sg_blocks))
+    {
+        success = false;
+    }
+
+    for (int i = 0; i < params.RecoveryCount && success; ++i)
+    {
+        const cm256_sg_block& block = sg_blocks[i * 2];
+        if (block.Index != i * 2 ||
+            0 != memcmp(block.Segments[0].Data, stripe.Original(block.Index), block.Segments[0].Bytes) ||
+            0 != memcmp(block.Segments[1].Data, stripe.Original(block.Index) + block.Segments[0].Bytes, block.Segments[1].Bytes))
+        {
+            success = false;
+        }
+    }
+
+    delete[] actual;
+
+    return success;
+}
+
+bool BackendConsistencyTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    const gf256_backend selected = gf256_get_backend();
+    if (!gf256_backend_available(selected) ||
+        gf256_backend_available(GF256_BACKEND_COUNT) ||
+        gf256_set_backend(GF256_BACKEND_COUNT) != -1)
+    {
+        return false;
+    }
+
+    // Odd lengths and offsets exercise the tail of every kernel, up to two
+    // vectors of the widest SVE2 implementation
+    static const int kMaxBytes = 1100;
+    static const int kBufferBytes = kMaxBytes + 3;
+    uint8_t x[4][kBufferBytes];
+    uint8_t expected[9][2][kBufferBytes];
+    uint8_t actual[2][kBufferBytes];
+    const uint8_t y[3] = { 0x8e, 0x02, 0xd3 };
+
+    for (int j = 0; j < 4; ++j)
+    {
+        for (int i = 0; i < kBufferBytes; ++i)
+        {
+            x[j][i] = (uint8_t)(i * 29 + j * 71 + 5);
+        }
+    }
+
+    bool success = true;
+
+    for (int bytes = 0; bytes <= kMaxBytes && success; bytes += 1 + bytes / 16)
+    {
+        const int offset = bytes % 3;
+        const void* srcs[3] = { x[1] + offset, x[2], x[3] + offset };
+
+        for (int b = 0; b < GF256_BACKEND_COUNT && success; ++b)
+        {
+            const gf256_backend backend = (gf256_backend)b;
+            if (!gf256_backend_available(backend))
+            {
+                continue;
+            }
+            gf256_set_backend(backend);
+
+            for (int op = 0; op < 9; ++op)
+            {
+                memcpy(actual[0], x[0], kBufferBytes);
+                memcpy(actual[1], x[3], kBufferBytes);
+                uint8_t* z = actual[0] + offset;
+                uint8_t* q = actual[1] + offset;
+
+                switch (op)
+                {
+                case 0: gf256_add_mem(z, x[1], bytes); break;
+                case 1: gf256_add2_mem(z, x[1], x[2] + offset, bytes); break;
+                case 2: gf256_addset_mem(z, x[1], x[2] + offset, bytes); break;
+                case 3: gf256_mul_mem(z, x[1], y[0], bytes); break;
+                case 4: gf256_muladd_mem(z, y[1], x[1], bytes); break;
+                case 5: gf256_mul_multi_mem(z, y, srcs, 3, bytes); break;
+                case 6: gf256_muladd_multi_mem(z, y, srcs, 3, bytes); break;
+                case 7: gf256_mul_pq_multi_mem(z, q, y, srcs, 3, bytes); break;
+                default: gf256_muladd_pq_multi_mem(z, q, y, srcs, 3, bytes); break;
+                }
+
+                // The scalar backend is always available and is checked first
+                if (backend == GF256_BACKEND_SCALAR)
+                {
+                    memcpy(expected[op], actual, sizeof(actual));
+                }
+                else if (0 != memcmp(expected[op], actual, sizeof(actual)))
+                {
+                    cout << "Backend " << gf256_backend_name(backend) << " failed op " << op << " for " << bytes << " bytes" << endl;
+                    success = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    gf256_set_backend(selected);
+
+    cout << "Selected GF(256) backend: " << gf256_backend_name(gf256_get_backend()) << endl;
+
+    return success && gf256_get_backend() == selected;
+}
+
+// Encode and decode one stripe on every available backend, checking the
+// recovery blocks against the scalar backend
+static bool CheckBackendCodec(int originalCount, int recoveryCount, int lost, int blockBytes)
+{
+    TestStripe stripe(originalCount, recoveryCount, blockBytes);
+    const cm256_encoder_params params = stripe.Params;
+
+    uint8_t* actual = new uint8_t[recoveryCount * blockBytes];
+
+    const gf256_backend selected = gf256_get_backend();
+    gf256_set_backend(GF256_BACKEND_SCALAR);
+    bool success = stripe.Encode();
+
+    for (int b = 0; success && b < GF256_BACKEND_COUNT; ++b)
+    {
+        const gf256_backend backend = (gf256_backend)b;
+        if (!gf256_backend_available(backend))
+        {
+            continue;
+        }
+        gf256_set_backend(backend);
+
+        stripe.ResetBlocks();
+        if (cm256_encode(params, stripe.Blocks, actual) ||
+            0 != memcmp(actual, stripe.RecoveryData, recoveryCount * blockBytes))
+        {
+            success = false;
+        }
+
+        for (int i = 0; i < lost; ++i)
+        {
+            stripe.Receive((i * 7 + b) % originalCount, (i + b) % recoveryCount);
+        }
+        if (cm256_decode(params, stripe.Blocks) || !stripe.Validate())
+        {
+            success = false;
+        }
+
+        if (!success)
+        {
+            cout << "Backend " << gf256_backend_name(backend) << " failed for k=" << originalCount
+                 << " m=" << recoveryCount << " with " << blockBytes << " bytes" << endl;
+        }
+    }
+
+    gf256_set_backend(selected);
+
+    delete[] actual;
+
+    return success;
+}
+
+// The GFNI backends build one affine bit matrix per coefficient, so check
+// every coefficient on each of them against the scalar tables
+bool GFNIBackendTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    static const gf256_backend kBackends[2] = { GF256_BACKEND_GFNI, GF256_BACKEND_GFNI512 };
+
+    // Two 512-bit vectors plus a tail
+    static const int kBytes = 64 * 2 + 37;
+    uint8_t x[kBytes];
+    uint8_t z[kBytes + 1];
+    uint8_t expected[kBytes + 1];
+    for (int i = 0; i < kBytes; ++i)
+    {
+        x[i] = (uint8_t)(i * 7 + 3);
+    }
+
+    const gf256_backend selected = gf256_get_backend();
+    bool success = true;
+
+    for (int b = 0; b < 2 && success; ++b)
+    {
+        if (!gf256_backend_available(kBackends[b]))
+        {
+            cout << "Skipping backend " << gf256_backend_name(kBackends[b]) << ": not available" << endl;
+            continue;
+        }
+        success = (gf256_set_backend(kBackends[b]) == 0);
+
+        for (int y = 0; y < 256 && success; ++y)
+        {
+            // z[] = x[] * y, and then z[] += x[] * y, which cancels back to zero
+            for (int i = 0; i < kBytes; ++i)
+            {
+                expected[i] = gf256_mul(x[i], (uint8_t)y);
+            }
+            expected[kBytes] = z[kBytes] = 0xee;
+
+            gf256_mul_mem(z, x, (uint8_t)y, kBytes);
+            success = (0 == memcmp(z, expected, kBytes + 1));
+
+            memset(expected, 0, kBytes);
+            gf256_muladd_mem(z, (uint8_t)y, x, kBytes);
+            success = success && (0 == memcmp(z, expected, kBytes + 1));
+
+            // Two sources with coefficients y and y + 1
+            const uint8_t coeffs[2] = { (uint8_t)y, (uint8_t)(y + 1) };
+            const void* srcs[2] = { x, x + 1 };
+            for (int i = 0; i < kBytes - 1; ++i)
+            {
+                expected[i] = gf256_mul(x[i], coeffs[0]) ^ gf256_mul(x[i + 1], coeffs[1]);
+            }
+            expected[kBytes - 1] = 0xee;
+            z[kBytes - 1] = 0xee;
+            gf256_mul_multi_mem(z, coeffs, srcs, 2, kBytes - 1);
+            success = success && (0 == memcmp(z, expected, kBytes));
+
+            if (!success)
+            {
+                cout << "Backend " << gf256_backend_name(kBackends[b]) << " failed for y = " << y << endl;
+            }
+        }
+    }
+
+    gf256_set_backend(selected);
+
+    return success;
+}
+
+bool BackendCodecTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    static const char* const kUnavailable = " (not available)";
+    for (int b = 0; b < GF256_BACKEND_COUNT; ++b)
+    {
+        const gf256_backend backend = (gf256_backend)b;
+        cout << "Backend " << gf256_backend_name(backend)
+             << (gf256_backend_available(backend) ? "" : kUnavailable) << endl;
+    }
+
+    // Cover the m=1, m=2 and general decoders, with block sizes around the
+    // 64-byte unrolled loops and the two-vector SVE2 loops
+    static const int kBlockBytes[] = { 1, 15, 63, 64, 65, 129, 255, 511, 513, 1023, 4099 };
+
+    bool success = true;
+    for (int s = 0; s < 11 && success; ++s)
+    {
+        const int bytes = kBlockBytes[s];
+        success = CheckBackendCodec(12, 1, 1, bytes) &&
+                  CheckBackendCodec(12, 2, 2, bytes) &&
+                  CheckBackendCodec(12, 6, 5, bytes) &&
+                  CheckBackendCodec(100, 30, 30, bytes);
+    }
+
+    return success;
+}
+
+#ifdef CM256_TEST_FIXED_CODEC
+
+template <int K, int M>
+static bool CheckFixedCodec(int blockBytes)
+{
+    typedef cm256::Codec<K, M> TestCodec;
+
+    TestStripe stripe(K, M, blockBytes);
+
+    uint8_t* actual = new uint8_t[M * blockBytes];
+
+    const void* originals[K];
+    void* recovery[M];
+    for (int i = 0; i < K; ++i)
+    {
+        originals[i] = stripe.Original(i);
+    }
+    for (int i = 0; i < M; ++i)
+    {
+        recovery[i] = actual + i * blockBytes;
+    }
+
+    bool success = stripe.Encode();
+
+    TestCodec::Encode(originals, recovery, blockBytes);
+    if (0 != memcmp(stripe.RecoveryData, actual, M * blockBytes))
+    {
+        success = false;
+    }
+
+    // Lose up to M originals, trying a different set of recovery blocks each time
+    for (int trial = 0; trial < 8 && success; ++trial)
+    {
+        const int losses = 1 + trial % M;
+
+        stripe.ResetBlocks();
+        for (int i = 0; i < losses; ++i)
+        {
+            const int originalIndex = (trial * 3 + i * 5) % K;
+            if (stripe.Blocks[originalIndex].Index >= K)
+            {
+                break;
+            }
+            stripe.Receive(originalIndex, (trial + i) % M);
+        }
+
+        cm256_block blocks[K];
+        memcpy(blocks, stripe.Blocks, sizeof(blocks));
+        if (TestCodec::Decode(blocks, blockBytes) ||
+            !validateSolution(blocks, K, blockBytes))
+        {
+            success = false;
+        }
+    }
+
+    // Repeated indices are rejected
+    cm256_block duplicates[K];
+    for (int i = 0; i < K; ++i)
+    {
+        duplicates[i].Block = stripe.OriginalData;
+        duplicates[i].Index = (unsigned char)(K + M);
+    }
+    if (TestCodec::Decode(duplicates, blockBytes) != -5)
+    {
+        success = false;
+    }
+
+    delete[] actual;
+
+    return success;
+}
+
+bool FixedCodecTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    return CheckFixedCodec<10, 4>(1200) &&
+           CheckFixedCodec<16, 4>(999) &&
+           CheckFixedCodec<5, 1>(64) &&
+           CheckFixedCodec<1, 3>(100) &&
+           CheckFixedCodec<2, 2>(33) &&
+           CheckFixedCodec<6, 2>(300);
+}
+
+#endif // CM256_TEST_FIXED_CODEC
+
+// Encodes with two recovery rows and decodes every pair of lost originals
+static bool CheckDoubleErasure(int originalCount, int recoveryCount, int blockBytes)
+{
+    TestStripe stripe(originalCount, recoveryCount, blockBytes);
+    const cm256_encoder_params params = stripe.Params;
+
+    uint8_t* expected = new uint8_t[blockBytes];
+
+    bool success = stripe.Encode();
+
+    // Every row matches the single row encoder
+    for (int i = 0; i < recoveryCount && success; ++i)
+    {
+        cm256_encode_block(params, stripe.Blocks, cm256_get_recovery_block_index(params, i), expected);
+        if (0 != memcmp(expected, stripe.Recovery(i), blockBytes))
+        {
+            success = false;
+        }
+    }
+
+    // The parity row is received either first or second, paired with the last row
+    const int pairs[2][2] = { { 0, recoveryCount - 1 }, { recoveryCount - 1, 0 } };
+
+    for (int a = 0; a < originalCount && success; ++a)
+    {
+        for (int b = a + 1; b < originalCount && success; b += 1 + originalCount / 8)
+        {
+            for (int pair = 0; pair < 2 && success; ++pair)
+            {
+                stripe.ResetBlocks();
+                stripe.Receive(a, pairs[pair][0]);
+                stripe.Receive(b, pairs[pair][1]);
+
+                if (cm256_decode(params, stripe.Blocks) || !stripe.Validate())
+                {
+                    success = false;
+                }
+            }
+        }
+    }
+
+    delete[] expected;
+
+    return success;
+}
+
+bool DoubleErasureTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    return CheckDoubleErasure(2, 2, 1000) &&
+           CheckDoubleErasure(7, 2, 333) &&
+           CheckDoubleErasure(40, 2, 129) &&
+           CheckDoubleErasure(200, 2, 65) &&
+           CheckDoubleErasure(9, 5, 250);
+}
+
+// Encodes in XOR mode and decodes with various losses
+static bool CheckXorMode(int originalCount, int recoveryCount, int blockBytes)
+{
+    TestStripe stripe(originalCount, recoveryCount, blockBytes);
+    const cm256_encoder_params params = stripe.Params;
+
+    uint8_t* parity = new uint8_t[recoveryCount * blockBytes];
+
+    bool success = (0 == cm256_xor_encode(params, stripe.Blocks, stripe.RecoveryData));
+
+    // A single recovery row is the parity, which is the same in both modes
+    if (success && recoveryCount == 1)
+    {
+        cm256_encode(params, stripe.Blocks, parity);
+        if (0 != memcmp(parity, stripe.RecoveryData, blockBytes))
+        {
+            success = false;
+        }
+    }
+
+    // Lose up to recoveryCount originals, replacing them with different recovery rows
+    for (int trial = 0; trial < 12 && success; ++trial)
+    {
+        int losses = 1 + trial % recoveryCount;
+        if (losses > originalCount)
+        {
+            losses = originalCount;
+        }
+
+        stripe.ResetBlocks();
+        for (int i = 0; i < losses; ++i)
+        {
+            stripe.Receive((trial * 7 + i * (originalCount / losses)) % originalCount, (trial * 3 + i) % recoveryCount);
+        }
+
+        if (cm256_xor_decode(params, stripe.Blocks) || !stripe.Validate())
+        {
+            success = false;
+        }
+    }
+
+    delete[] parity;
+
+    return success;
+}
+
+// Reuses XOR schedules across encodes and repeated loss patterns
+static bool CheckXorCached(int originalCount, int recoveryCount, int blockBytes)
+{
+    TestStripe stripe(originalCount, recoveryCount, blockBytes);
+    const cm256_encoder_params params = stripe.Params;
+
+    uint8_t* expected = new uint8_t[recoveryCount * blockBytes];
+
+    cm256_xor_cache* cache = nullptr;
+    bool success = (0 == cm256_xor_cache_create(2, &cache)) &&
+                   (0 == cm256_xor_encode(params, stripe.Blocks, expected));
+
+    // The second encode hits, and both match the uncached recovery data
+    for (int pass = 0; pass < 2 && success; ++pass)
+    {
+        memset(stripe.RecoveryData, 0, recoveryCount * blockBytes);
+        if (cm256_xor_encode_cached(params, stripe.Blocks, stripe.RecoveryData, cache) ||
+            0 != memcmp(expected, stripe.RecoveryData, recoveryCount * blockBytes))
+        {
+            success = false;
+        }
+    }
+
+    // Patterns A, B, A: only the first two build a schedule
+    const int patterns[3] = { 0, 1, 0 };
+    for (int trial = 0; trial < 3 && success; ++trial)
+    {
+        const int first = patterns[trial];
+
+        stripe.ResetBlocks();
+        for (int i = 0; i < recoveryCount; ++i)
+        {
+            stripe.Receive(first + 2 * i, recoveryCount - 1 - i);
+        }
+
+        // The repeat lists the same originals in another order
+        if (trial == 2)
+        {
+            const cm256_block last = stripe.Blocks[originalCount - 1];
+            stripe.Blocks[originalCount - 1] = stripe.Blocks[originalCount - 2];
+            stripe.Blocks[originalCount - 2] = last;
+        }
+
+        if (cm256_xor_decode_cached(params, stripe.Blocks, cache) || !stripe.Validate())
+        {
+            success = false;
+        }
+    }
+
+    uint64_t hits = 0, misses = 0;
+    cm256_xor_cache_stats(cache, &hits, &misses);
+    if (hits != 2 || misses != 3)
+    {
+        success = false;
+    }
+
+    if (cm256_xor_decode_cached(params, stripe.Blocks, nullptr) != -3)
+    {
+        success = false;
+    }
+
+    cm256_xor_cache_free(cache);
+    delete[] expected;
+
+    return success;
+}
+
+bool XorModeTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    // The block size must split into 8 packets
+    cm256_encoder_params params;
+    params.BlockBytes = 100;
+    params.OriginalCount = 4;
+    params.RecoveryCount = 2;
+    uint8_t data[6 * 100] = {};
+    cm256_block blocks[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        blocks[i].Block = data + i * params.BlockBytes;
+        blocks[i].Index = (unsigned char)i;
+    }
+    if (cm256_xor_encode(params, blocks, data + 4 * params.BlockBytes) != -9 ||
+        cm256_xor_decode(params, blocks) != -9)
+    {
+        return false;
+    }
+
+    return CheckXorMode(2, 2, 8) &&
+           CheckXorMode(10, 4, 1296) &&
+           CheckXorMode(30, 8, 4096) &&
+           CheckXorMode(100, 3, 800) &&
+           CheckXorMode(12, 1, 96) &&
+           CheckXorMode(1, 2, 64) &&
+           CheckXorMode(200, 50, 64) &&
+           CheckXorCached(12, 3, 1024) &&
+           CheckXorCached(40, 8, 64);
+}
+
+bool PartialRangeDecodeTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    TestStripe stripe(12, 4, 4096);
+    const cm256_encoder_params params = stripe.Params;
+
+    bool success = stripe.Encode();
+
+    // The window must fit in the block
+    if (cm256_decode_range(params, stripe.Blocks, -1, 10) != -1 ||
+        cm256_decode_range(params, stripe.Blocks, 4000, 97) != -1)
+    {
+        success = false;
+    }
+
+    const int windows[][2] = { { 0, 100 }, { 1000, 777 }, { 4000, 96 }, { 0, 4096 }, { 17, 1 } };
+
+    for (int w = 0; w < 5 && success; ++w)
+    {
+        const int offset = windows[w][0];
+        const int bytes = windows[w][1];
+        const int lost = 1 + w % params.RecoveryCount;
+
+        stripe.ResetBlocks();
+        for (int i = 0; i < lost; ++i)
+        {
+            stripe.Receive(i * 3 + w % 3, (w + i) % params.RecoveryCount);
+        }
+
+        if (cm256_decode_range(params, stripe.Blocks, offset, bytes))
+        {
+            success = false;
+            break;
+        }
+
+        // The window holds the original data and the rest is unchanged
+        for (int i = 0; i < lost; ++i)
+        {
+            const int originalIndex = i * 3 + w % 3;
+            const uint8_t* block = static_cast<const uint8_t*>(stripe.Blocks[originalIndex].Block);
+            const uint8_t* original = stripe.Original(originalIndex);
+            const uint8_t* recovery = stripe.Recovery((w + i) % params.RecoveryCount);
+            const int end = offset + bytes;
+
+            if (stripe.Blocks[originalIndex].Index != originalIndex ||
+                0 != memcmp(block + offset, original + offset, bytes) ||
+                0 != memcmp(block, recovery, offset) ||
+                0 != memcmp(block + end, recovery + end, params.BlockBytes - end))
+            {
+                success = false;
+            }
+        }
+    }
+
+    return success;
+}
+
+// Loses 'lost' originals and recovers each of them, plus one received original, on its own
+static bool CheckSubsetDecode(int originalCount, int recoveryCount, int lost, int blockBytes)
+{
+    TestStripe stripe(originalCount, recoveryCount, blockBytes);
+    const cm256_encoder_params params = stripe.Params;
+
+    uint8_t* output_data = new uint8_t[2 * blockBytes];
+    uint8_t* expected = new uint8_t[recoveryCount * blockBytes];
+
+    bool success = stripe.Encode();
+
+    // Replace originals with the recovery rows in reverse, so the parity row is last
+    for (int i = 0; i < lost; ++i)
+    {
+        stripe.Receive((i * 7 + 2) % originalCount, lost - 1 - i);
+    }
+
+    for (int i = 0; i < lost && success; ++i)
+    {
+        const unsigned char wanted[2] = {
+            (unsigned char)((i * 7 + 2) % originalCount),
+            (unsigned char)((i * 7 + 3) % originalCount)
+        };
+        void* outputs[2] = { output_data, output_data + blockBytes };
+        const int wantedCount = (originalCount > 1 && i == 0) ? 2 : 1;
+
+        if (cm256_decode_subset(params, stripe.Blocks, wanted, wantedCount, outputs))
+        {
+            success = false;
+            break;
+        }
+
+        for (int w = 0; w < wantedCount; ++w)
+        {
+            if (0 != memcmp(outputs[w], stripe.Original(wanted[w]), blockBytes))
+            {
+                success = false;
+            }
+        }
+    }
+
+    // The received blocks are unchanged
+    for (int i = 0; i < lost && success; ++i)
+    {
+        if (0 != memcmp(stripe.Blocks[(i * 7 + 2) % originalCount].Block, stripe.Recovery(lost - 1 - i), blockBytes))
+        {
+            success = false;
+        }
+    }
+    cm256_block check[256];
+    for (int i = 0; i < originalCount; ++i)
+    {
+        check[i].Block = stripe.Original(i);
+    }
+    if (success)
+    {
+        cm256_encode(params, check, expected);
+        if (0 != memcmp(expected, stripe.RecoveryData, recoveryCount * blockBytes))
+        {
+            success = false;
+        }
+    }
+
+    // Wanted indices must be originals
+    const unsigned char badWanted = (unsigned char)originalCount;
+    void* badOutput = output_data;
+    if (cm256_decode_subset(params, stripe.Blocks, &badWanted, 1, &badOutput) != -5)
+    {
+        success = false;
+    }
+
+    delete[] output_data;
+    delete[] expected;
+
+    return success;
+}
+
+bool SubsetDecodeTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    return CheckSubsetDecode(20, 6, 5, 1000) &&
+           CheckSubsetDecode(20, 6, 6, 333) &&
+           CheckSubsetDecode(8, 1, 1, 64) &&
+           CheckSubsetDecode(1, 3, 1, 100) &&
+           CheckSubsetDecode(200, 56, 40, 128);
+}
+
+// Regenerates every recovery block from a mix of originals and recovery blocks
+static bool CheckRepair(int originalCount, int recoveryCount, int lost, int blockBytes)
+{
+    TestStripe stripe(originalCount, recoveryCount, blockBytes);
+    const cm256_encoder_params params = stripe.Params;
+
+    uint8_t* output_data = new uint8_t[recoveryCount * blockBytes];
+
+    bool success = stripe.Encode();
+
+    // Receive the last 'lost' recovery blocks in place of some originals
+    for (int i = 0; i < lost; ++i)
+    {
+        stripe.Receive((i * 5 + 1) % originalCount, recoveryCount - 1 - i);
+    }
+
+    unsigned char targets[256];
+    void* outputs[256];
+    for (int i = 0; i < recoveryCount; ++i)
+    {
+        targets[i] = cm256_get_recovery_block_index(params, i);
+        outputs[i] = output_data + i * blockBytes;
+    }
+
+    if (success && cm256_repair(params, stripe.Blocks, targets, recoveryCount, outputs))
+    {
+        success = false;
+    }
+    if (0 != memcmp(output_data, stripe.RecoveryData, recoveryCount * blockBytes))
+    {
+        success = false;
+    }
+
+    // Targets must be recovery indices
+    const unsigned char badTarget = 0;
+    if (cm256_repair(params, stripe.Blocks, &badTarget, 1, outputs) != -5)
+    {
+        success = false;
+    }
+
+    delete[] output_data;
+
+    return success;
+}
+
+bool RepairTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    return CheckRepair(10, 4, 0, 1000) &&
+           CheckRepair(10, 4, 2, 1000) &&
+           CheckRepair(10, 4, 3, 77) &&
+           CheckRepair(20, 2, 1, 256) &&
+           CheckRepair(6, 1, 0, 64) &&
+           CheckRepair(1, 3, 1, 100) &&
+           CheckRepair(128, 128, 100, 64);
+}
+
+// Returns true if every decode entry point rejects the damaged block list
+static bool RejectsBlocks(TestStripe& stripe)
+{
+    const cm256_encoder_params params = stripe.Params;
+    uint8_t* output_data = new uint8_t[params.BlockBytes];
+    void* outputs[1] = { output_data };
+    const unsigned char wanted = 0;
+    const unsigned char target = cm256_get_recovery_block_index(params, 0);
+
+    cm256_decoder_ctx* ctx = nullptr;
+    bool success = (cm256_decoder_create(params, nullptr, &ctx) == 0) &&
+                   (cm256_decoder_decode(ctx, stripe.Blocks) == -5) &&
+                   (cm256_decode_subset(params, stripe.Blocks, &wanted, 1, outputs) == -5) &&
+                   (cm256_repair(params, stripe.Blocks, &target, 1, outputs) == -5) &&
+                   (cm256_decode(params, stripe.Blocks) == -5);
+    cm256_decoder_free(ctx);
+
+    delete[] output_data;
+
+    return success;
+}
+
+static bool CheckBadIndices(int originalCount, int recoveryCount)
+{
+    TestStripe stripe(originalCount, recoveryCount, 1000);
+    const cm256_encoder_params params = stripe.Params;
+
+    bool success = stripe.Encode();
+
+    // The same recovery block received twice
+    if (recoveryCount >= 1 && originalCount >= 2)
+    {
+        stripe.Receive(0, recoveryCount - 1);
+        stripe.Receive(1, recoveryCount - 1);
+        success = success && RejectsBlocks(stripe);
+    }
+
+    // A row past the last recovery block
+    stripe.ResetBlocks();
+    stripe.Blocks[originalCount - 1].Index = (unsigned char)(originalCount + recoveryCount);
+    success = success && RejectsBlocks(stripe);
+
+    stripe.ResetBlocks();
+    stripe.Blocks[0].Index = 255;
+    success = success && RejectsBlocks(stripe);
+
+    // Distinct recovery blocks still decode
+    stripe.ResetBlocks();
+    for (int i = 0; i < recoveryCount && i < originalCount; ++i)
+    {
+        stripe.Receive(i, recoveryCount - 1 - i);
+    }
+    success = success && (cm256_decode(params, stripe.Blocks) == 0) && stripe.Validate();
+
+    return success;
+}
+
+bool BlockIndexTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    return CheckBadIndices(10, 4) &&
+           CheckBadIndices(8, 1) &&
+           CheckBadIndices(2, 2) &&
+           CheckBadIndices(100, 100);
+}
+
+bool DeltaUpdateTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    const int shapes[][2] = { { 10, 4 }, { 1, 3 }, { 50, 1 }, { 3, 200 } };
+    bool success = true;
+
+    for (int shape = 0; shape < 4 && success; ++shape)
+    {
+        TestStripe stripe(shapes[shape][0], shapes[shape][1], 10000);
+        const cm256_encoder_params params = stripe.Params;
+
+        uint8_t* expected = new uint8_t[params.RecoveryCount * params.BlockBytes];
+        uint8_t* newData = new uint8_t[params.BlockBytes];
+        uint8_t* delta = new uint8_t[params.BlockBytes];
+
+        success = stripe.Encode();
+
+        // Several writes, each checked against a full re-encode
+        const int writes[][2] = { { 0, 4096 }, { 5000, 5000 }, { 123, 1 }, { 0, 10000 }, { 9000, 0 } };
+        for (int w = 0; w < 5 && success; ++w)
+        {
+            const int originalIndex = (w * 3) % params.OriginalCount;
+            const int offset = writes[w][0];
+            const int bytes = writes[w][1];
+            uint8_t* block = stripe.Original(originalIndex) + offset;
+
+            for (int i = 0; i < bytes; ++i)
+            {
+                newData[i] = (uint8_t)(i * 29 + w);
+                delta[i] = block[i] ^ newData[i];
+            }
+
+            // Alternate between the two forms
+            const int result = (w % 2 == 0) ?
+                cm256_update(params, originalIndex, block, newData, offset, bytes, stripe.RecoveryData) :
+                cm256_update_delta(params, originalIndex, delta, offset, bytes, stripe.RecoveryData);
+            memcpy(block, newData, bytes);
+
+            cm256_encode(params, stripe.Blocks, expected);
+            if (result != 0 || 0 != memcmp(expected, stripe.RecoveryData, params.RecoveryCount * params.BlockBytes))
+            {
+                success = false;
+            }
+        }
+
+        // Invalid index and range
+        if (cm256_update_delta(params, params.OriginalCount, delta, 0, 10, stripe.RecoveryData) != -5 ||
+            cm256_update_delta(params, 0, delta, 9999, 2, stripe.RecoveryData) != -1)
+        {
+            success = false;
+        }
+
+        delete[] expected;
+        delete[] newData;
+        delete[] delta;
+    }
+
+    return success;
+}
+
+static bool CheckChecksums(int originalCount, int recoveryCount, int blockBytes, int erasures)
+{
+    TestStripe stripe(originalCount, recoveryCount, blockBytes);
+    const cm256_encoder_params params = stripe.Params;
+
+    uint8_t* expected = new uint8_t[recoveryCount * blockBytes];
+
+    uint32_t crcs[256];
+    bool success = (0 == cm256_encode_crc(params, stripe.Blocks, stripe.RecoveryData, crcs)) &&
+                   (0 == cm256_encode(params, stripe.Blocks, expected)) &&
+                   (0 == memcmp(expected, stripe.RecoveryData, recoveryCount * blockBytes));
+
+    for (int i = 0; i < originalCount + recoveryCount && success; ++i)
+    {
+        const uint8_t* block = (i < originalCount) ? stripe.Original(i) : stripe.Recovery(i - originalCount);
+        if (crcs[i] != gf256_crc32c(0, block, blockBytes))
+        {
+            success = false;
+        }
+    }
+
+    // Replace the first originals with recovery blocks
+    for (int i = 0; i < erasures; ++i)
+    {
+        stripe.Receive(i, i);
+    }
+
+    uint32_t receivedCrcs[256], decodedCrcs[256];
+    if (success && 0 != cm256_decode_crc(params, stripe.Blocks, receivedCrcs, decodedCrcs))
+    {
+        success = false;
+    }
+
+    for (int i = 0; i < originalCount && success; ++i)
+    {
+        const uint32_t sent = (i < erasures) ? crcs[originalCount + i] : crcs[i];
+        if (receivedCrcs[i] != sent ||
+            decodedCrcs[i] != crcs[stripe.Blocks[i].Index])
+        {
+            success = false;
+        }
+    }
+
+    delete[] expected;
+
+    return success && stripe.Validate();
+}
+
+bool ChecksumTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    // CRC32C check value, and continuing a checksum across pieces
+    const char* check = "123456789";
+    if (gf256_crc32c(0, check, 9) != 0xe3069283 ||
+        gf256_crc32c(gf256_crc32c(0, check, 4), check + 4, 5) != 0xe3069283)
+    {
+        return false;
+    }
+
+    // The scalar backend computes the same checksums with the portable tables
+    uint8_t data[3000];
+    for (int i = 0; i < 3000; ++i)
+    {
+        data[i] = (uint8_t)(i * 131 + (i >> 3));
+    }
+    uint32_t expected[3000 / 97 + 1];
+    for (int n = 0, i = 0; n < 3000; n += 97, ++i)
+    {
+        expected[i] = gf256_crc32c(0, data + (n & 7), 3000 - n);
+    }
+
+    const gf256_backend best = gf256_get_backend();
+    bool portableMatches = (0 == gf256_set_backend(GF256_BACKEND_SCALAR)) &&
+                           gf256_crc32c(0, check, 9) == 0xe3069283 &&
+                           gf256_crc32c(gf256_crc32c(0, check, 4), check + 4, 5) == 0xe3069283;
+    for (int n = 0, i = 0; n < 3000 && portableMatches; n += 97, ++i)
+    {
+        portableMatches = (expected[i] == gf256_crc32c(0, data + (n & 7), 3000 - n));
+    }
+    gf256_set_backend(best);
+
+    if (!portableMatches)
+    {
+        return false;
+    }
+
+    return CheckChecksums(10, 4, 100000, 3) &&
+           CheckChecksums(10, 2, 100000, 2) &&
+           CheckChecksums(20, 1, 4097, 1) &&
+           CheckChecksums(1, 3, 1000, 1) &&
+           CheckChecksums(100, 30, 3000, 0) &&
+           CheckChecksums(200, 56, 3333, 56);
+}
+
+static bool CheckVerify(int originalCount, int recoveryCount, int blockBytes)
+{
+    TestStripe stripe(originalCount, recoveryCount, blockBytes);
+    const cm256_encoder_params params = stripe.Params;
+    uint8_t* recovery_data = stripe.RecoveryData;
+
+    int row = -1, offset = -1;
+    bool success = stripe.Encode() &&
+                   (0 == cm256_verify(params, stripe.Blocks, recovery_data, &row, &offset)) &&
+                   row == -1 && offset == -1;
+
+    // Corrupt the last row near the end, then an earlier byte of the first row
+    const int lastRow = recoveryCount - 1;
+    const int lastOffset = blockBytes - 3;
+    recovery_data[lastRow * blockBytes + lastOffset] ^= 0x40;
+
+    if (success && (1 != cm256_verify(params, stripe.Blocks, recovery_data, &row, &offset) ||
+                    row != lastRow || offset != lastOffset))
+    {
+        success = false;
+    }
+
+    recovery_data[blockBytes / 3] ^= 0x01;
+
+    if (success && (1 != cm256_verify(params, stripe.Blocks, recovery_data, &row, &offset) ||
+                    row != 0 || offset != blockBytes / 3))
+    {
+        success = false;
+    }
+
+    // An original changing is caught as well
+    recovery_data[blockBytes / 3] ^= 0x01;
+    recovery_data[lastRow * blockBytes + lastOffset] ^= 0x40;
+    stripe.OriginalData[originalCount * blockBytes - 1] ^= 0x80;
+
+    if (success && 1 != cm256_verify(params, stripe.Blocks, recovery_data, nullptr, nullptr))
+    {
+        success = false;
+    }
+
+    return success;
+}
+
+bool VerifyTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    return CheckVerify(10, 4, 100000) &&
+           CheckVerify(10, 2, 5000) &&
+           CheckVerify(30, 1, 2049) &&
+           CheckVerify(1, 3, 1000) &&
+           CheckVerify(200, 56, 333);
+}
+
+static bool CheckStreamingStores(int originalCount, int recoveryCount, int blockBytes)
+{
+    TestStripe stripe(originalCount, recoveryCount, blockBytes);
+    const cm256_encoder_params params = stripe.Params;
+
+    uint8_t* expected_data = new uint8_t[recoveryCount * blockBytes];
+    uint8_t* block_data = new uint8_t[blockBytes];
+
+    // Streamed output must match the cached output exactly
+    cm256_set_streaming_threshold(-1);
+    bool success = (0 == cm256_encode(params, stripe.Blocks, expected_data));
+
+    cm256_set_streaming_threshold(0);
+    success = success && stripe.Encode() &&
+              memcmp(expected_data, stripe.RecoveryData, recoveryCount * blockBytes) == 0;
+
+    for (int i = 0; success && i < recoveryCount; ++i)
+    {
+        cm256_encode_block(params, stripe.Blocks, cm256_get_recovery_block_index(params, i), block_data);
+        if (memcmp(block_data, expected_data + i * blockBytes, blockBytes) != 0)
+        {
+            success = false;
+        }
+    }
+
+    // Replace the first originals with recovery blocks and decode them back
+    const int lost = recoveryCount < originalCount ? recoveryCount : originalCount;
+    for (int i = 0; i < lost; ++i)
+    {
+        stripe.Receive(i, i);
+    }
+
+    success = success && (0 == cm256_decode(params, stripe.Blocks)) && stripe.Validate();
+
+    cm256_set_streaming_threshold(64 * 1024 * 1024);
+
+    delete[] expected_data;
+    delete[] block_data;
+
+    return success;
+}
+
+bool StreamingStoreTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    return CheckStreamingStores(10, 4, 100001) &&
+           CheckStreamingStores(10, 2, 40000) &&
+           CheckStreamingStores(30, 1, 5003) &&
+           CheckStreamingStores(1, 3, 1000) &&
+           CheckStreamingStores(100, 30, 4099) &&
+           CheckStreamingStores(200, 56, 15);
+}
+
+static bool CheckArena(int originalCount, int recoveryCount, int blockBytes, int stripeCount)
+{
+    cm256_encoder_params params;
+    params.BlockBytes = blockBytes;
+    params.OriginalCount = originalCount;
+    params.RecoveryCount = recoveryCount;
+
+    cm256_arena* arena = nullptr;
+    if (cm256_arena_create(params, stripeCount, &arena))
+    {
+        return false;
+    }
+
+    bool success = true;
+    cm256_stripe* stripes[16];
+    for (int s = 0; s < stripeCount; ++s)
+    {
+        if (cm256_arena_acquire(arena, &stripes[s]) ||
+            (uintptr_t)stripes[s]->Originals % 64 != 0 ||
+            (uintptr_t)stripes[s]->Recovery % 64 != 0 ||
+            stripes[s]->Stride % 64 != 0 || stripes[s]->Stride < blockBytes)
+        {
+            success = false;
+            break;
+        }
+    }
+
+    cm256_stripe* extra = nullptr;
+    if (success && cm256_arena_acquire(arena, &extra) != -11)
+    {
+        success = false;
+    }
+
+    // Fill every stripe differently, then encode and decode each one
+    for (int s = 0; success && s < stripeCount; ++s)
+    {
+        cm256_stripe* stripe = stripes[s];
+        for (int i = 0; i < originalCount; ++i)
+        {
+            for (int j = 0; j < blockBytes; ++j)
+            {
+                stripe->Originals[i * stripe->Stride + j] = (uint8_t)(i * 71 + j * 13 + s * 5);
+            }
+        }
+
+        if (cm256_encode(params, stripe->Blocks, stripe->Recovery))
+        {
+            success = false;
+            break;
+        }
+
+        const int lost = recoveryCount < originalCount ? recoveryCount : originalCount;
+        for (int i = 0; i < lost; ++i)
+        {
+            stripe->Blocks[i].Block = stripe->Recovery + i * blockBytes;
+            stripe->Blocks[i].Index = cm256_get_recovery_block_index(params, i);
+        }
+
+        cm256_reset_stats();
+        if (cm256_arena_decode(arena, stripe))
+        {
+            success = false;
+            break;
+        }
+
+        // The stripe supplies the decoder matrix, so the heap is never used
+        cm256_stats stats;
+        if (cm256_get_stats(&stats) == 0 && stats.HeapMatrixFallbacks != 0)
+        {
+            success = false;
+        }
+
+        for (int i = 0; success && i < originalCount; ++i)
+        {
+            const uint8_t* block = static_cast<const uint8_t*>(stripe->Blocks[i].Block);
+            const int index = stripe->Blocks[i].Index;
+            for (int j = 0; j < blockBytes; ++j)
+            {
+                if (block[j] != (uint8_t)(index * 71 + j * 13 + s * 5))
+                {
+                    success = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    // A released stripe comes back with its descriptors reset
+    if (success && (cm256_arena_release(arena, stripes[0]) ||
+                    cm256_arena_acquire(arena, &extra) ||
+                    extra != stripes[0] ||
+                    extra->Blocks[0].Block != extra->Originals ||
+                    extra->Blocks[0].Index != 0))
+    {
+        success = false;
+    }
+
+    for (int s = 0; s < stripeCount; ++s)
+    {
+        cm256_arena_release(arena, stripes[s]);
+    }
+
+    cm256_arena_free(arena);
+    return success;
+}
+
+// Several threads acquire and release a few stripes, and no stripe may be handed out twice
+static bool CheckArenaThreads()
+{
+    cm256_encoder_params params;
+    params.BlockBytes = 64;
+    params.OriginalCount = 4;
+    params.RecoveryCount = 2;
+
+    static const int kStripes = 3;
+    static const int kThreads = 4;
+    static const int kIterations = 20000;
+
+    cm256_arena* arena = nullptr;
+    if (cm256_arena_create(params, kStripes, &arena))
+    {
+        return false;
+    }
+
+    cm256_stripe* stripes[kStripes];
+    for (int s = 0; s < kStripes; ++s)
+    {
+        cm256_arena_acquire(arena, &stripes[s]);
+    }
+    for (int s = 0; s < kStripes; ++s)
+    {
+        cm256_arena_release(arena, stripes[s]);
+    }
+
+    std::atomic<int> owners[kStripes];
+    for (int s = 0; s < kStripes; ++s)
+    {
+        owners[s] = 0;
+    }
+    std::atomic<bool> failed(false);
+
+    std::thread threads[kThreads];
+    for (int t = 0; t < kThreads; ++t)
+    {
+        threads[t] = std::thread([&]() {
+            for (int n = 0; n < kIterations; ++n)
+            {
+                cm256_stripe* stripe = nullptr;
+                const int result = cm256_arena_acquire(arena, &stripe);
+                if (result == -11)
+                {
+                    continue;
+                }
+
+                int s = 0;
+                while (s < kStripes && stripes[s] != stripe)
+                {
+                    ++s;
+                }
+                if (result != 0 || s >= kStripes || owners[s].exchange(1) != 0)
+                {
+                    failed = true;
+                    return;
+                }
+
+                owners[s] = 0;
+                cm256_arena_release(arena, stripe);
+            }
+        });
+    }
+    for (int t = 0; t < kThreads; ++t)
+    {
+        threads[t].join();
+    }
+
+    cm256_arena_free(arena);
+    return !failed;
+}
+
+bool ArenaTest()
+{
+    if (cm256_init())
+    {
+        return false;
+    }
+
+    cm256_arena* arena = nullptr;
+    cm256_encoder_params params;
+    params.BlockBytes = 100;
+    params.OriginalCount = 10;
+    params.RecoveryCount = 4;
+    if (cm256_arena_create(params, 0, &arena) != -1 || arena)
+    {
+        return false;
+    }
+
+    return CheckArena(10, 4, 1001, 3) &&
+           CheckArena(10, 2, 1024, 1) &&
+           CheckArena(30, 1, 77, 2) &&
+           CheckArena(100, 60, 333, 2) &&
+           CheckArena(200, 56, 64, 4) &&
+           CheckArenaThreads();
+}
+
+// Encode, lose 'lost' originals spread over the stripe, and decode them from recoveryCount rows starting at firstRecovery
+static bool CheckWideCodec(int originalCount, int recoveryCount, int lost, int firstRecovery, int blockBytes)
+{
+    cm65536_encoder_params params;
+    params.BlockBytes = blockBytes;
+    params.OriginalCount = originalCount;
+    params.RecoveryCount = recoveryCount;
+
+    uint8_t* originals = new uint8_t[originalCount * blockBytes];
+    uint8_t* recovery = new uint8_t[recoveryCount * blockBytes];
+    uint8_t* single = new uint8_t[blockBytes];
+    cm65536_block* blocks = new cm65536_block[originalCount];
+
+    uint32_t seed = (uint32_t)(originalCount * 65537 + blockBytes);
+    for (int i = 0; i < originalCount * blockBytes; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        originals[i] = (uint8_t)(seed >> 16);
+    }
+    for (int i = 0; i < originalCount; ++i)
+    {
+        blocks[i].Block = originals + i * blockBytes;
+    }
+
+    bool success = cm65536_encode(params, blocks, recovery) == 0;
+
+    // Each recovery row must match the single-row encoder
+    for (int i = 0; success && i < recoveryCount; ++i)
+    {
+        cm65536_encode_block(params, blocks, cm65536_get_recovery_block_index(params, i), single);
+        success = memcmp(single, recovery + i * blockBytes, blockBytes) == 0;
+    }
+
+    // Replace erased originals with recovery rows
+    const int step = originalCount / lost;
+    for (int i = 0; success && i < originalCount; ++i)
+    {
+        blocks[i].Index = cm65536_get_original_block_index(params, i);
+    }
+    for (int e = 0; success && e < lost; ++e)
+    {
+        const int row = (firstRecovery + e) % recoveryCount;
+        cm65536_block* block = blocks + e * step;
+        block->Block = recovery + row * blockBytes;
+        block->Index = cm65536_get_recovery_block_index(params, row);
+    }
+
+    if (success && cm65536_decode(params, blocks))
+    {
+        success = false;
+    }
+
+    for (int i = 0; success && i < originalCount; ++i)
+    {
+        const int index = blocks[i].Index;
+        if (index >= originalCount ||
+            memcmp(blocks[i].Block, originals + index * blockBytes, blockBytes) != 0)
+        {
+            success = false;
+        }
+    }
+
+    if (!success)
+    {
+        cout << "Wide codec failed for k=" << originalCount << " m=" << recoveryCount
+             << " lost=" << lost << " bytes=" << blockBytes << endl;
+    }
+
+    delete[] blocks;
+    delete[] single;
+    delete[] recovery;
+    delete[] originals;
+    return success;
+}
+
+// Every backend must produce the same recovery data as the portable kernels
+static bool CheckWideBackends(int originalCount, int recoveryCount, int blockBytes)
+{
+    cm65536_encoder_params params;
+    params.BlockBytes = blockBytes;
+    params.OriginalCount = originalCount;
+    params.RecoveryCount = recoveryCount;
+
+    uint8_t* originals = new uint8_t[originalCount * blockBytes];
+    uint8_t* expected = new uint8_t[recoveryCount * blockBytes];
+    uint8_t* actual = new uint8_t[recoveryCount * blockBytes];
+    cm65536_block* blocks = new cm65536_block[originalCount];
+
+    for (int i = 0; i < originalCount * blockBytes; ++i)
+    {
+        originals[i] = (uint8_t)(i * 181 + (i >> 9));
+    }
+    for (int i = 0; i < originalCount; ++i)
+    {
+        blocks[i].Block = originals + i * blockBytes;
+    }
+
+    const gf256_backend selected = gf256_get_backend();
+    gf256_set_backend(GF256_BACKEND_SCALAR);
+    bool success = cm65536_encode(params, blocks, expected) == 0;
+
+    for (int b = 0; success && b < GF256_BACKEND_COUNT; ++b)
+    {
+        const gf256_backend backend = (gf256_backend)b;
+        if (!gf256_backend_available(backend))
+        {
+            continue;
+        }
+        gf256_set_backend(backend);
+
+        memset(actual, 0, recoveryCount * blockBytes);
+        if (cm65536_encode(params, blocks, actual) ||
+            memcmp(actual, expected, recoveryCount * blockBytes) != 0)
+        {
+            cout << "Wide codec mismatch for backend " << gf256_backend_name(backend) << endl;
+            success = false;
+        }
+    }
+
+    gf256_set_backend(selected);
+
+    delete[] blocks;
+    delete[] actual;
+    delete[] expected;
+    delete[] originals;
+    return success;
+}
+
+bool WideCodecTest()
+{
+    if (cm65536_init())
+    {
+        return false;
+    }
+
+    // Invalid parameters
+    uint16_t word = 0x1234;
+    cm65536_block block;
+    block.Block = &word;
+    block.Index = 0;
+    cm65536_encoder_params params;
+    params.OriginalCount = 1;
+    params.RecoveryCount = 1;
+    params.BlockBytes = 3;
+    if (cm65536_encode(params, &block, &word) != -1 || cm65536_decode(params, &block) != -1)
+    {
+        return false;
+    }
+    params.BlockBytes = 2;
+    params.OriginalCount = 60000;
+    params.RecoveryCount = 5537;
+    if (cm65536_encode(params, &block, &word) != -2)
+    {
+        return false;
+    }
+
+    // Repeated row index
+    uint16_t words[2] = { 1, 2 };
+    cm65536_block pair[2];
+    pair[0].Block = &words[0];
+    pair[0].Index = 3;
+    pair[1].Block = &words[1];
+    pair[1].Index = 3;
+    params.OriginalCount = 2;
+    params.RecoveryCount = 2;
+    if (cm65536_decode(params, pair) != -5)
+    {
+        return false;
+    }
+
+    return CheckWideBackends(300, 40, 1202) &&
+           CheckWideBackends(20, 3, 34) &&
+           CheckWideCodec(1, 3, 1, 2, 100) &&
+           CheckWideCodec(10, 1, 1, 0, 66) &&
+           CheckWideCodec(10, 4, 4, 0, 1000) &&
+           CheckWideCodec(300, 50, 20, 17, 130) &&
+           CheckWideCodec(2000, 200, 200, 0, 1200) &&
+           CheckWideCodec(3000, 100, 60, 30, 4098);
+}
+
+static bool WriteTestFile(const char* path, const uint8_t* data, size_t bytes)
+{
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        return false;
+    }
+    const bool success = fwrite(data, 1, bytes, file) == bytes;
+    return fclose(file) == 0 && success;
+}
+
+// Returns the file size, or -1 if it cannot be read into 'data' of 'maxBytes'
+static long ReadTestFile(const char* path, uint8_t* data, size_t maxBytes)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file)
+    {
+        return -1;
+    }
+    const size_t bytes = fread(data, 1, maxBytes, file);
+    fclose(file);
+    return (long)bytes;
+}
+
+bool FilePipelineTest()
 {
-    uint8_t seen[256] = { 0 };
+    if (cm256_init())
+    {
+        return false;
+    }
 
-    for (int i = 0; i < blockCount; ++i)
+    // Eight stripes, where only the first block of the last one has data
+    cm256_encoder_params params;
+    params.OriginalCount = 5;
+    params.RecoveryCount = 3;
+    params.BlockBytes = 4096;
+    const size_t stripeBytes = params.OriginalCount * params.BlockBytes;
+    const size_t fileBytes = 7 * stripeBytes + 1234;
+    const size_t crcOffset = CM256_FILE_HEADER_BYTES + 8 * params.BlockBytes;
+    const size_t shardBytes = crcOffset + 8 * 4;
+
+    const char* inputPath = "cm256_file_test.bin";
+    const char* shardPaths[3] = { "cm256_file_test.bin.0", "cm256_file_test.bin.1", "cm256_file_test.bin.2" };
+    const char* serialPaths[3] = { "cm256_file_test.bin.s0", "cm256_file_test.bin.s1", "cm256_file_test.bin.s2" };
+
+    uint8_t* original = new uint8_t[fileBytes];
+    uint8_t* data = new uint8_t[fileBytes + 1];
+    uint8_t* shards = new uint8_t[3 * shardBytes];
+    uint8_t* shard = new uint8_t[shardBytes + 1];
+    uint8_t* expected = new uint8_t[params.RecoveryCount * params.BlockBytes];
+    uint8_t* padded = new uint8_t[stripeBytes];
+
+    for (size_t i = 0; i < fileBytes; ++i)
     {
-        uint8_t index = blocks[i].Index;
+        original[i] = (uint8_t)((i * 131) ^ (i >> 9));
+    }
 
-        if (index >= blockCount)
+    cm256_threading threading;
+    threading.ThreadCount = 3;
+    threading.Scheduler = nullptr;
+    threading.SchedulerContext = nullptr;
+
+    bool success = WriteTestFile(inputPath, original, fileBytes) &&
+                   cm256_file_encode(params, inputPath, shardPaths, &threading) == 0 &&
+                   cm256_file_encode(params, inputPath, serialPaths, nullptr) == 0;
+
+    // Shards match cm256_encode() of each stripe, with the last stripe padded with zeros
+    for (int j = 0; j < params.RecoveryCount && success; ++j)
+    {
+        cm256_encoder_params header;
+        int recoveryIndex = -1;
+        uint64_t headerFileBytes = 0;
+        success = ReadTestFile(shardPaths[j], shards + j * shardBytes, shardBytes + 1) == (long)shardBytes &&
+                  ReadTestFile(serialPaths[j], shard, shardBytes + 1) == (long)shardBytes &&
+                  0 == memcmp(shard, shards + j * shardBytes, shardBytes) &&
+                  cm256_file_read_header(shardPaths[j], &header, &recoveryIndex, &headerFileBytes) == 0 &&
+                  header.OriginalCount == params.OriginalCount &&
+                  header.RecoveryCount == params.RecoveryCount &&
+                  header.BlockBytes == params.BlockBytes &&
+                  recoveryIndex == j && headerFileBytes == fileBytes;
+    }
+    for (int stripe = 0; stripe < 8 && success; ++stripe)
+    {
+        const size_t offset = stripe * stripeBytes;
+        const size_t bytes = fileBytes - offset < stripeBytes ? fileBytes - offset : stripeBytes;
+        memset(padded, 0, stripeBytes);
+        memcpy(padded, original + offset, bytes);
+
+        cm256_block blocks[256];
+        for (int i = 0; i < params.OriginalCount; ++i)
         {
-            return false;
+            blocks[i].Block = padded + i * params.BlockBytes;
         }
+        success = cm256_encode(params, blocks, expected) == 0;
 
-        if (seen[index])
+        // Each block is followed in the checksum table by its little-endian CRC32C
+        for (int j = 0; j < params.RecoveryCount && success; ++j)
         {
-            return false;
+            const uint8_t* crc = shards + j * shardBytes + crcOffset + stripe * 4;
+            success = 0 == memcmp(expected + j * params.BlockBytes,
+                                  shards + j * shardBytes + CM256_FILE_HEADER_BYTES + stripe * params.BlockBytes,
+                                  params.BlockBytes) &&
+                      gf256_crc32c(0, expected + j * params.BlockBytes, params.BlockBytes) ==
+                          (crc[0] | ((uint32_t)crc[1] << 8) | ((uint32_t)crc[2] << 16) | ((uint32_t)crc[3] << 24));
         }
+    }
 
-        seen[index] = 1;
+    // Damage two blocks of the first stripe and the data of the last one, and lose a shard
+    cm256_file_range damaged[2];
+    damaged[0].Offset = 100;
+    damaged[0].Bytes = 5000;
+    damaged[1].Offset = fileBytes - 10;
+    damaged[1].Bytes = 10;
+    memcpy(data, original, fileBytes);
+    memset(data + damaged[0].Offset, 0xcc, (size_t)damaged[0].Bytes);
+    memset(data + damaged[1].Offset, 0xcc, (size_t)damaged[1].Bytes);
+
+    cm256_file_repair_result result;
+    success = success &&
+              WriteTestFile(inputPath, data, fileBytes) &&
+              remove(shardPaths[1]) == 0 &&
+              cm256_file_repair(inputPath, shardPaths, 3, damaged, 2, &threading, &result) == 0 &&
+              result.DataBlocksRepaired == 3 &&
+              result.RecoveryShardsRebuilt == 1 &&
+              ReadTestFile(inputPath, data, fileBytes + 1) == (long)fileBytes &&
+              0 == memcmp(data, original, fileBytes) &&
+              ReadTestFile(shardPaths[1], shard, shardBytes + 1) == (long)shardBytes &&
+              0 == memcmp(shard, shards + shardBytes, shardBytes);
+
+    // Truncation loses the last block of stripe 6 and the data of stripe 7
+    success = success &&
+              WriteTestFile(inputPath, original, fileBytes - 5000) &&
+              cm256_file_repair(inputPath, shardPaths, 3, nullptr, 0, nullptr, &result) == 0 &&
+              result.DataBlocksRepaired == 2 &&
+              result.RecoveryShardsRebuilt == 0 &&
+              ReadTestFile(inputPath, data, fileBytes + 1) == (long)fileBytes &&
+              0 == memcmp(data, original, fileBytes);
+
+    // A damaged block of shard 0 fails its checksum, so the damaged original
+    // of stripe 2 is decoded from shard 1 and the shard block is rewritten
+    memcpy(data, original, fileBytes);
+    damaged[0].Offset = 2 * stripeBytes + 3 * params.BlockBytes + 10;
+    damaged[0].Bytes = 1;
+    data[damaged[0].Offset] ^= 1;
+    memcpy(shard, shards, shardBytes);
+    shard[CM256_FILE_HEADER_BYTES + 2 * params.BlockBytes + 7] ^= 0x40;
+    success = success &&
+              WriteTestFile(inputPath, data, fileBytes) &&
+              WriteTestFile(shardPaths[0], shard, shardBytes) &&
+              cm256_file_repair(inputPath, shardPaths, 3, damaged, 1, nullptr, &result) == 0 &&
+              result.DataBlocksRepaired == 1 &&
+              result.RecoveryBlocksRepaired == 1 &&
+              result.RecoveryShardsRebuilt == 0 &&
+              ReadTestFile(inputPath, data, fileBytes + 1) == (long)fileBytes &&
+              0 == memcmp(data, original, fileBytes) &&
+              ReadTestFile(shardPaths[0], shard, shardBytes + 1) == (long)shardBytes &&
+              0 == memcmp(shard, shards, shardBytes);
+
+    // Once every shard block of a stripe is damaged, its lost original cannot be
+    // repaired, and this is found before the missing shard 1 is created
+    for (int j = 0; j < params.RecoveryCount && success; j += 2)
+    {
+        memcpy(shard, shards + j * shardBytes, shardBytes);
+        shard[CM256_FILE_HEADER_BYTES + 2 * params.BlockBytes] ^= 1;
+        success = WriteTestFile(shardPaths[j], shard, shardBytes);
+    }
+    success = success &&
+              remove(shardPaths[1]) == 0 &&
+              cm256_file_repair(inputPath, shardPaths, 3, damaged, 1, nullptr, &result) == -13 &&
+              ReadTestFile(shardPaths[1], shard, shardBytes + 1) < 0;
+    for (int j = 0; j < params.RecoveryCount && success; ++j)
+    {
+        success = WriteTestFile(shardPaths[j], shards + j * shardBytes, shardBytes);
+    }
 
-        for (int j = 0; j < blockBytes; ++j)
-        {
-            const uint8_t expected = (uint8_t)(index + j * 13);
-            uint8_t* blockData = (uint8_t*)blocks[i].Block;
-            if (blockData[j] != expected)
-            {
-                return false;
-            }
-        }
+    // Losing a whole stripe is reported without writing anything
+    damaged[0].Offset = 0;
+    damaged[0].Bytes = stripeBytes;
+    success = success &&
+              WriteTestFile(inputPath, original, fileBytes - 5000) &&
+              cm256_file_repair(inputPath, shardPaths, 3, damaged, 1, nullptr, nullptr) == -13 &&
+              ReadTestFile(inputPath, data, fileBytes + 1) == (long)(fileBytes - 5000);
+
+    // Invalid arguments
+    params.RecoveryCount = 0;
+    success = success &&
+              cm256_file_encode(params, inputPath, shardPaths, nullptr) == -1 &&
+              cm256_file_repair(inputPath, shardPaths, 2, nullptr, 0, nullptr, nullptr) == -13 &&
+              cm256_file_repair(inputPath, nullptr, 3, nullptr, 0, nullptr, nullptr) == -3 &&
+              cm256_file_read_header("cm256_file_test.missing", nullptr, nullptr, nullptr) == -12 &&
+              cm256_file_read_header(inputPath, nullptr, nullptr, nullptr) == -13;
+    params.RecoveryCount = 3;
+    success = success &&
+              cm256_file_encode(params, "cm256_file_test.missing", shardPaths, nullptr) == -12;
+
+    remove(inputPath);
+    for (int j = 0; j < 3; ++j)
+    {
+        remove(shardPaths[j]);
+        remove(serialPaths[j]);
     }
 
-    return true;
+    delete[] original;
+    delete[] data;
+    delete[] shards;
+    delete[] shard;
+    delete[] expected;
+    delete[] padded;
+
+    return success;
 }
 
+static int TraceEventCount = 0;
 
+static void CountTraceEvent(void* context, const cm256_trace_event* event)
+{
+    if (context == &TraceEventCount && (event->Type == CM256_TRACE_PHASE || event->Type == CM256_TRACE_HEAP_MATRIX))
+    {
+        ++TraceEventCount;
+    }
+}
 
-bool ExampleFileUsage()
+bool InstrumentationTest()
 {
     if (cm256_init())
     {
         return false;
     }
 
-    cm256_encoder_params params;
-
-    // Number of bytes per file block
-    params.BlockBytes = 1296;
-
-    // Number of blocks
-    params.OriginalCount = 100;
-
-    // Number of additional recovery blocks generated by encoder
-    params.RecoveryCount = 30;
-
-    // Size of the original file
-    static const int OriginalFileBytes = params.OriginalCount * params.BlockBytes;
+    cm256_stats stats;
+    cm256_reset_stats();
+    const bool enabled = (cm256_get_stats(&stats) == 0);
 
-    // Allocate and fill the original file data
-    uint8_t* originalFileData = new uint8_t[OriginalFileBytes];
-    for (int i = 0; i < OriginalFileBytes; ++i)
+    // Without CM256_INSTRUMENT everything reads as zero
+    if (!enabled)
     {
-        originalFileData[i] = (uint8_t)i;
+        return cm256_set_trace_hook(CountTraceEvent, &TraceEventCount) == -1 &&
+               stats.PhaseCalls[CM256_PHASE_ENCODE] == 0 &&
+               stats.Kernels.Bytes[GF256_OP_MUL_MULTI] == 0;
     }
 
-    // Pointers to data
-    cm256_block blocks[256];
-    for (int i = 0; i < params.OriginalCount; ++i)
-    {
-        blocks[i].Block = originalFileData + i * params.BlockBytes;
-    }
+    TestStripe stripe(60, 50, 100000);
+    const cm256_encoder_params params = stripe.Params;
 
-    // Recovery data
-    uint8_t* recoveryBlocks = new uint8_t[params.RecoveryCount * params.BlockBytes];
+    TraceEventCount = 0;
+    bool success = (cm256_set_trace_hook(CountTraceEvent, &TraceEventCount) == 0) &&
+                   stripe.Encode();
 
-    // Generate recovery data
-    if (cm256_encode(params, blocks, recoveryBlocks))
+    // A 50x50 decomposition does not fit in the stack matrix
+    for (int i = 0; i < params.RecoveryCount; ++i)
     {
-        return false;
+        stripe.Receive(i, i);
     }
-
-    // Initialize the indices
-    for (int i = 0; i < params.OriginalCount; ++i)
+    cm256_threading threading;
+    threading.ThreadCount = 2;
+    threading.Scheduler = nullptr;
+    threading.SchedulerContext = nullptr;
+    success = success && (cm256_decode_mt(params, stripe.Blocks, &threading) == 0) && stripe.Validate();
+
+    cm256_set_trace_hook(nullptr, nullptr);
+    cm256_get_stats(&stats);
+
+    const uint64_t blockBytes = params.BlockBytes;
+    if (!success ||
+        stats.PhaseCalls[CM256_PHASE_ENCODE] == 0 ||
+        stats.PhaseBytes[CM256_PHASE_ENCODE] != params.RecoveryCount * blockBytes ||
+        stats.PhaseCalls[CM256_PHASE_LDU] != 1 ||
+        stats.PhaseBytes[CM256_PHASE_ELIMINATE] != params.RecoveryCount * blockBytes ||
+        stats.PhaseBytes[CM256_PHASE_DIAGONAL] != params.RecoveryCount * blockBytes ||
+        stats.PhaseCycles[CM256_PHASE_LOWER_SOLVE] == 0 ||
+        stats.PhaseCycles[CM256_PHASE_UPPER_SOLVE] == 0 ||
+        stats.HeapMatrixFallbacks != 1 ||
+        stats.Kernels.Bytes[GF256_OP_MULADD_MULTI] != (uint64_t)(params.RecoveryCount - 1) * 10 * blockBytes ||
+        TraceEventCount == 0)
     {
-        blocks[i].Index = cm256_get_original_block_index(params, i);
+        success = false;
     }
 
-    //// Simulate loss of data, substituting a recovery block in its place ////
-    for (int i = 0; i < params.RecoveryCount && i < params.OriginalCount; ++i)
+    cm256_reset_stats();
+    cm256_get_stats(&stats);
+    if (stats.PhaseCalls[CM256_PHASE_ENCODE] != 0 || stats.Kernels.Calls[GF256_OP_ADD] != 0)
     {
-        blocks[i].Block = recoveryBlocks + params.BlockBytes * i; // First recovery block
-        blocks[i].Index = cm256_get_recovery_block_index(params, i); // First recovery block index
+        success = false;
     }
-    //// Simulate loss of data, substituting a recovery block in its place ////
 
-    if (cm256_decode(params, blocks))
+    return success;
+}
+
+static void SerialScheduler(void* /*schedulerContext*/, cm256_task_fn task, void* taskContext, int taskCount)
+{
+    for (int i = taskCount - 1; i >= 0; --i)
     {
-        return false;
+        task(taskContext, i);
     }
+}
 
-    for (int i = 0; i < params.RecoveryCount && i < params.OriginalCount; ++i)
+bool ThreadedCodecTest()
+{
+    if (cm256_init())
     {
-        uint8_t* block = (uint8_t*)blocks[i].Block;
-        int index = blocks[i].Index;
-
-        for (int j = 0; j < params.BlockBytes; ++j)
-        {
-            const uint8_t expected = (uint8_t)(j + index * params.BlockBytes);
-            if (block[j] != expected)
-            {
-                return false;
-            }
-        }
+        return false;
     }
 
-    delete[] originalFileData;
-    delete[] recoveryBlocks;
+    TestStripe stripe(12, 5, 200003);
+    const cm256_encoder_params params = stripe.Params;
 
-    return true;
-}
+    uint8_t* actual = new uint8_t[params.RecoveryCount * params.BlockBytes];
 
-bool CheckMemSwap()
-{
-    unsigned char buffa[16 + 8 + 4 + 3];
-    memset(buffa, 1, sizeof(buffa));
-    unsigned char buffb[16 + 8 + 4 + 3];
-    memset(buffb, 2, sizeof(buffb));
+    bool success = stripe.Encode();
 
-    gf256_memswap(buffa, buffb, (int)sizeof(buffa));
+    // Library threads and a caller-provided scheduler
+    cm256_threading threading[2] = {
+        { 4, nullptr, nullptr },
+        { 3, SerialScheduler, nullptr }
+    };
 
-    for (int i = 0; i < (int)sizeof(buffa); ++i)
+    for (int trial = 0; trial < 2 && success; ++trial)
     {
-        if (buffa[i] != 2)
-        {
-            return false;
-        }
-        if (buffb[i] != 1)
+        if (cm256_encode_mt(params, stripe.Blocks, actual, &threading[trial]) ||
+            0 != memcmp(stripe.RecoveryData, actual, params.RecoveryCount * params.BlockBytes))
         {
-            return false;
+            success = false;
+            break;
         }
-    }
-
-    gf256_memswap(buffa, buffb, (int)sizeof(buffa));
 
-    for (int i = 0; i < (int)sizeof(buffa); ++i)
-    {
-        if (buffa[i] != 1)
+        // Replace the first few originals with recovery blocks
+        const int lost = params.RecoveryCount - trial;
+        for (int i = 0; i < lost; ++i)
         {
-            return false;
+            stripe.Receive(i, i);
         }
-        if (buffb[i] != 2)
+
+        if (cm256_decode_mt(params, stripe.Blocks, &threading[trial]) || !stripe.Validate())
         {
-            return false;
+            success = false;
         }
+
+        stripe.ResetBlocks();
     }
 
-    return true;
+    delete[] actual;
+
+    return success;
 }
 
 bool FinerPerfTimingTest()
@@ -437,6 +3095,186 @@ int main()
         exit(4);
     }
 #endif
+#if 1
+    if (!FieldTablesTest())
+    {
+        exit(26);
+    }
+#endif
+#if 1
+    if (!MultiKernelTest())
+    {
+        exit(33);
+    }
+#endif
+#if 1
+    if (!TiledEncodeTest())
+    {
+        exit(32);
+    }
+#endif
+#if 1
+    if (!EncoderContextTest())
+    {
+        exit(5);
+    }
+#endif
+#if 1
+    if (!DecoderContextTest())
+    {
+        exit(27);
+    }
+#endif
+#if 1
+    if (!DecoderCacheTest())
+    {
+        exit(31);
+    }
+#endif
+#if 1
+    if (!ThreadedCodecTest())
+    {
+        exit(6);
+    }
+#endif
+#if 1
+    if (!StreamEncoderTest())
+    {
+        exit(7);
+    }
+#endif
+#if 1
+    if (!StreamDecoderTest())
+    {
+        exit(8);
+    }
+#endif
+#if 1
+    if (!BatchCodecTest())
+    {
+        exit(9);
+    }
+#endif
+#if 1
+    if (!DecodeIntoTest())
+    {
+        exit(10);
+    }
+#endif
+#if 1
+    if (!ScatterGatherTest())
+    {
+        exit(11);
+    }
+#endif
+#if 1
+    if (!BackendConsistencyTest())
+    {
+        exit(12);
+    }
+#endif
+#ifdef CM256_TEST_FIXED_CODEC
+    if (!FixedCodecTest())
+    {
+        exit(13);
+    }
+#endif
+#if 1
+    if (!DoubleErasureTest())
+    {
+        exit(14);
+    }
+#endif
+#if 1
+    if (!XorModeTest())
+    {
+        exit(15);
+    }
+#endif
+#if 1
+    if (!PartialRangeDecodeTest())
+    {
+        exit(16);
+    }
+#endif
+#if 1
+    if (!SubsetDecodeTest())
+    {
+        exit(17);
+    }
+#endif
+#if 1
+    if (!RepairTest())
+    {
+        exit(18);
+    }
+#endif
+#if 1
+    if (!DeltaUpdateTest())
+    {
+        exit(19);
+    }
+#endif
+#if 1
+    if (!ChecksumTest())
+    {
+        exit(20);
+    }
+#endif
+#if 1
+    if (!VerifyTest())
+    {
+        exit(21);
+    }
+#endif
+#if 1
+    if (!InstrumentationTest())
+    {
+        exit(22);
+    }
+#endif
+#if 1
+    if (!StreamingStoreTest())
+    {
+        exit(23);
+    }
+#endif
+#if 1
+    if (!ArenaTest())
+    {
+        exit(24);
+    }
+#endif
+#if 1
+    if (!WideCodecTest())
+    {
+        exit(25);
+    }
+#endif
+#if 1
+    if (!FilePipelineTest())
+    {
+        exit(28);
+    }
+#endif
+#if 1
+    if (!BlockIndexTest())
+    {
+        exit(29);
+    }
+#endif
+#if 1
+    if (!GFNIBackendTest())
+    {
+        exit(34);
+    }
+#endif
+#if 1
+    if (!BackendCodecTest())
+    {
+        exit(30);
+    }
+#endif
 #if 1
     if (!FinerPerfTimingTest())
     {